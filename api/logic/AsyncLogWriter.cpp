@@ -0,0 +1,189 @@
+/* Copyright 2013-2017 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "AsyncLogWriter.h"
+
+#include <QFileDevice>
+#include <QTextStream>
+#include <cstdio>
+
+AsyncLogWriter::AsyncLogWriter(QFileDevice *file, bool echo, QObject *parent)
+	: QThread(parent), m_file(file), m_echo(echo), m_head(&m_stub), m_tail(&m_stub), m_pending(0), m_writers(0), m_stopping(false)
+{
+	m_stub.next.store(nullptr);
+	start(QThread::LowPriority);
+}
+
+AsyncLogWriter::~AsyncLogWriter()
+{
+	stop();
+	drain();
+}
+
+QString AsyncLogWriter::formatLine(qint64 msecs, char level, const QString &message)
+{
+	char buf[32] = {0};
+	::snprintf(buf, sizeof(buf), "%5lld.%03lld", msecs / 1000, msecs % 1000);
+	return QString("%1 %2 %3\n").arg(buf).arg(QLatin1Char(level)).arg(message);
+}
+
+void AsyncLogWriter::write(qint64 msecs, char level, const QString &message)
+{
+	auto node = new Node;
+	node->msecs = msecs;
+	node->level = level;
+	node->message = message;
+
+	// stop() waits for every write that got past this check before it drains the queue for the last time
+	m_writers.fetch_add(1);
+	if(m_stopping.load())
+	{
+		m_writers.fetch_sub(1);
+		QMutexLocker lock(&m_directLock);
+		writeNode(node);
+		delete node;
+		m_file->flush();
+		return;
+	}
+
+	// count the line first so the writer doesn't go to sleep before it finds it in the queue
+	if(m_pending.fetch_add(1) == 0)
+	{
+		push(node);
+		m_wake.release();
+	}
+	else
+	{
+		push(node);
+	}
+	m_writers.fetch_sub(1);
+}
+
+void AsyncLogWriter::stop()
+{
+	if(m_stopping.exchange(true))
+	{
+		return;
+	}
+	// the writer drains what is left once it wakes up
+	m_pending.fetch_add(1);
+	m_wake.release();
+	wait();
+	// threads that started writing just as the writer stopped still push into the queue. Let them finish.
+	while(m_writers.load())
+	{
+		QThread::yieldCurrentThread();
+	}
+	QMutexLocker lock(&m_directLock);
+	drain();
+}
+
+void AsyncLogWriter::push(Node *node)
+{
+	node->next.store(nullptr, std::memory_order_relaxed);
+	Node *previous = m_head.exchange(node, std::memory_order_acq_rel);
+	previous->next.store(node, std::memory_order_release);
+}
+
+AsyncLogWriter::Node *AsyncLogWriter::pop()
+{
+	Node *tail = m_tail;
+	Node *next = tail->next.load(std::memory_order_acquire);
+	if(tail == &m_stub)
+	{
+		if(!next)
+		{
+			return nullptr;
+		}
+		m_tail = next;
+		tail = next;
+		next = next->next.load(std::memory_order_acquire);
+	}
+	if(next)
+	{
+		m_tail = next;
+		return tail;
+	}
+	if(tail != m_head.load(std::memory_order_acquire))
+	{
+		// a producer is in the middle of pushing
+		return nullptr;
+	}
+	// tail is the last node. Put the stub behind it so it can be taken out.
+	push(&m_stub);
+	next = tail->next.load(std::memory_order_acquire);
+	if(next)
+	{
+		m_tail = next;
+		return tail;
+	}
+	return nullptr;
+}
+
+void AsyncLogWriter::writeNode(Node *node)
+{
+	auto line = formatLine(node->msecs, node->level, node->message);
+	m_file->write(line.toUtf8());
+	if(m_echo)
+	{
+		QTextStream(stderr) << line.toLocal8Bit();
+	}
+}
+
+int AsyncLogWriter::drain()
+{
+	int count = 0;
+	while(Node *node = pop())
+	{
+		writeNode(node);
+		delete node;
+		count++;
+	}
+	if(count)
+	{
+		m_file->flush();
+		if(m_echo)
+		{
+			fflush(stderr);
+		}
+	}
+	return count;
+}
+
+void AsyncLogWriter::run()
+{
+	while(true)
+	{
+		m_wake.acquire();
+		// keep going until everything counted got written
+		int remaining;
+		do
+		{
+			int written = drain();
+			remaining = m_pending.fetch_sub(written) - written;
+			if(m_stopping.load() && remaining <= 1)
+			{
+				drain();
+				return;
+			}
+			if(remaining && !written)
+			{
+				// counted, but not in the queue yet
+				QThread::yieldCurrentThread();
+			}
+		} while(remaining);
+	}
+}
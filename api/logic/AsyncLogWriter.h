@@ -0,0 +1,86 @@
+/* Copyright 2013-2017 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <QThread>
+#include <QSemaphore>
+#include <QMutex>
+#include <QString>
+#include <atomic>
+#include <memory>
+
+#include "multimc_logic_export.h"
+
+class QFileDevice;
+
+/**
+ * Writes log lines to a device from a background thread.
+ *
+ * Any thread can write(). Lines go into a lock-free queue and are formatted and written by the writer thread,
+ * so logging doesn't wait for the disk. Only a write into an empty queue wakes up the writer.
+ */
+class MULTIMC_LOGIC_EXPORT AsyncLogWriter : public QThread
+{
+	Q_OBJECT
+public:
+	/// the writer takes ownership of the file, which has to be open. Lines are also echoed to stderr if asked to.
+	explicit AsyncLogWriter(QFileDevice *file, bool echo = false, QObject *parent = nullptr);
+	virtual ~AsyncLogWriter();
+
+	/// queue a line for writing. Thread safe. msecs is the time since start, level the letter for the message type.
+	void write(qint64 msecs, char level, const QString &message);
+
+	/// write everything that is queued and stop the thread. Lines written after this are written right away.
+	void stop();
+
+	/// format a line the way it ends up in the log
+	static QString formatLine(qint64 msecs, char level, const QString &message);
+
+protected:
+	void run() override;
+
+private:
+	struct Node
+	{
+		std::atomic<Node *> next;
+		qint64 msecs;
+		char level;
+		QString message;
+	};
+	void push(Node *node);
+	Node *pop();
+	void writeNode(Node *node);
+	int drain();
+
+private:
+	std::unique_ptr<QFileDevice> m_file;
+	bool m_echo = false;
+
+	// multiple producer, single consumer queue. Producers exchange the head, the writer thread owns the tail.
+	Node m_stub;
+	std::atomic<Node *> m_head;
+	Node *m_tail;
+
+	/// number of lines written but not yet taken out of the queue
+	std::atomic<int> m_pending;
+	/// number of write() calls that decided to use the queue and aren't done pushing yet
+	std::atomic<int> m_writers;
+	std::atomic<bool> m_stopping;
+	QSemaphore m_wake;
+	/// serializes the writes that happen after the writer thread is gone
+	QMutex m_directLock;
+};
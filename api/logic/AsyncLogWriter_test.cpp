@@ -0,0 +1,110 @@
+#include <QTest>
+#include <QTemporaryDir>
+#include <QFile>
+#include <thread>
+#include "TestUtil.h"
+
+#include "AsyncLogWriter.h"
+
+class AsyncLogWriterTest : public QObject
+{
+	Q_OBJECT
+private
+slots:
+	void test_formatLine()
+	{
+		QCOMPARE(AsyncLogWriter::formatLine(1234, 'D', "hello"), QString("    1.234 D hello\n"));
+		QCOMPARE(AsyncLogWriter::formatLine(123456789, 'W', "world"), QString("123456.789 W world\n"));
+	}
+
+	void test_threads()
+	{
+		QTemporaryDir dir;
+		auto path = dir.path() + "/log.txt";
+		auto file = new QFile(path);
+		QVERIFY(file->open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate));
+
+		const int threads = 4;
+		const int lines = 2000;
+		AsyncLogWriter writer(file);
+		std::vector<std::thread> writers;
+		for(int t = 0; t < threads; t++)
+		{
+			writers.emplace_back([&writer, t, lines]()
+			{
+				for(int i = 0; i < lines; i++)
+				{
+					writer.write(i, 'D', QString("%1 %2").arg(t).arg(i));
+				}
+			});
+		}
+		for(auto &thread: writers)
+		{
+			thread.join();
+		}
+		writer.stop();
+		// still works after stopping
+		writer.write(0, 'I', "late");
+
+		QFile result(path);
+		QVERIFY(result.open(QIODevice::ReadOnly | QIODevice::Text));
+		auto written = QString::fromUtf8(result.readAll()).split('\n', QString::SkipEmptyParts);
+		QCOMPARE(written.size(), threads * lines + 1);
+		QVERIFY(written.last().endsWith("I late"));
+
+		// lines from the same thread keep their order
+		QVector<int> next(threads, 0);
+		for(int i = 0; i < written.size() - 1; i++)
+		{
+			auto parts = written[i].split(' ', QString::SkipEmptyParts);
+			QCOMPARE(parts.size(), 4);
+			int t = parts[2].toInt();
+			QCOMPARE(parts[3].toInt(), next[t]);
+			next[t]++;
+		}
+	}
+
+	void test_stopWhileWriting()
+	{
+		QTemporaryDir dir;
+		auto path = dir.path() + "/log.txt";
+		auto file = new QFile(path);
+		QVERIFY(file->open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate));
+
+		const int threads = 4;
+		const int lines = 5000;
+		AsyncLogWriter writer(file);
+		std::atomic<int> started(0);
+		std::vector<std::thread> writers;
+		for(int t = 0; t < threads; t++)
+		{
+			writers.emplace_back([&writer, &started, t, lines]()
+			{
+				started.fetch_add(1);
+				for(int i = 0; i < lines; i++)
+				{
+					writer.write(i, 'D', QString("%1 %2").arg(t).arg(i));
+				}
+			});
+		}
+		while(started.load() < threads)
+		{
+			QThread::yieldCurrentThread();
+		}
+		// stop in the middle of the writes. Lines from either side of it all end up in the file.
+		writer.stop();
+		for(auto &thread: writers)
+		{
+			thread.join();
+		}
+
+		QFile result(path);
+		QVERIFY(result.open(QIODevice::ReadOnly | QIODevice::Text));
+		auto written = QString::fromUtf8(result.readAll()).split('\n', QString::SkipEmptyParts);
+		QCOMPARE(written.size(), threads * lines);
+	}
+};
+
+QTEST_GUILESS_MAIN(AsyncLogWriterTest)
+
+#include "AsyncLogWriter_test.moc"
@@ -129,6 +129,22 @@ QString BaseInstance::id() const
 	return QFileInfo(instanceRoot()).fileName();
 }
 
+void BaseInstance::setDiskUsage(const InstanceDiskUsage &usage)
+{
+	if(m_diskUsage != usage)
+	{
+		m_diskUsage = usage;
+		emit propertiesChanged(this);
+	}
+}
+
+void BaseInstance::touchModels() const
+{
+	// only compared between instances, so a counter does the job of a clock
+	static quint64 uses = 0;
+	m_modelsLastUsed = ++uses;
+}
+
 bool BaseInstance::isRunning() const
 {
 	return m_isRunning;
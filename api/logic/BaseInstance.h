@@ -29,6 +29,8 @@
 #include "minecraft/auth/MojangAccount.h"
 #include "MessageLevel.h"
 #include "pathmatcher/IPathMatcher.h"
+#include "Usable.h"
+#include "InstanceDiskUsage.h"
 
 #include "multimc_logic_export.h"
 
@@ -48,8 +50,10 @@ typedef std::shared_ptr<BaseInstance> InstancePtr;
  *
  * To create a new instance type, create a new class inheriting from this class
  * and implement the pure virtual functions.
+ *
+ * Anything that shows the instance to the user should hold a UseLock on it, so its models stay loaded.
  */
-class MULTIMC_LOGIC_EXPORT BaseInstance : public QObject, public std::enable_shared_from_this<BaseInstance>
+class MULTIMC_LOGIC_EXPORT BaseInstance : public QObject, public std::enable_shared_from_this<BaseInstance>, public Usable
 {
 	Q_OBJECT
 protected:
@@ -150,6 +154,12 @@ public:
 	/// returns a valid update task
 	virtual shared_qobject_ptr<Task> createUpdateTask() = 0;
 
+	/// Is nothing changed since the last complete update? Then a launch doesn't need to update.
+	virtual bool isUpToDate()
+	{
+		return false;
+	}
+
 	/// returns a valid launcher (task container)
 	virtual std::shared_ptr<LaunchTask> createLaunchTask(AuthSessionPtr account) = 0;
 
@@ -236,9 +246,36 @@ public:
 	int getConsoleMaxLines() const;
 	bool shouldStopOnConsoleOverflow() const;
 
+	/// Does the instance keep heavy models (mod lists, worlds, loaded components...) in memory?
+	virtual bool hasLoadedModels() const
+	{
+		return false;
+	}
+
+	/// Release the heavy models. They are created again the next time they are used.
+	virtual void unloadModels()
+	{
+	}
+
+	/// Disk space used by the instance, as of the last scan
+	InstanceDiskUsage diskUsage() const
+	{
+		return m_diskUsage;
+	}
+	void setDiskUsage(const InstanceDiskUsage &usage);
+
+	/// When were the models last used? Only good for comparing with other instances, higher is more recent.
+	quint64 modelsLastUsed() const
+	{
+		return m_modelsLastUsed;
+	}
+
 protected:
 	void changeStatus(Status newStatus);
 
+	/// Note a use of the models, so the least recently used ones get unloaded first.
+	void touchModels() const;
+
 signals:
 	/*!
 	 * \brief Signal emitted when properties relevant to the instance view change
@@ -273,6 +310,8 @@ private: /* data */
 	bool m_crashed = false;
 	bool m_hasUpdate = false;
 	bool m_hasBrokenVersion = false;
+	mutable quint64 m_modelsLastUsed = 0;
+	InstanceDiskUsage m_diskUsage;
 };
 
 Q_DECLARE_METATYPE(std::shared_ptr<BaseInstance>)
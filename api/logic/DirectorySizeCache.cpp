@@ -0,0 +1,190 @@
+/* Copyright 2013-2017 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "DirectorySizeCache.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include "FileSystem.h"
+#include "SeparatorPrefixTree.h"
+#include "Exception.h"
+
+DirectorySizeCache::DirectorySizeCache(qint64 racyWindow) : m_racyWindow(racyWindow)
+{
+}
+
+void DirectorySizeCache::beginScan()
+{
+	m_scan++;
+	m_totals.clear();
+	m_listed = 0;
+	m_reused = 0;
+}
+
+qint64 DirectorySizeCache::size(const QString &path, qint64 notBefore)
+{
+	auto known = m_totals.constFind(path);
+	if(known != m_totals.constEnd())
+	{
+		return known.value();
+	}
+
+	QFileInfo info(path);
+	if(info.isSymLink() || !info.exists())
+	{
+		return 0;
+	}
+	if(!info.isDir())
+	{
+		return info.size();
+	}
+
+	qint64 mtime = info.lastModified().toMSecsSinceEpoch();
+	auto &entry = m_entries[path];
+	if(entry.listed && entry.mtime == mtime && entry.listed >= notBefore && entry.listed - mtime > m_racyWindow)
+	{
+		m_reused++;
+	}
+	else
+	{
+		m_listed++;
+		entry.mtime = mtime;
+		entry.listed = QDateTime::currentMSecsSinceEpoch();
+		entry.files = 0;
+		entry.subdirs.clear();
+		QDir dir(path);
+		auto filter = QDir::Files | QDir::Dirs | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot | QDir::NoSymLinks;
+		for(auto &child: dir.entryInfoList(filter, QDir::NoSort))
+		{
+			if(child.isDir())
+			{
+				entry.subdirs.append(child.fileName());
+			}
+			else
+			{
+				entry.files += child.size();
+			}
+		}
+	}
+	entry.scan = m_scan;
+
+	// the entry reference doesn't survive the recursion, the hash may grow
+	qint64 total = entry.files;
+	auto subdirs = entry.subdirs;
+	for(auto &subdir: subdirs)
+	{
+		total += size(FS::PathCombine(path, subdir), notBefore);
+	}
+	m_totals.insert(path, total);
+	return total;
+}
+
+QStringList DirectorySizeCache::subdirectories(const QString &path) const
+{
+	return m_entries.value(path).subdirs;
+}
+
+void DirectorySizeCache::prune(const QStringList &kept)
+{
+	SeparatorPrefixTree<'/'> keptTree(kept);
+	auto iter = m_entries.begin();
+	while(iter != m_entries.end())
+	{
+		if(iter->scan != m_scan && !keptTree.covers(iter.key()))
+		{
+			iter = m_entries.erase(iter);
+		}
+		else
+		{
+			iter++;
+		}
+	}
+}
+
+bool DirectorySizeCache::load(const QString &filename)
+{
+	m_entries.clear();
+	if(!QFile::exists(filename))
+	{
+		return true;
+	}
+	QJsonParseError error;
+	QJsonDocument doc;
+	try
+	{
+		doc = QJsonDocument::fromJson(FS::read(filename), &error);
+	}
+	catch(Exception &e)
+	{
+		qWarning() << "Could not read directory size cache:" << e.cause();
+		return false;
+	}
+	if(error.error != QJsonParseError::NoError || !doc.isObject())
+	{
+		qWarning() << "Directory size cache" << filename << "is not valid JSON:" << error.errorString();
+		return false;
+	}
+	auto entries = doc.object().value("entries").toObject();
+	for(auto iter = entries.begin(); iter != entries.end(); iter++)
+	{
+		auto obj = iter.value().toObject();
+		Entry entry;
+		entry.mtime = qint64(obj.value("mtime").toDouble());
+		entry.listed = qint64(obj.value("listed").toDouble());
+		entry.files = qint64(obj.value("files").toDouble());
+		for(auto subdir: obj.value("subdirs").toArray())
+		{
+			entry.subdirs.append(subdir.toString());
+		}
+		entry.scan = m_scan;
+		m_entries.insert(iter.key(), entry);
+	}
+	return true;
+}
+
+bool DirectorySizeCache::save(const QString &filename) const
+{
+	QJsonObject entries;
+	for(auto iter = m_entries.begin(); iter != m_entries.end(); iter++)
+	{
+		QJsonObject obj;
+		obj.insert("mtime", double(iter->mtime));
+		obj.insert("listed", double(iter->listed));
+		obj.insert("files", double(iter->files));
+		obj.insert("subdirs", QJsonArray::fromStringList(iter->subdirs));
+		entries.insert(iter.key(), obj);
+	}
+	QJsonObject root;
+	root.insert("formatVersion", 1);
+	root.insert("entries", entries);
+	try
+	{
+		FS::ensureFilePathExists(filename);
+		FS::write(filename, QJsonDocument(root).toJson(QJsonDocument::Compact));
+	}
+	catch(Exception &e)
+	{
+		qWarning() << "Could not save directory size cache:" << e.cause();
+		return false;
+	}
+	return true;
+}
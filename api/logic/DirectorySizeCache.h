@@ -0,0 +1,90 @@
+/* Copyright 2013-2017 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+
+#include "multimc_logic_export.h"
+
+/**
+ * Computes the sizes of directory trees and remembers what it found in each directory.
+ *
+ * A directory is only listed again when its modification time changed, or when the caller says files in it may
+ * have changed since (e.g. a game wrote to its world files). Unchanged directories are only stat-ed to get to their
+ * subdirectories. Files changed in place don't touch the directory's modification time, hence the `notBefore`.
+ *
+ * Not thread safe. Symbolic links are not followed or counted.
+ */
+class MULTIMC_LOGIC_EXPORT DirectorySizeCache
+{
+public:
+	/**
+	 * A listing done within racyWindow of the directory's modification time isn't trusted later, as more changes
+	 * could have happened within the same timestamp.
+	 */
+	explicit DirectorySizeCache(qint64 racyWindow = 2000);
+
+	/// start a new scan. Sizes computed during the previous one are forgotten.
+	void beginScan();
+
+	/// total size of the files in the tree at path, in bytes. Listings older than notBefore (msecs since epoch) are redone.
+	qint64 size(const QString &path, qint64 notBefore = 0);
+
+	/// names of the subdirectories of a directory visited by size(), without listing it again
+	QStringList subdirectories(const QString &path) const;
+
+	/// forget directories not visited since beginScan(), unless they are under one of the kept paths
+	void prune(const QStringList &kept = QStringList());
+
+	/// how many directories were listed and how many listings were reused since beginScan()
+	int listedCount() const
+	{
+		return m_listed;
+	}
+	int reusedCount() const
+	{
+		return m_reused;
+	}
+
+	bool load(const QString &filename);
+	bool save(const QString &filename) const;
+
+private:
+	struct Entry
+	{
+		/// modification time of the directory when it was listed
+		qint64 mtime = 0;
+		/// when it was listed
+		qint64 listed = 0;
+		/// size of the files directly in the directory
+		qint64 files = 0;
+		QStringList subdirs;
+		/// the scan that last visited the directory
+		int scan = 0;
+	};
+
+private:
+	qint64 m_racyWindow;
+	QHash<QString, Entry> m_entries;
+	/// total sizes of trees computed in the current scan
+	QHash<QString, qint64> m_totals;
+	int m_scan = 0;
+	int m_listed = 0;
+	int m_reused = 0;
+};
@@ -0,0 +1,199 @@
+#include <QTest>
+#include <QTemporaryDir>
+#include <QDateTime>
+#include <QFile>
+#include "TestUtil.h"
+
+#include "DirectorySizeCache.h"
+#include "DiskUsageScanner.h"
+#include <FileSystem.h>
+
+class DirectorySizeCacheTest : public QObject
+{
+	Q_OBJECT
+
+	void writeFile(const QString &path, int size)
+	{
+		FS::ensureFilePathExists(path);
+		FS::write(path, QByteArray(size, 'x'));
+	}
+
+	// listings are only trusted once the clock moved past the modification times
+	void settle()
+	{
+		QTest::qSleep(20);
+	}
+
+private
+slots:
+	void test_Size()
+	{
+		QTemporaryDir tempDir;
+		QString root = tempDir.path();
+		writeFile(FS::PathCombine(root, "a.txt"), 10);
+		writeFile(FS::PathCombine(root, "sub", "b.txt"), 100);
+		writeFile(FS::PathCombine(root, "sub", "deeper", "c.txt"), 1000);
+		settle();
+
+		DirectorySizeCache cache(0);
+		cache.beginScan();
+		QCOMPARE(cache.size(root), qint64(1110));
+		QCOMPARE(cache.size(FS::PathCombine(root, "sub")), qint64(1100));
+		QCOMPARE(cache.listedCount(), 3);
+		QCOMPARE(cache.subdirectories(root), QStringList() << "sub");
+
+		// nothing changed, nothing gets listed
+		cache.beginScan();
+		QCOMPARE(cache.size(root), qint64(1110));
+		QCOMPARE(cache.listedCount(), 0);
+		QCOMPARE(cache.reusedCount(), 3);
+	}
+
+	void test_Invalidation()
+	{
+		QTemporaryDir tempDir;
+		QString root = tempDir.path();
+		QString sub = FS::PathCombine(root, "sub");
+		writeFile(FS::PathCombine(sub, "b.txt"), 100);
+		settle();
+
+		DirectorySizeCache cache(0);
+		cache.beginScan();
+		QCOMPARE(cache.size(root), qint64(100));
+
+		// a new file changes the modification time of its directory only
+		writeFile(FS::PathCombine(sub, "c.txt"), 50);
+		settle();
+		cache.beginScan();
+		QCOMPARE(cache.size(root), qint64(150));
+		QCOMPARE(cache.listedCount(), 1);
+		QCOMPARE(cache.reusedCount(), 1);
+
+		// files changed in place aren't noticed, unless the caller says so
+		QFile file(FS::PathCombine(sub, "c.txt"));
+		QVERIFY(file.open(QIODevice::Append));
+		file.write(QByteArray(30, 'x'));
+		file.close();
+		settle();
+		cache.beginScan();
+		QCOMPARE(cache.size(root), qint64(150));
+		cache.beginScan();
+		QCOMPARE(cache.size(root, QDateTime::currentMSecsSinceEpoch()), qint64(180));
+		QCOMPARE(cache.listedCount(), 2);
+	}
+
+	void test_RacyListing()
+	{
+		QTemporaryDir tempDir;
+		QString root = tempDir.path();
+		writeFile(FS::PathCombine(root, "a.txt"), 10);
+
+		// listed right after a change - could have missed another change within the same timestamp
+		DirectorySizeCache cache(60000);
+		cache.beginScan();
+		QCOMPARE(cache.size(root), qint64(10));
+		cache.beginScan();
+		QCOMPARE(cache.size(root), qint64(10));
+		QCOMPARE(cache.listedCount(), 1);
+	}
+
+	void test_SaveLoad()
+	{
+		QTemporaryDir tempDir;
+		QString root = FS::PathCombine(tempDir.path(), "root");
+		QString cacheFile = FS::PathCombine(tempDir.path(), "cache", "sizes.json");
+		writeFile(FS::PathCombine(root, "sub", "b.txt"), 100);
+		settle();
+
+		{
+			DirectorySizeCache cache(0);
+			cache.beginScan();
+			QCOMPARE(cache.size(root), qint64(100));
+			QVERIFY(cache.save(cacheFile));
+		}
+
+		DirectorySizeCache cache(0);
+		QVERIFY(cache.load(cacheFile));
+		cache.beginScan();
+		QCOMPARE(cache.size(root), qint64(100));
+		QCOMPARE(cache.listedCount(), 0);
+
+		// garbage is refused, but leaves a usable cache
+		FS::write(cacheFile, "not json");
+		QVERIFY(!cache.load(cacheFile));
+		cache.beginScan();
+		QCOMPARE(cache.size(root), qint64(100));
+		QCOMPARE(cache.listedCount(), 2);
+	}
+
+	void test_Prune()
+	{
+		QTemporaryDir tempDir;
+		QString one = FS::PathCombine(tempDir.path(), "one");
+		QString two = FS::PathCombine(tempDir.path(), "two");
+		writeFile(FS::PathCombine(one, "a.txt"), 10);
+		writeFile(FS::PathCombine(two, "sub", "b.txt"), 20);
+		settle();
+
+		DirectorySizeCache cache(0);
+		cache.beginScan();
+		cache.size(one);
+		cache.size(two);
+
+		// two wasn't visited, but it's kept
+		cache.beginScan();
+		cache.size(one);
+		cache.prune(QStringList() << two);
+		QCOMPARE(cache.subdirectories(two), QStringList() << "sub");
+
+		// now it's gone
+		cache.beginScan();
+		cache.size(one);
+		cache.prune();
+		QCOMPARE(cache.subdirectories(two), QStringList());
+		cache.beginScan();
+		QCOMPARE(cache.size(two), qint64(20));
+		QCOMPARE(cache.listedCount(), 2);
+	}
+
+	void test_Scanner()
+	{
+		QTemporaryDir tempDir;
+		QString root = tempDir.path();
+		writeFile(FS::PathCombine(root, "mods", "mod.jar"), 1000);
+		writeFile(FS::PathCombine(root, "saves", "World One", "level.dat"), 300);
+		writeFile(FS::PathCombine(root, "saves", "World Two", "region", "r.0.0.mca"), 4000);
+		writeFile(FS::PathCombine(root, "logs", "latest.log"), 20);
+		writeFile(FS::PathCombine(root, "options.txt"), 5);
+		settle();
+
+		DiskUsageScanner::Job job;
+		job.id = "instance";
+		job.root = root;
+		job.mods << FS::PathCombine(root, "mods") << FS::PathCombine(root, "coremods");
+		job.logs << FS::PathCombine(root, "logs");
+		job.saves = FS::PathCombine(root, "saves");
+
+		DirectorySizeCache cache(0);
+		auto results = DiskUsageScanner::run(cache, QList<DiskUsageScanner::Job>() << job);
+		QCOMPARE(results.size(), 1);
+		QCOMPARE(results[0].first, QString("instance"));
+		auto usage = results[0].second;
+		QVERIFY(usage.isValid());
+		QCOMPARE(usage.total, qint64(5325));
+		QCOMPARE(usage.mods, qint64(1000));
+		QCOMPARE(usage.saves, qint64(4300));
+		QCOMPARE(usage.logs, qint64(20));
+		QCOMPARE(usage.other(), qint64(5));
+		QCOMPARE(usage.worlds.value("World One"), qint64(300));
+		QCOMPARE(usage.worlds.value("World Two"), qint64(4000));
+
+		// already cancelled, nothing gets measured
+		std::atomic<bool> cancel(true);
+		QVERIFY(DiskUsageScanner::run(cache, QList<DiskUsageScanner::Job>() << job, &cancel).isEmpty());
+	}
+};
+
+QTEST_GUILESS_MAIN(DirectorySizeCacheTest)
+
+#include "DirectorySizeCache_test.moc"
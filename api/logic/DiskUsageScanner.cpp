@@ -0,0 +1,177 @@
+/* Copyright 2013-2017 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "DiskUsageScanner.h"
+
+#include <QDebug>
+#include <QThread>
+#include <QtConcurrentRun>
+
+#include "InstanceList.h"
+#include "ProcessLimits.h"
+#include "FileSystem.h"
+#include "minecraft/MinecraftInstance.h"
+
+DiskUsageScanner::DiskUsageScanner(InstanceList *instances, const QString &cacheFile, QObject *parent)
+	: QObject(parent), m_instances(instances), m_cacheFile(cacheFile)
+{
+	m_cache = std::make_shared<DirectorySizeCache>();
+	m_cancel = std::make_shared<std::atomic<bool>>(false);
+	m_pool.setMaxThreadCount(1);
+	connect(&m_timer, &QTimer::timeout, this, &DiskUsageScanner::scan);
+	connect(&m_watcher, &QFutureWatcher<Results>::finished, this, &DiskUsageScanner::scanFinished);
+}
+
+DiskUsageScanner::~DiskUsageScanner()
+{
+	// don't hold up quitting for a whole scan
+	m_cancel->store(true);
+	m_pool.waitForDone();
+}
+
+void DiskUsageScanner::start(int delay, int interval)
+{
+	QTimer::singleShot(delay, this, SLOT(scan()));
+	if(interval > 0)
+	{
+		m_timer.start(interval);
+	}
+}
+
+bool DiskUsageScanner::isScanning() const
+{
+	return m_watcher.isRunning();
+}
+
+void DiskUsageScanner::scan()
+{
+	if(isScanning())
+	{
+		m_rescan = true;
+		return;
+	}
+
+	QList<Job> jobs;
+	QStringList skipped;
+	for(int i = 0; i < m_instances->count(); i++)
+	{
+		auto instance = m_instances->at(i);
+		if(instance->isRunning())
+		{
+			// the game is writing to it, the result would be outdated right away
+			skipped.append(instance->instanceRoot());
+			continue;
+		}
+		Job job;
+		job.id = instance->id();
+		job.root = instance->instanceRoot();
+		job.notBefore = instance->lastLaunch();
+		auto minecraft = std::dynamic_pointer_cast<MinecraftInstance>(instance);
+		if(minecraft)
+		{
+			auto root = minecraft->minecraftRoot();
+			job.mods = QStringList{minecraft->loaderModsDir(), minecraft->coreModsDir(), minecraft->jarModsDir()};
+			job.logs = QStringList{FS::PathCombine(root, "logs"), FS::PathCombine(root, "crash-reports")};
+			job.screenshots = QStringList{FS::PathCombine(root, "screenshots")};
+			job.resourcePacks = QStringList{minecraft->resourcePacksDir(), minecraft->texturePacksDir()};
+			job.saves = minecraft->worldDir();
+		}
+		jobs.append(job);
+	}
+
+	auto cache = m_cache;
+	auto cancel = m_cancel;
+	auto cacheFile = m_cacheFile;
+	bool load = !m_cacheLoaded;
+	m_cacheLoaded = true;
+	auto future = QtConcurrent::run(&m_pool, [cache, cancel, cacheFile, load, jobs, skipped]()
+	{
+		// this is the only thing the pool runs, so the priorities don't need to be restored
+		QThread::currentThread()->setPriority(QThread::IdlePriority);
+		ProcessLimits::setThreadIOPriority(ProcessLimits::IOIdle);
+		if(load)
+		{
+			cache->load(cacheFile);
+		}
+		auto results = run(*cache, jobs, cancel.get());
+		if(!cancel->load())
+		{
+			cache->prune(skipped);
+		}
+		cache->save(cacheFile);
+		return results;
+	});
+	m_watcher.setFuture(future);
+}
+
+DiskUsageScanner::Results DiskUsageScanner::run(DirectorySizeCache &cache, const QList<Job> &jobs, const std::atomic<bool> *cancel)
+{
+	Results results;
+	cache.beginScan();
+	for(auto &job: jobs)
+	{
+		if(cancel && cancel->load())
+		{
+			break;
+		}
+		// the whole instance goes first, the parts are then known without touching the disk again
+		InstanceDiskUsage usage;
+		usage.total = cache.size(job.root, job.notBefore);
+		auto sum = [&](const QStringList &paths)
+		{
+			qint64 total = 0;
+			for(auto &path: paths)
+			{
+				total += cache.size(path, job.notBefore);
+			}
+			return total;
+		};
+		usage.mods = sum(job.mods);
+		usage.logs = sum(job.logs);
+		usage.screenshots = sum(job.screenshots);
+		usage.resourcePacks = sum(job.resourcePacks);
+		if(!job.saves.isEmpty())
+		{
+			usage.saves = cache.size(job.saves, job.notBefore);
+			for(auto &world: cache.subdirectories(job.saves))
+			{
+				usage.worlds.insert(world, cache.size(FS::PathCombine(job.saves, world), job.notBefore));
+			}
+		}
+		results.append(qMakePair(job.id, usage));
+	}
+	qDebug() << "Disk usage of" << results.size() << "instances measured, listed" << cache.listedCount()
+		<< "directories and reused" << cache.reusedCount();
+	return results;
+}
+
+void DiskUsageScanner::scanFinished()
+{
+	for(auto &result: m_watcher.result())
+	{
+		auto instance = m_instances->getInstanceById(result.first);
+		if(instance)
+		{
+			instance->setDiskUsage(result.second);
+		}
+	}
+	emit finished();
+	if(m_rescan)
+	{
+		m_rescan = false;
+		scan();
+	}
+}
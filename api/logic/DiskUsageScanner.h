@@ -0,0 +1,90 @@
+/* Copyright 2013-2017 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <QObject>
+#include <QFutureWatcher>
+#include <QThreadPool>
+#include <QTimer>
+#include <memory>
+#include <atomic>
+
+#include "InstanceDiskUsage.h"
+#include "DirectorySizeCache.h"
+
+#include "multimc_logic_export.h"
+
+class InstanceList;
+
+/**
+ * Periodically measures how much disk space each instance uses, in the background and at idle priority.
+ *
+ * Listings of directories are cached in a file between runs, so only the parts of instances that changed get
+ * listed again. Running instances are skipped until they stop. Results end up in BaseInstance::diskUsage().
+ */
+class MULTIMC_LOGIC_EXPORT DiskUsageScanner : public QObject
+{
+	Q_OBJECT
+public:
+	DiskUsageScanner(InstanceList *instances, const QString &cacheFile, QObject *parent = nullptr);
+	virtual ~DiskUsageScanner();
+
+	/// scan after the delay (msecs), and then every interval. 0 interval means only once.
+	void start(int delay, int interval);
+
+	bool isScanning() const;
+
+public slots:
+	/// scan now, or right after the running scan
+	void scan();
+
+signals:
+	void finished();
+
+private slots:
+	void scanFinished();
+
+public:
+	struct Job
+	{
+		QString id;
+		QString root;
+		/// files written after this could have changed in place
+		qint64 notBefore = 0;
+		QStringList mods;
+		QStringList logs;
+		QStringList screenshots;
+		QStringList resourcePacks;
+		QString saves;
+	};
+	typedef QList<QPair<QString, InstanceDiskUsage>> Results;
+
+	/// measure the instances, using the cache. Stops early when cancel gets set.
+	static Results run(DirectorySizeCache &cache, const QList<Job> &jobs, const std::atomic<bool> *cancel = nullptr);
+
+private:
+	InstanceList *m_instances;
+	QString m_cacheFile;
+	std::shared_ptr<DirectorySizeCache> m_cache;
+	std::shared_ptr<std::atomic<bool>> m_cancel;
+	bool m_cacheLoaded = false;
+	bool m_rescan = false;
+	QTimer m_timer;
+	/// a pool of one thread, so the scanning thread priorities don't leak into other work
+	QThreadPool m_pool;
+	QFutureWatcher<Results> m_watcher;
+};
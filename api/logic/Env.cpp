@@ -6,6 +6,7 @@
 #include <QCoreApplication>
 #include <QNetworkProxy>
 #include <QNetworkAccessManager>
+#include <QThread>
 #include <QDebug>
 #include "tasks/Task.h"
 #include "meta/Index.h"
@@ -16,6 +17,8 @@
 struct Env::Private
 {
 	QNetworkAccessManager m_qnam;
+	QThread m_networkThread;
+	QNetworkAccessManager *m_networkQnam = nullptr;
 	shared_qobject_ptr<HttpMetaCache> m_metacache;
 	std::shared_ptr<IIconList> m_iconlist;
 	shared_qobject_ptr<Meta::Index> m_metadataIndex;
@@ -35,6 +38,12 @@ Env::Env()
 
 Env::~Env()
 {
+	if(d->m_networkQnam)
+	{
+		d->m_networkThread.quit();
+		d->m_networkThread.wait();
+		delete d->m_networkQnam;
+	}
 	delete d;
 }
 
@@ -63,6 +72,29 @@ QNetworkAccessManager& Env::qnam() const
 	return d->m_qnam;
 }
 
+QThread * Env::networkThread()
+{
+	if(!d->m_networkQnam)
+	{
+		// no explicit proxy, it follows the application proxy set by updateProxySettings
+		d->m_networkQnam = new QNetworkAccessManager();
+		d->m_networkQnam->moveToThread(&d->m_networkThread);
+		d->m_networkThread.setObjectName("Network");
+		d->m_networkThread.start();
+	}
+	return &d->m_networkThread;
+}
+
+bool Env::isNetworkThread() const
+{
+	return d->m_networkQnam && QThread::currentThread() == &d->m_networkThread;
+}
+
+QNetworkAccessManager& Env::networkQnam() const
+{
+	return *d->m_networkQnam;
+}
+
 std::shared_ptr<IIconList> Env::icons()
 {
 	return d->m_iconlist;
@@ -100,7 +132,8 @@ void Env::initHttpMetaCache()
 	m_metacache->addBase("translations", QDir("translations").absolutePath());
 	m_metacache->addBase("icons", QDir("cache/icons").absolutePath());
 	m_metacache->addBase("meta", QDir("meta").absolutePath());
-	m_metacache->Load();
+	// the index is only needed once something gets downloaded
+	m_metacache->LoadInBackground();
 }
 
 void Env::updateProxySettings(QString proxyTypeStr, QString addr, int port, QString user, QString password)
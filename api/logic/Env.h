@@ -10,6 +10,7 @@
 #include "QObjectPtr.h"
 
 class QNetworkAccessManager;
+class QThread;
 class HttpMetaCache;
 class BaseVersionList;
 class BaseVersion;
@@ -38,6 +39,15 @@ public:
 
 	QNetworkAccessManager &qnam() const;
 
+	/// thread the downloads of NetJobs run on, so the network and disk work stays off the GUI thread. Started on first use.
+	QThread *networkThread();
+
+	/// is this the network thread?
+	bool isNetworkThread() const;
+
+	/// the access manager living on the network thread, only usable from there
+	QNetworkAccessManager &networkQnam() const;
+
 	shared_qobject_ptr<HttpMetaCache> metacache();
 
 	std::shared_ptr<IIconList> icons();
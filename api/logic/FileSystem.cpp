@@ -1,6 +1,7 @@
 // Licensed under the Apache-2.0 license. See README.md for details.
 
 #include "FileSystem.h"
+#include "LoggingCategories.h"
 
 #include <QDir>
 #include <QSaveFile>
@@ -9,6 +10,13 @@
 #include <QUrl>
 #include <QStandardPaths>
 
+#if defined(Q_OS_UNIX)
+#include <fcntl.h>
+#include <unistd.h>
+#elif defined(Q_OS_WIN32)
+#include <io.h>
+#endif
+
 namespace FS {
 
 void ensureExists(const QDir &dir)
@@ -79,6 +87,34 @@ bool updateTimestamp(const QString& filename)
 
 }
 
+bool syncToDisk(const QString &path)
+{
+#if defined(Q_OS_UNIX)
+	int fd = ::open(QFile::encodeName(path).constData(), O_RDONLY);
+	if(fd == -1)
+	{
+		return false;
+	}
+#if defined(Q_OS_LINUX)
+	bool success = ::fdatasync(fd) == 0;
+#else
+	bool success = ::fsync(fd) == 0;
+#endif
+	::close(fd);
+	return success;
+#elif defined(Q_OS_WIN32)
+	// folders can't be flushed on Windows, their entries are journaled by NTFS anyway
+	if(QFileInfo(path).isDir())
+	{
+		return true;
+	}
+	QFile file(path);
+	return file.open(QIODevice::ReadWrite) && _commit(file.handle()) == 0;
+#else
+	return true;
+#endif
+}
+
 bool ensureFilePathExists(QString filenamepath)
 {
 	QFileInfo a(filenamepath);
@@ -113,7 +149,7 @@ bool copy::operator()(const QString &offset)
 
 	if(!m_followSymlinks && currentSrc.isSymLink())
 	{
-		qDebug() << "creating symlink" << src << " - " << dst;
+		qCDebug(logFS) << "creating symlink" << src << " - " << dst;
 		if (!ensureFilePathExists(dst))
 		{
 			qWarning() << "Cannot create path!";
@@ -123,7 +159,7 @@ bool copy::operator()(const QString &offset)
 	}
 	else if(currentSrc.isFile())
 	{
-		qDebug() << "copying file" << src << " - " << dst;
+		qCDebug(logFS) << "copying file" << src << " - " << dst;
 		if (!ensureFilePathExists(dst))
 		{
 			qWarning() << "Cannot create path!";
@@ -133,7 +169,7 @@ bool copy::operator()(const QString &offset)
 	}
 	else if(currentSrc.isDir())
 	{
-		qDebug() << "recursing" << offset;
+		qCDebug(logFS) << "recursing" << offset;
 		if (!ensureFolderPathExists(dst))
 		{
 			qWarning() << "Cannot create path!";
@@ -33,6 +33,11 @@ MULTIMC_LOGIC_EXPORT QByteArray read(const QString &filename);
  */
 MULTIMC_LOGIC_EXPORT bool updateTimestamp(const QString & filename);
 
+/**
+ * Flush a file, or the entries of a folder, to the disk
+ */
+MULTIMC_LOGIC_EXPORT bool syncToDisk(const QString &path);
+
 /**
  * Creates all the folders in a path for the specified path
  * last segment of the path is treated as a file name and is ignored!
@@ -18,7 +18,7 @@ InstanceCopyTask::InstanceCopyTask(SettingsObjectPtr settings, const QString & s
 	if(!copySaves)
 	{
 		// FIXME: get this from the original instance type...
-		auto matcherReal = new RegexpMatcher("[.]?minecraft/saves");
+		auto matcherReal = new RegexpMatcher("[.]?minecraft/saves|^world-backups");
 		matcherReal->caseSensitive(false);
 		m_matcher.reset(matcherReal);
 	}
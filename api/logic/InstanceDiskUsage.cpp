@@ -0,0 +1,59 @@
+/* Copyright 2013-2017 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "InstanceDiskUsage.h"
+#include "MMCStrings.h"
+
+#include <QObject>
+#include <algorithm>
+
+QString InstanceDiskUsage::describe() const
+{
+	if(!isValid())
+	{
+		return QString();
+	}
+	QList<QPair<qint64, QString>> parts = {
+		{saves, QObject::tr("saves")},
+		{mods, QObject::tr("mods")},
+		{resourcePacks, QObject::tr("resource packs")},
+		{screenshots, QObject::tr("screenshots")},
+		{logs, QObject::tr("logs")}
+	};
+	std::stable_sort(parts.begin(), parts.end(), [](const QPair<qint64, QString> &a, const QPair<qint64, QString> &b)
+	{
+		return a.first > b.first;
+	});
+	QStringList described;
+	for(auto &part: parts)
+	{
+		if(part.first > 0)
+		{
+			described.append(part.second + ' ' + Strings::humanReadableSize(part.first));
+		}
+	}
+	if(described.isEmpty())
+	{
+		return Strings::humanReadableSize(total);
+	}
+	return QString("%1 (%2)").arg(Strings::humanReadableSize(total), described.join(", "));
+}
+
+bool InstanceDiskUsage::operator==(const InstanceDiskUsage &other) const
+{
+	return total == other.total && mods == other.mods && saves == other.saves && logs == other.logs
+		&& screenshots == other.screenshots && resourcePacks == other.resourcePacks && worlds == other.worlds;
+}
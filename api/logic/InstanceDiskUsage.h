@@ -0,0 +1,57 @@
+/* Copyright 2013-2017 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <QMap>
+#include <QString>
+#include <QStringList>
+
+#include "multimc_logic_export.h"
+
+/// How much disk space an instance uses, by what it's used for. Sizes are in bytes.
+struct MULTIMC_LOGIC_EXPORT InstanceDiskUsage
+{
+	/// everything in the instance folder, -1 if it wasn't scanned yet
+	qint64 total = -1;
+	qint64 mods = 0;
+	qint64 saves = 0;
+	qint64 logs = 0;
+	qint64 screenshots = 0;
+	qint64 resourcePacks = 0;
+	/// size of each world, by folder name
+	QMap<QString, qint64> worlds;
+
+	bool isValid() const
+	{
+		return total >= 0;
+	}
+
+	/// what isn't in any of the categories - game files, configs, ...
+	qint64 other() const
+	{
+		return total - mods - saves - logs - screenshots - resourcePacks;
+	}
+
+	/// short summary, like "1.2 GiB (saves 800.0 MiB, mods 300.0 MiB)"
+	QString describe() const;
+
+	bool operator==(const InstanceDiskUsage &other) const;
+	bool operator!=(const InstanceDiskUsage &other) const
+	{
+		return !(*this == other);
+	}
+};
@@ -20,6 +20,7 @@
 #include <QTextStream>
 #include <QXmlStreamReader>
 #include <QDebug>
+#include <algorithm>
 
 #include "InstanceList.h"
 #include "BaseInstance.h"
@@ -31,6 +32,10 @@ InstanceList::InstanceList(SettingsObjectPtr globalSettings, const QString &inst
 {
 	m_globalSettings = globalSettings;
 	resumeWatch();
+
+	// models are not unloaded right away, someone who just closed an instance may come back to it
+	m_modelTimer.setInterval(60 * 1000);
+	connect(&m_modelTimer, &QTimer::timeout, this, &InstanceList::unloadIdleModels);
 }
 
 InstanceList::~InstanceList()
@@ -75,6 +80,11 @@ QVariant InstanceList::data(const QModelIndex &index, int role) const
 	}
 	case Qt::ToolTipRole:
 	{
+		auto usage = pdata->diskUsage();
+		if(usage.isValid())
+		{
+			return tr("%1\nDisk usage: %2").arg(pdata->instanceRoot(), usage.describe());
+		}
 		return pdata->instanceRoot();
 	}
 	case Qt::DecorationRole:
@@ -119,6 +129,66 @@ void InstanceList::deleteGroup(const QString& name)
 	}
 }
 
+void InstanceList::setModelBudget(int budget)
+{
+	m_modelBudget = budget;
+	if(budget < 0)
+	{
+		m_modelTimer.stop();
+	}
+	else
+	{
+		m_modelTimer.start();
+	}
+}
+
+QList<int> InstanceList::modelsToUnload(const QList<ModelUse> &uses, int budget)
+{
+	QList<int> idle;
+	if(budget < 0)
+	{
+		return idle;
+	}
+	for(int i = 0; i < uses.size(); i++)
+	{
+		if(uses[i].loaded && !uses[i].busy)
+		{
+			idle.append(i);
+		}
+	}
+	int excess = idle.size() - budget;
+	if(excess <= 0)
+	{
+		return QList<int>();
+	}
+	std::stable_sort(idle.begin(), idle.end(), [&uses](int a, int b)
+	{
+		return uses[a].lastUsed < uses[b].lastUsed;
+	});
+	return idle.mid(0, excess);
+}
+
+int InstanceList::unloadIdleModels()
+{
+	QList<ModelUse> uses;
+	for(auto &instance: m_instances)
+	{
+		ModelUse use;
+		use.loaded = instance->hasLoadedModels();
+		use.busy = instance->isRunning() || instance->isInUse();
+		use.lastUsed = instance->modelsLastUsed();
+		uses.append(use);
+	}
+	auto unload = modelsToUnload(uses, m_modelBudget);
+	for(auto i: unload)
+	{
+		auto instance = m_instances.at(i);
+		qDebug() << "Unloading models of idle instance" << instance->id();
+		instance->unloadModels();
+	}
+	return unload.size();
+}
+
 static QMap<InstanceId, InstanceLocator> getIdMapping(const QList<InstancePtr> &list)
 {
 	QMap<InstanceId, InstanceLocator> out;
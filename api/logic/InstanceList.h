@@ -19,6 +19,7 @@
 #include <QAbstractListModel>
 #include <QSet>
 #include <QList>
+#include <QTimer>
 
 #include "BaseInstance.h"
 #include "BaseInstanceProvider.h"
@@ -83,6 +84,25 @@ public:
 
 	void deleteGroup(const QString & name);
 
+	/// Keep the models of at most this many idle instances loaded. Negative means no limit.
+	void setModelBudget(int budget);
+
+	/**
+	 * Unload the models of the least recently used idle instances over the budget.
+	 * Idle instances are not running and not in use. Returns the number of unloaded instances.
+	 */
+	int unloadIdleModels();
+
+	struct ModelUse
+	{
+		bool loaded = false;
+		bool busy = false; // running or in use
+		quint64 lastUsed = 0;
+	};
+
+	/// Indexes of the entries whose models should be unloaded to get down to the budget, least recently used first
+	static QList<int> modelsToUnload(const QList<ModelUse> &uses, int budget);
+
 signals:
 	void dataIsInvalid();
 
@@ -105,4 +125,6 @@ protected:
 	QSet<QString> m_groups;
 	SettingsObjectPtr m_globalSettings;
 	QVector<shared_qobject_ptr<BaseInstanceProvider>> m_providers;
+	int m_modelBudget = -1;
+	QTimer m_modelTimer;
 };
@@ -0,0 +1,57 @@
+#include <QTest>
+#include "TestUtil.h"
+
+#include "InstanceList.h"
+
+static InstanceList::ModelUse use(bool loaded, bool busy, quint64 lastUsed)
+{
+	InstanceList::ModelUse out;
+	out.loaded = loaded;
+	out.busy = busy;
+	out.lastUsed = lastUsed;
+	return out;
+}
+
+class InstanceListTest : public QObject
+{
+	Q_OBJECT
+private
+slots:
+	void test_modelsToUnload_data()
+	{
+		QTest::addColumn<int>("budget");
+		QTest::addColumn<QList<int>>("expected");
+
+		// 0: idle, used at 5
+		// 1: idle, used at 2
+		// 2: running, used at 1
+		// 3: not loaded, used at 0
+		// 4: idle, used at 9
+		// 5: idle, used at 2
+		QTest::newRow("no limit") << -1 << QList<int>();
+		QTest::newRow("under budget") << 5 << QList<int>();
+		QTest::newRow("at budget") << 4 << QList<int>();
+		QTest::newRow("one over") << 3 << (QList<int>() << 1);
+		QTest::newRow("ties keep list order") << 2 << (QList<int>() << 1 << 5);
+		QTest::newRow("keep the most recent") << 1 << (QList<int>() << 1 << 5 << 0);
+		QTest::newRow("nothing kept") << 0 << (QList<int>() << 1 << 5 << 0 << 4);
+	}
+	void test_modelsToUnload()
+	{
+		QFETCH(int, budget);
+		QFETCH(QList<int>, expected);
+
+		QList<InstanceList::ModelUse> uses;
+		uses << use(true, false, 5);
+		uses << use(true, false, 2);
+		uses << use(true, true, 1);
+		uses << use(false, false, 0);
+		uses << use(true, false, 9);
+		uses << use(true, false, 2);
+		QCOMPARE(InstanceList::modelsToUnload(uses, budget), expected);
+	}
+};
+
+QTEST_GUILESS_MAIN(InstanceListTest)
+
+#include "InstanceList_test.moc"
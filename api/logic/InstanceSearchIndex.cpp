@@ -0,0 +1,204 @@
+/* Copyright 2013-2017 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "InstanceSearchIndex.h"
+
+namespace {
+// single letters and pairs would match nearly every name as a subsequence
+const int fuzzyTermLength = 3;
+
+QString normalize(const QString &text)
+{
+	return text.simplified().toCaseFolded();
+}
+
+bool isSubsequence(const QString &needle, const QString &haystack)
+{
+	int found = 0;
+	for(int i = 0; i < haystack.size() && found < needle.size(); i++)
+	{
+		if(haystack[i] == needle[found])
+		{
+			found++;
+		}
+	}
+	return found == needle.size();
+}
+}
+
+void InstanceSearchIndex::insert(const QString &id, const QStringList &fields)
+{
+	Entry entry;
+	if(!fields.isEmpty())
+	{
+		entry.name = normalize(fields.first());
+		entry.text = normalize(fields.mid(1).join('\n'));
+	}
+	m_entries.insert(id, entry);
+	// keep the kept results valid instead of throwing them away
+	for(auto &step: m_steps)
+	{
+		if(entryMatches(entry, step.terms))
+		{
+			step.matches.insert(id);
+		}
+		else
+		{
+			step.matches.remove(id);
+		}
+	}
+}
+
+void InstanceSearchIndex::remove(const QString &id)
+{
+	m_entries.remove(id);
+	for(auto &step: m_steps)
+	{
+		step.matches.remove(id);
+	}
+}
+
+void InstanceSearchIndex::clear()
+{
+	m_entries.clear();
+	m_steps.clear();
+}
+
+int InstanceSearchIndex::size() const
+{
+	return m_entries.size();
+}
+
+bool InstanceSearchIndex::setQuery(const QString &query)
+{
+	QString normalized = normalize(query);
+	QSet<QString> previous;
+	bool wasFiltering = isFiltering();
+	if(wasFiltering)
+	{
+		if(m_steps.last().query == normalized)
+		{
+			return false;
+		}
+		previous = m_steps.last().matches;
+	}
+
+	// go back to the longest earlier query this one continues
+	while(!m_steps.isEmpty() && !normalized.startsWith(m_steps.last().query))
+	{
+		m_steps.removeLast();
+	}
+	if(normalized.isEmpty())
+	{
+		m_steps.clear();
+		return wasFiltering && previous.size() != m_entries.size();
+	}
+
+	if(m_steps.isEmpty() || m_steps.last().query != normalized)
+	{
+		Step step;
+		step.query = normalized;
+		step.terms = normalized.split(' ', QString::SkipEmptyParts);
+		// a longer query can only match less, unless it turned a short term into one that is fuzzy matched
+		bool narrow = !m_steps.isEmpty();
+		if(narrow)
+		{
+			auto &before = m_steps.last().terms.last();
+			auto &after = step.terms[m_steps.last().terms.size() - 1];
+			narrow = before.size() >= fuzzyTermLength || after.size() < fuzzyTermLength;
+		}
+		if(!narrow)
+		{
+			for(auto iter = m_entries.cbegin(); iter != m_entries.cend(); iter++)
+			{
+				if(entryMatches(iter.value(), step.terms))
+				{
+					step.matches.insert(iter.key());
+				}
+			}
+		}
+		else
+		{
+			for(auto &id: m_steps.last().matches)
+			{
+				if(entryMatches(m_entries.value(id), step.terms))
+				{
+					step.matches.insert(id);
+				}
+			}
+		}
+		m_steps.append(step);
+	}
+
+	if(!wasFiltering)
+	{
+		return m_steps.last().matches.size() != m_entries.size();
+	}
+	return m_steps.last().matches != previous;
+}
+
+QString InstanceSearchIndex::query() const
+{
+	if(m_steps.isEmpty())
+	{
+		return QString();
+	}
+	return m_steps.last().query;
+}
+
+bool InstanceSearchIndex::isFiltering() const
+{
+	return !m_steps.isEmpty();
+}
+
+bool InstanceSearchIndex::matches(const QString &id) const
+{
+	if(m_steps.isEmpty())
+	{
+		return true;
+	}
+	return m_steps.last().matches.contains(id);
+}
+
+QSet<QString> InstanceSearchIndex::matchingIds() const
+{
+	if(m_steps.isEmpty())
+	{
+		return m_entries.keys().toSet();
+	}
+	return m_steps.last().matches;
+}
+
+bool InstanceSearchIndex::termMatches(const QString &term, const QString &name, const QString &text)
+{
+	if(name.contains(term) || text.contains(term))
+	{
+		return true;
+	}
+	return term.size() >= fuzzyTermLength && isSubsequence(term, name);
+}
+
+bool InstanceSearchIndex::entryMatches(const Entry &entry, const QStringList &terms)
+{
+	for(auto &term: terms)
+	{
+		if(!termMatches(term, entry.name, entry.text))
+		{
+			return false;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,87 @@
+/* Copyright 2013-2017 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+
+#include "multimc_logic_export.h"
+
+/**
+ * In-memory search index over instances, used to filter the instance view as the user types.
+ *
+ * Every instance is stored as a name plus a blob of other searchable text (group, notes, versions...),
+ * already case folded. A query is split into terms and an instance matches when every term matches:
+ * as a prefix or substring of any field, or, for terms of three or more characters, as a subsequence
+ * of the name ("vnl" finds "Vanilla").
+ *
+ * The results of the queries typed on the way to the current one are kept, so typing another character
+ * only checks the instances that matched before it, and deleting one goes back to an earlier result.
+ */
+class MULTIMC_LOGIC_EXPORT InstanceSearchIndex
+{
+public:
+	/// add or replace an instance. The first field is its name.
+	void insert(const QString &id, const QStringList &fields);
+
+	/// remove an instance from the index
+	void remove(const QString &id);
+
+	/// remove everything, including the query
+	void clear();
+
+	int size() const;
+
+	/// set the query. Returns true if the set of matching instances changed.
+	bool setQuery(const QString &query);
+
+	QString query() const;
+
+	/// is there a query that filters instances?
+	bool isFiltering() const;
+
+	/// does the instance match the current query? Everything matches an empty query.
+	bool matches(const QString &id) const;
+
+	/// the ids of all instances matching the current query
+	QSet<QString> matchingIds() const;
+
+	/// does a single case folded term match the case folded name or the other text?
+	static bool termMatches(const QString &term, const QString &name, const QString &text);
+
+private:
+	struct Entry
+	{
+		QString name;
+		QString text;
+	};
+	struct Step
+	{
+		QString query;
+		QStringList terms;
+		QSet<QString> matches;
+	};
+	static bool entryMatches(const Entry &entry, const QStringList &terms);
+
+private:
+	QHash<QString, Entry> m_entries;
+	/// the current query is last, each step before it is a prefix of the one after it
+	QVector<Step> m_steps;
+};
@@ -0,0 +1,109 @@
+#include <QTest>
+#include "TestUtil.h"
+
+#include "InstanceSearchIndex.h"
+
+typedef QSet<QString> Ids;
+
+class InstanceSearchIndexTest : public QObject
+{
+	Q_OBJECT
+private:
+	InstanceSearchIndex makeIndex()
+	{
+		InstanceSearchIndex index;
+		index.insert("vanilla", {"Vanilla", "Minecraft 1.12.2"});
+		index.insert("skyblock", {"SkyBlock Survival", "Survival", "with the lads", "Minecraft 1.7.10", "Forge 10.13.4.1614"});
+		index.insert("ftb", {"FTB Infinity", "Packs", "Minecraft 1.7.10", "Forge 10.13.4.1614", "LiteLoader 1.7.10"});
+		index.insert("snapshot", {"Snapshot test", "Testing", "Minecraft 18w10d"});
+		return index;
+	}
+
+private
+slots:
+	void test_query_data()
+	{
+		QTest::addColumn<QString>("query");
+		QTest::addColumn<Ids>("expected");
+
+		QTest::newRow("empty") << "" << (Ids() << "vanilla" << "skyblock" << "ftb" << "snapshot");
+		QTest::newRow("name prefix") << "sky" << (Ids() << "skyblock");
+		QTest::newRow("case") << "VANILLA" << (Ids() << "vanilla");
+		QTest::newRow("group") << "packs" << (Ids() << "ftb");
+		QTest::newRow("notes") << "lads" << (Ids() << "skyblock");
+		QTest::newRow("version") << "1.7.10" << (Ids() << "skyblock" << "ftb");
+		QTest::newRow("component") << "liteloader" << (Ids() << "ftb");
+		QTest::newRow("all terms") << "1.7.10 forge survival" << (Ids() << "skyblock");
+		QTest::newRow("fuzzy") << "vnl" << (Ids() << "vanilla");
+		QTest::newRow("short terms are not fuzzy") << "vn" << Ids();
+		QTest::newRow("fuzzy is only the name") << "lds" << Ids();
+		QTest::newRow("nothing") << "bukkit" << Ids();
+	}
+	void test_query()
+	{
+		QFETCH(QString, query);
+		QFETCH(Ids, expected);
+
+		auto index = makeIndex();
+		index.setQuery(query);
+		QCOMPARE(index.matchingIds(), expected);
+		for(auto &id: Ids() << "vanilla" << "skyblock" << "ftb" << "snapshot")
+		{
+			QCOMPARE(index.matches(id), expected.contains(id));
+		}
+	}
+
+	void test_typing()
+	{
+		auto index = makeIndex();
+		QVERIFY(!index.isFiltering());
+
+		// typing narrows down
+		QVERIFY(index.setQuery("s"));
+		QCOMPARE(index.matchingIds(), Ids() << "skyblock" << "snapshot" << "ftb");
+		QVERIFY(index.setQuery("sn"));
+		QCOMPARE(index.matchingIds(), Ids() << "snapshot");
+		QVERIFY(!index.setQuery("sn "));
+
+		QVERIFY(!index.setQuery("snt"));
+		QCOMPARE(index.matchingIds(), Ids() << "snapshot");
+		QVERIFY(index.setQuery("sky"));
+		QCOMPARE(index.matchingIds(), Ids() << "skyblock");
+
+		// the third character turns on fuzzy matching, which can match more than before
+		index.setQuery("sv");
+		QCOMPARE(index.matchingIds(), Ids());
+		index.setQuery("svl");
+		QCOMPARE(index.matchingIds(), Ids() << "skyblock");
+
+		// deleting goes back
+		QVERIFY(index.setQuery("s"));
+		QCOMPARE(index.matchingIds().size(), 3);
+		QVERIFY(index.setQuery(""));
+		QVERIFY(!index.isFiltering());
+	}
+
+	void test_update()
+	{
+		auto index = makeIndex();
+		index.setQuery("1.7");
+		index.setQuery("1.7.10");
+		QCOMPARE(index.matchingIds(), Ids() << "skyblock" << "ftb");
+
+		// changes apply to the current query and the ones before it
+		index.insert("vanilla", {"Vanilla", "Minecraft 1.7.10"});
+		index.remove("ftb");
+		QCOMPARE(index.matchingIds(), Ids() << "skyblock" << "vanilla");
+		index.setQuery("1.7");
+		QCOMPARE(index.matchingIds(), Ids() << "skyblock" << "vanilla");
+		QCOMPARE(index.size(), 3);
+
+		index.clear();
+		QVERIFY(!index.isFiltering());
+		QCOMPARE(index.matchingIds(), Ids());
+	}
+};
+
+QTEST_GUILESS_MAIN(InstanceSearchIndexTest)
+
+#include "InstanceSearchIndex_test.moc"
@@ -1,6 +1,22 @@
 #include "LoggedProcess.h"
 #include "MessageLevel.h"
+
+#if defined Q_OS_WIN32
+#include <windows.h>
+#endif
 #include <QDebug>
+#include <QFile>
+#include <QThread>
+
+#if defined(Q_OS_LINUX)
+#include <sched.h>
+#endif
+#if defined(Q_OS_UNIX)
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#endif
 
 LoggedProcess::LoggedProcess(QObject *parent) : QProcess(parent)
 {
@@ -46,6 +62,7 @@ void LoggedProcess::on_exit(int exit_code, QProcess::ExitStatus status)
 {
 	// save the exit code
 	m_exit_code = exit_code;
+	removeCgroup();
 
 	// Flush console window
 	if (!m_err_leftover.isEmpty())
@@ -93,6 +110,7 @@ void LoggedProcess::on_error(QProcess::ProcessError error)
 		case QProcess::FailedToStart:
 		{
 			emit log({tr("The process failed to start.")}, MessageLevel::Fatal);
+			removeCgroup();
 			changeState(LoggedProcess::FailedToStart);
 			break;
 		}
@@ -151,15 +169,49 @@ void LoggedProcess::on_stateChange(QProcess::ProcessState state)
 			{
 				qWarning() << "Wrong state change for process from state" << m_state << "to" << (int) LoggedProcess::Running;
 			}
+#ifdef Q_OS_WIN
+			// there's no hook between creating the process and running it here, but the limits are per process anyway
+			if(pid())
+			{
+				auto handle = pid()->hProcess;
+				const auto &cpus = m_limits.cpus;
+				if(!cpus.isEmpty())
+				{
+					DWORD_PTR mask = 0;
+					for(auto cpu: cpus)
+					{
+						mask |= DWORD_PTR(1) << cpu;
+					}
+					SetProcessAffinityMask(handle, mask);
+				}
+				if(m_limits.nice > 0)
+				{
+					SetPriorityClass(handle, m_limits.nice >= 15 ? IDLE_PRIORITY_CLASS : BELOW_NORMAL_PRIORITY_CLASS);
+				}
+				else if(m_limits.nice < 0)
+				{
+					SetPriorityClass(handle, m_limits.nice <= -15 ? HIGH_PRIORITY_CLASS : ABOVE_NORMAL_PRIORITY_CLASS);
+				}
+			}
+#endif
+#if defined(Q_OS_UNIX)
+			// the child can't report anything, so check what it got. Lowering the niceness usually needs privileges.
+			if(m_limits.nice != 0 && pid())
+			{
+				errno = 0;
+				int actual = getpriority(PRIO_PROCESS, pid());
+				if(errno == 0 && actual != m_limits.nice)
+				{
+					emit log({tr("Couldn't set the priority to nice %1, the process runs at nice %2.").arg(m_limits.nice).arg(actual)}, MessageLevel::Warning);
+				}
+			}
+#endif
 			changeState(LoggedProcess::Running);
 			return;
 		}
 	}
 }
 
-#if defined Q_OS_WIN32
-#include <windows.h>
-#endif
 
 qint64 LoggedProcess::processId() const
 {
@@ -174,3 +226,119 @@ void LoggedProcess::setDetachable(bool detachable)
 {
 	m_is_detachable = detachable;
 }
+
+QStringList LoggedProcess::setLimits(const ProcessLimits &limits, const QString &name)
+{
+	QStringList warnings;
+	m_limits = limits;
+	m_cgroup.clear();
+	m_cgroupProcs.clear();
+	m_cpuSet.clear();
+
+	int cpuCount = QThread::idealThreadCount();
+	if(cpuCount > 0)
+	{
+		QList<int> usable;
+		for(auto cpu: limits.cpus)
+		{
+			if(cpu < cpuCount)
+			{
+				usable.append(cpu);
+			}
+		}
+		if(usable.size() != m_limits.cpus.size())
+		{
+			warnings << tr("This computer only has CPUs 0 to %1, ignoring the others in the CPU affinity.").arg(cpuCount - 1);
+			m_limits.cpus = usable;
+		}
+	}
+#if !defined(Q_OS_LINUX) && !defined(Q_OS_WIN)
+	if(!m_limits.cpus.isEmpty())
+	{
+		warnings << tr("CPU affinity isn't supported on this system.");
+		m_limits.cpus.clear();
+	}
+#endif
+#ifndef Q_OS_LINUX
+	if(m_limits.ioPriority != ProcessLimits::IODefault)
+	{
+		warnings << tr("I/O priority is only supported on Linux.");
+		m_limits.ioPriority = ProcessLimits::IODefault;
+	}
+#endif
+#if defined(Q_OS_LINUX)
+	const auto &cpus = m_limits.cpus;
+	if(!cpus.isEmpty())
+	{
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		for(auto cpu: cpus)
+		{
+			if(cpu < CPU_SETSIZE)
+			{
+				CPU_SET(cpu, &set);
+			}
+		}
+		m_cpuSet = QByteArray(reinterpret_cast<const char *>(&set), sizeof(set));
+	}
+#endif
+	if(m_limits.needsCgroup())
+	{
+		QString error;
+		auto group = m_limits.createCgroup(name, &error);
+		if(group.isEmpty())
+		{
+			warnings << error;
+		}
+		else
+		{
+			m_cgroup = group;
+			m_cgroupProcs = QFile::encodeName(group + "/cgroup.procs");
+		}
+	}
+	return warnings;
+}
+
+void LoggedProcess::removeCgroup()
+{
+	if(m_cgroup.isEmpty())
+	{
+		return;
+	}
+	// anything the game left running keeps the cgroup alive. It's reused by the next launch.
+	if(!ProcessLimits::removeCgroup(m_cgroup))
+	{
+		qWarning() << "Couldn't remove the cgroup" << m_cgroup;
+	}
+	m_cgroup.clear();
+	m_cgroupProcs.clear();
+}
+
+void LoggedProcess::setupChildProcess()
+{
+	// NOTE: this runs in the forked child. Only plain system calls from here on, nothing that allocates or locks.
+#if defined(Q_OS_LINUX)
+	if(!m_cgroupProcs.isEmpty())
+	{
+		int fd = ::open(m_cgroupProcs.constData(), O_WRONLY | O_CLOEXEC);
+		if(fd >= 0)
+		{
+			// "0" means the writing process
+			auto written = ::write(fd, "0", 1);
+			Q_UNUSED(written);
+			::close(fd);
+		}
+	}
+	if(!m_cpuSet.isEmpty())
+	{
+		sched_setaffinity(0, m_cpuSet.size(), reinterpret_cast<const cpu_set_t *>(m_cpuSet.constData()));
+	}
+	ProcessLimits::setThreadIOPriority(m_limits.ioPriority);
+#endif
+#if defined(Q_OS_UNIX)
+	if(m_limits.nice != 0)
+	{
+		setpriority(PRIO_PROCESS, 0, m_limits.nice);
+	}
+#endif
+}
@@ -17,6 +17,7 @@
 
 #include <QProcess>
 #include "MessageLevel.h"
+#include "ProcessLimits.h"
 #include "multimc_logic_export.h"
 
 /*
@@ -48,6 +49,15 @@ public:
 
 	void setDetachable(bool detachable);
 
+	/**
+	 * Apply scheduling and resource limits to the process when it's started.
+	 * Returns warnings about the limits that can't be applied, the rest still is.
+	 */
+	QStringList setLimits(const ProcessLimits &limits, const QString &name);
+
+protected:
+	void setupChildProcess() override;
+
 signals:
 	void log(QStringList lines, MessageLevel::Enum level);
 	void stateChanged(LoggedProcess::State state);
@@ -68,6 +78,7 @@ private slots:
 
 private:
 	void changeState(LoggedProcess::State state);
+	void removeCgroup();
 
 private:
 	QString m_err_leftover;
@@ -77,4 +88,9 @@ private:
 	int m_exit_code = 0;
 	bool m_is_aborting = false;
 	bool m_is_detachable = false;
+	ProcessLimits m_limits;
+	QString m_cgroup;
+	QByteArray m_cgroupProcs;
+	/// a cpu_set_t, made before the fork so the child doesn't have to allocate. Empty means any CPU.
+	QByteArray m_cpuSet;
 };
@@ -0,0 +1,22 @@
+/* Copyright 2013-2017 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "LoggingCategories.h"
+
+Q_LOGGING_CATEGORY(logFS, "multimc.fs", QtInfoMsg)
+Q_LOGGING_CATEGORY(logNet, "multimc.net", QtInfoMsg)
+Q_LOGGING_CATEGORY(logMetaCache, "multimc.net.metacache", QtInfoMsg)
+Q_LOGGING_CATEGORY(logComponents, "multimc.components", QtInfoMsg)
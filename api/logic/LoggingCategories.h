@@ -0,0 +1,39 @@
+/* Copyright 2013-2017 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <QLoggingCategory>
+
+/*
+ * Logging categories for code that logs a lot in loops - file operations, downloads, profile application.
+ *
+ * Their debug messages are off unless enabled at runtime by rules like "multimc.net.debug=true", either
+ * from the LoggingRules setting or the QT_LOGGING_RULES environment variable. A disabled qCDebug() doesn't
+ * even evaluate its arguments.
+ */
+
+/// copying, linking and deleting files
+Q_DECLARE_LOGGING_CATEGORY(logFS)
+
+/// individual downloads
+Q_DECLARE_LOGGING_CATEGORY(logNet)
+
+/// the download cache index
+Q_DECLARE_LOGGING_CATEGORY(logMetaCache)
+
+/// loading and applying instance components
+Q_DECLARE_LOGGING_CATEGORY(logComponents)
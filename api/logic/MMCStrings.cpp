@@ -74,3 +74,20 @@ int Strings::naturalCompare(const QString &s1, const QString &s2, Qt::CaseSensit
 	// The two strings are the same (02 == 2) so fall back to the normal sort
 	return QString::compare(s1, s2, cs);
 }
+
+QString Strings::humanReadableSize(qint64 bytes)
+{
+	static const char *units[] = {"KiB", "MiB", "GiB", "TiB"};
+	if(bytes < 1024)
+	{
+		return QString("%1 B").arg(bytes);
+	}
+	double value = bytes / 1024.0;
+	int unit = 0;
+	while(value >= 1024.0 && unit < 3)
+	{
+		value /= 1024.0;
+		unit++;
+	}
+	return QString("%1 %2").arg(value, 0, 'f', 1).arg(units[unit]);
+}
@@ -7,4 +7,7 @@
 namespace Strings
 {
 	int MULTIMC_LOGIC_EXPORT naturalCompare(const QString &s1, const QString &s2, Qt::CaseSensitivity cs);
+
+	/// a byte count like "1.5 GiB"
+	QString MULTIMC_LOGIC_EXPORT humanReadableSize(qint64 bytes);
 }
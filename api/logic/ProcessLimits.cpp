@@ -0,0 +1,288 @@
+#include "ProcessLimits.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QObject>
+#include <QRegularExpression>
+#include <QTextStream>
+
+#include <algorithm>
+
+#if defined(Q_OS_LINUX)
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+bool ProcessLimits::setThreadIOPriority(IOPriority priority)
+{
+#if defined(Q_OS_LINUX)
+	if(priority == IODefault)
+	{
+		return true;
+	}
+	// see linux/ioprio.h. The I/O priority belongs to the thread, 0 is the calling one.
+	const int whoProcess = 1;
+	const int classShift = 13;
+	const int bestEffort = 2;
+	const int idle = 3;
+	int value = 0;
+	switch(priority)
+	{
+		case IOHigh:
+			value = (bestEffort << classShift) | 0;
+			break;
+		case IONormal:
+			value = (bestEffort << classShift) | 4;
+			break;
+		case IOLow:
+			value = (bestEffort << classShift) | 7;
+			break;
+		case IOIdle:
+		default:
+			value = idle << classShift;
+			break;
+	}
+	return syscall(SYS_ioprio_set, whoProcess, 0, value) == 0;
+#else
+	Q_UNUSED(priority);
+	return false;
+#endif
+}
+
+bool ProcessLimits::isEmpty() const
+{
+	return cpus.isEmpty() && nice == 0 && ioPriority == IODefault && !needsCgroup();
+}
+
+QStringList ProcessLimits::describe() const
+{
+	if(isEmpty())
+	{
+		return {"Process resources: inherited"};
+	}
+	QStringList out;
+	out << "Process resources:";
+	if(!cpus.isEmpty())
+	{
+		out << "  CPU affinity: " + formatCpuList(cpus);
+	}
+	if(nice != 0)
+	{
+		out << QString("  Priority: nice %1").arg(nice);
+	}
+	if(ioPriority != IODefault)
+	{
+		out << "  I/O priority: " + ioPriorityName(ioPriority);
+	}
+	if(memoryLimit > 0)
+	{
+		out << QString("  Memory limit: %1 MB").arg(memoryLimit);
+	}
+	if(cpuLimit > 0)
+	{
+		out << QString("  CPU limit: %1%").arg(cpuLimit);
+	}
+	return out;
+}
+
+bool ProcessLimits::parseCpuList(const QString &text, QList<int> &cpus)
+{
+	cpus.clear();
+	auto trimmed = text.trimmed();
+	if(trimmed.isEmpty())
+	{
+		return true;
+	}
+	static const QRegularExpression item("^(\\d+)(?:-(\\d+))?$");
+	for(auto &part: trimmed.split(','))
+	{
+		auto match = item.match(part.trimmed());
+		if(!match.hasMatch())
+		{
+			cpus.clear();
+			return false;
+		}
+		int first = match.captured(1).toInt();
+		int last = match.captured(2).isEmpty() ? first : match.captured(2).toInt();
+		// nobody has that many CPUs, this is a typo
+		if(last < first || last > 4095)
+		{
+			cpus.clear();
+			return false;
+		}
+		for(int cpu = first; cpu <= last; cpu++)
+		{
+			if(!cpus.contains(cpu))
+			{
+				cpus.append(cpu);
+			}
+		}
+	}
+	std::sort(cpus.begin(), cpus.end());
+	return true;
+}
+
+QString ProcessLimits::formatCpuList(const QList<int> &cpus)
+{
+	QStringList parts;
+	int i = 0;
+	while(i < cpus.size())
+	{
+		int j = i;
+		while(j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1)
+		{
+			j++;
+		}
+		if(j == i)
+		{
+			parts << QString::number(cpus[i]);
+		}
+		else
+		{
+			parts << QString("%1-%2").arg(cpus[i]).arg(cpus[j]);
+		}
+		i = j + 1;
+	}
+	return parts.join(',');
+}
+
+ProcessLimits::IOPriority ProcessLimits::parseIOPriority(const QString &name)
+{
+	if(name == "high")
+		return IOHigh;
+	if(name == "normal")
+		return IONormal;
+	if(name == "low")
+		return IOLow;
+	if(name == "idle")
+		return IOIdle;
+	return IODefault;
+}
+
+QString ProcessLimits::ioPriorityName(IOPriority priority)
+{
+	switch(priority)
+	{
+		case IOHigh:
+			return "high";
+		case IONormal:
+			return "normal";
+		case IOLow:
+			return "low";
+		case IOIdle:
+			return "idle";
+		case IODefault:
+		default:
+			return QString();
+	}
+}
+
+QString ProcessLimits::createCgroup(const QString &name, QString *error) const
+{
+#ifdef Q_OS_LINUX
+	const QString root = "/sys/fs/cgroup";
+	if(!QFile::exists(root + "/cgroup.controllers"))
+	{
+		*error = QObject::tr("Resource limits need the unified cgroup (v2) hierarchy.");
+		return QString();
+	}
+
+	// find the cgroup we run in: "0::/user.slice/..."
+	QString ownPath;
+	{
+		QFile file("/proc/self/cgroup");
+		if(!file.open(QIODevice::ReadOnly))
+		{
+			*error = QObject::tr("Couldn't read /proc/self/cgroup.");
+			return QString();
+		}
+		for(auto &line: QString::fromUtf8(file.readAll()).split('\n'))
+		{
+			if(line.startsWith("0::"))
+			{
+				ownPath = line.mid(3);
+				break;
+			}
+		}
+	}
+	if(ownPath.isEmpty() || ownPath == "/")
+	{
+		*error = QObject::tr("Couldn't find a delegated cgroup to put the game in.");
+		return QString();
+	}
+
+	// processes can only live in leaf groups, and ours has us in it. So the game goes next to it.
+	QString safeName = name;
+	safeName.replace(QRegularExpression("[^A-Za-z0-9_.-]"), "_");
+	auto parent = QFileInfo(root + ownPath).absolutePath();
+	auto group = parent + "/multimc-" + safeName;
+	if(!QDir(group).exists() && !QDir().mkdir(group))
+	{
+		*error = QObject::tr("Couldn't create the cgroup %1. Is the cgroup tree delegated to your user?").arg(group);
+		return QString();
+	}
+
+	auto readFile = [](const QString &path) -> QString
+	{
+		QFile file(path);
+		if(!file.open(QIODevice::ReadOnly))
+		{
+			return QString();
+		}
+		return QString::fromUtf8(file.readAll()).trimmed();
+	};
+	auto writeFile = [](const QString &path, const QString &value) -> bool
+	{
+		QFile file(path);
+		if(!file.open(QIODevice::WriteOnly))
+		{
+			return false;
+		}
+		return file.write(value.toUtf8()) != -1;
+	};
+
+	auto controllers = readFile(group + "/cgroup.controllers").split(' ');
+	if(memoryLimit > 0)
+	{
+		if(!controllers.contains("memory") || !writeFile(group + "/memory.max", QString::number(qint64(memoryLimit) * 1024 * 1024)))
+		{
+			*error = QObject::tr("The memory controller isn't available in %1.").arg(group);
+			return QString();
+		}
+	}
+	else
+	{
+		writeFile(group + "/memory.max", "max");
+	}
+	if(cpuLimit > 0)
+	{
+		// quota and period in microseconds
+		if(!controllers.contains("cpu") || !writeFile(group + "/cpu.max", QString("%1 100000").arg(cpuLimit * 1000)))
+		{
+			*error = QObject::tr("The cpu controller isn't available in %1.").arg(group);
+			return QString();
+		}
+	}
+	else
+	{
+		writeFile(group + "/cpu.max", "max");
+	}
+	return group;
+#else
+	Q_UNUSED(name);
+	*error = QObject::tr("Memory and CPU limits are only supported on Linux.");
+	return QString();
+#endif
+}
+
+bool ProcessLimits::removeCgroup(const QString &path)
+{
+#ifdef Q_OS_LINUX
+	// the control files aren't real files, a cgroup with no processes in it goes away with rmdir
+	return ::rmdir(QFile::encodeName(path).constData()) == 0;
+#else
+	Q_UNUSED(path);
+	return false;
+#endif
+}
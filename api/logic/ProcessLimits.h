@@ -0,0 +1,63 @@
+#pragma once
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+#include "multimc_logic_export.h"
+
+/**
+ * Scheduling and resource limits for a launched process.
+ *
+ * Affinity, niceness and I/O priority are applied in the child before it runs anything.
+ * The memory and CPU caps need a delegated cgroup v2 hierarchy, so they only work on Linux.
+ */
+struct MULTIMC_LOGIC_EXPORT ProcessLimits
+{
+	enum IOPriority
+	{
+		IODefault,
+		IOHigh,
+		IONormal,
+		IOLow,
+		IOIdle
+	};
+
+	/// CPUs the process may run on. Empty means all of them.
+	QList<int> cpus;
+	/// niceness, -20 to 19. Lower than the current one usually needs privileges.
+	int nice = 0;
+	IOPriority ioPriority = IODefault;
+	/// memory cap in MiB, 0 for none
+	int memoryLimit = 0;
+	/// CPU cap in percent of one CPU, 0 for none
+	int cpuLimit = 0;
+
+	bool isEmpty() const;
+	bool needsCgroup() const
+	{
+		return memoryLimit > 0 || cpuLimit > 0;
+	}
+
+	/// human readable summary for the instance log
+	QStringList describe() const;
+
+	/// parse a CPU list like "0-3,6". Returns false on garbage.
+	static bool parseCpuList(const QString &text, QList<int> &cpus);
+	static QString formatCpuList(const QList<int> &cpus);
+
+	static IOPriority parseIOPriority(const QString &name);
+	static QString ioPriorityName(IOPriority priority);
+
+	/// Set the I/O priority of the calling thread. Only does something on Linux. Safe to call after fork().
+	static bool setThreadIOPriority(IOPriority priority);
+
+	/**
+	 * Create a cgroup for the process next to the one we run in and set its limits.
+	 * Returns the path of the cgroup, or an empty string and an error.
+	 */
+	QString createCgroup(const QString &name, QString *error) const;
+
+	/// Remove a cgroup made by createCgroup. Fails while anything still runs in it.
+	static bool removeCgroup(const QString &path);
+};
@@ -0,0 +1,62 @@
+#include <QTest>
+#include "TestUtil.h"
+
+#include "ProcessLimits.h"
+
+class ProcessLimitsTest : public QObject
+{
+	Q_OBJECT
+private
+slots:
+	void test_parseCpuList_data()
+	{
+		QTest::addColumn<QString>("text");
+		QTest::addColumn<bool>("valid");
+		QTest::addColumn<QList<int>>("cpus");
+		QTest::addColumn<QString>("formatted");
+
+		QTest::newRow("empty") << "" << true << QList<int>() << "";
+		QTest::newRow("single") << "3" << true << (QList<int>() << 3) << "3";
+		QTest::newRow("range") << "0-3" << true << (QList<int>() << 0 << 1 << 2 << 3) << "0-3";
+		QTest::newRow("mixed") << " 6, 0-2 ,2" << true << (QList<int>() << 0 << 1 << 2 << 6) << "0-2,6";
+		QTest::newRow("backwards") << "3-1" << false << QList<int>() << "";
+		QTest::newRow("garbage") << "all" << false << QList<int>() << "";
+		QTest::newRow("trailing comma") << "1," << false << QList<int>() << "";
+	}
+	void test_parseCpuList()
+	{
+		QFETCH(QString, text);
+		QFETCH(bool, valid);
+		QFETCH(QList<int>, cpus);
+		QFETCH(QString, formatted);
+
+		QList<int> result;
+		QCOMPARE(ProcessLimits::parseCpuList(text, result), valid);
+		QCOMPARE(result, cpus);
+		QCOMPARE(ProcessLimits::formatCpuList(result), formatted);
+	}
+
+	void test_describe()
+	{
+		ProcessLimits limits;
+		QVERIFY(limits.isEmpty());
+		QCOMPARE(limits.describe(), QStringList() << "Process resources: inherited");
+
+		limits.cpus = {0, 1, 4};
+		limits.nice = 10;
+		limits.ioPriority = ProcessLimits::parseIOPriority("idle");
+		limits.memoryLimit = 4096;
+		QVERIFY(!limits.isEmpty());
+		QVERIFY(limits.needsCgroup());
+		QCOMPARE(limits.describe(), QStringList()
+			<< "Process resources:"
+			<< "  CPU affinity: 0-1,4"
+			<< "  Priority: nice 10"
+			<< "  I/O priority: idle"
+			<< "  Memory limit: 4096 MB");
+	}
+};
+
+QTEST_GUILESS_MAIN(ProcessLimitsTest)
+
+#include "ProcessLimits_test.moc"
@@ -1,7 +1,10 @@
 #pragma once
 #include <QString>
-#include <QMap>
+#include <QStringRef>
+#include <QVector>
+#include <QMultiHash>
 #include <QStringList>
+#include <algorithm>
 
 template <char Tseparator>
 class SeparatorPrefixTree
@@ -26,160 +29,135 @@ public:
 	}
 
 	/// insert an exact path into the tree
-	SeparatorPrefixTree & insert(QString path)
+	SeparatorPrefixTree & insert(const QString &path)
 	{
-		auto sepIndex = path.indexOf(Tseparator);
-		if(sepIndex == -1)
-		{
-			children[path] = SeparatorPrefixTree(true);
-			return children[path];
-		}
-		else
+		SeparatorPrefixTree *node = this;
+		int start = 0;
+		while(true)
 		{
-			auto prefix = path.left(sepIndex);
-			if(!children.contains(prefix))
+			auto sepIndex = path.indexOf(Tseparator, start);
+			if(sepIndex == -1)
 			{
-				children[prefix] = SeparatorPrefixTree(false);
+				auto &leaf = node->getOrCreateChild(path.midRef(start));
+				leaf = SeparatorPrefixTree(true);
+				return leaf;
 			}
-			return children[prefix].insert(path.mid(sepIndex + 1));
+			node = &node->getOrCreateChild(path.midRef(start, sepIndex - start));
+			start = sepIndex + 1;
 		}
 	}
 
 	/// is the path fully contained in the tree?
-	bool contains(QString path) const
+	bool contains(const QString &path) const
 	{
 		auto node = find(path);
 		return node != nullptr;
 	}
 
 	/// does the tree cover a path? That means the prefix of the path is contained in the tree
-	bool covers(QString path) const
+	bool covers(const QString &path) const
 	{
-		// if we found some valid node, it's good enough. the tree covers the path
-		if(m_contained)
-		{
-			return true;
-		}
-		auto sepIndex = path.indexOf(Tseparator);
-		if(sepIndex == -1)
+		const SeparatorPrefixTree *node = this;
+		int start = 0;
+		while(true)
 		{
-			auto found = children.find(path);
-			if(found == children.end())
+			// if we found some valid node, it's good enough. the tree covers the path
+			if(node->m_contained)
+			{
+				return true;
+			}
+			auto sepIndex = path.indexOf(Tseparator, start);
+			node = node->child(path.midRef(start, sepIndex == -1 ? -1 : sepIndex - start));
+			if(!node)
 			{
 				return false;
 			}
-			return (*found).covers(QString());
+			if(sepIndex == -1)
+			{
+				break;
+			}
+			start = sepIndex + 1;
 		}
-		else
+		// the whole path matched a node. Nodes named by empty strings below it still count.
+		while(node)
 		{
-			auto prefix = path.left(sepIndex);
-			auto found = children.find(prefix);
-			if(found == children.end())
+			if(node->m_contained)
 			{
-				return false;
+				return true;
 			}
-			return (*found).covers(path.mid(sepIndex + 1));
+			node = node->child(QStringRef());
 		}
+		return false;
 	}
 
 	/// return the contained path that covers the path specified
-	QString cover(QString path) const
+	QString cover(const QString &path) const
 	{
+		const SeparatorPrefixTree *node = this;
 		// if we found some valid node, it's good enough. the tree covers the path
-		if(m_contained)
+		if(node->m_contained)
 		{
 			return QString("");
 		}
-		auto sepIndex = path.indexOf(Tseparator);
-		if(sepIndex == -1)
+		int start = 0;
+		while(true)
 		{
-			auto found = children.find(path);
-			if(found == children.end())
+			auto sepIndex = path.indexOf(Tseparator, start);
+			node = node->child(path.midRef(start, sepIndex == -1 ? -1 : sepIndex - start));
+			if(!node)
 			{
 				return QString();
 			}
-			auto nested = (*found).cover(QString());
-			if(nested.isNull())
+			if(sepIndex == -1)
 			{
-				return nested;
+				break;
 			}
-			if(nested.isEmpty())
-				return path;
-			return path + Tseparator + nested;
-		}
-		else
-		{
-			auto prefix = path.left(sepIndex);
-			auto found = children.find(prefix);
-			if(found == children.end())
+			if(node->m_contained)
 			{
-				return QString();
+				return path.left(sepIndex);
 			}
-			auto nested = (*found).cover(path.mid(sepIndex + 1));
-			if(nested.isNull())
+			start = sepIndex + 1;
+		}
+		// the whole path matched a node. Nodes named by empty strings below it still count.
+		while(node)
+		{
+			if(node->m_contained)
 			{
-				return nested;
+				return path;
 			}
-			if(nested.isEmpty())
-				return prefix;
-			return prefix + Tseparator + nested;
+			node = node->child(QStringRef());
 		}
+		return QString();
 	}
 
 	/// Does the path-specified node exist in the tree? It does not have to be contained.
-	bool exists(QString path) const
+	bool exists(const QString &path) const
 	{
-		auto sepIndex = path.indexOf(Tseparator);
-		if(sepIndex == -1)
-		{
-			auto found = children.find(path);
-			if(found == children.end())
-			{
-				return false;
-			}
-			return true;
-		}
-		else
-		{
-			auto prefix = path.left(sepIndex);
-			auto found = children.find(prefix);
-			if(found == children.end())
-			{
-				return false;
-			}
-			return (*found).exists(path.mid(sepIndex + 1));
-		}
+		return find(path) != nullptr;
 	}
 
 	/// find a node in the tree by name
-	const SeparatorPrefixTree * find(QString path) const
+	const SeparatorPrefixTree * find(const QString &path) const
 	{
-		auto sepIndex = path.indexOf(Tseparator);
-		if(sepIndex == -1)
-		{
-			auto found = children.find(path);
-			if(found == children.end())
-			{
-				return nullptr;
-			}
-			return &(*found);
-		}
-		else
+		const SeparatorPrefixTree *node = this;
+		int start = 0;
+		while(node)
 		{
-			auto prefix = path.left(sepIndex);
-			auto found = children.find(prefix);
-			if(found == children.end())
+			auto sepIndex = path.indexOf(Tseparator, start);
+			if(sepIndex == -1)
 			{
-				return nullptr;
+				return node->child(path.midRef(start));
 			}
-			return (*found).find(path.mid(sepIndex + 1));
+			node = node->child(path.midRef(start, sepIndex - start));
+			start = sepIndex + 1;
 		}
+		return nullptr;
 	}
 
 	/// is this a leaf node?
 	bool leaf() const
 	{
-		return children.isEmpty();
+		return m_children.isEmpty();
 	}
 
 	/// is this node actually contained in the tree, or is it purely structural?
@@ -189,35 +167,46 @@ public:
 	}
 
 	/// Remove a path from the tree
-	bool remove(QString path)
+	bool remove(const QString &path)
 	{
-		return removeInternal(path) != Failed;
+		return removeInternal(path.midRef(0)) != Failed;
 	}
 
 	/// Clear all children of this node tree node
 	void clear()
 	{
-		children.clear();
+		m_names.clear();
+		m_children.clear();
+		m_index.clear();
 	}
 
 	QStringList toStringList() const
 	{
 		QStringList collected;
-		// collecting these is more expensive.
-		auto iter = children.begin();
-		while(iter != children.end())
+		// collecting these is more expensive. Keep the output sorted by name.
+		QVector<int> order(m_children.size());
+		for(int i = 0; i < order.size(); i++)
 		{
-			QStringList list = iter.value().toStringList();
-			for(int i = 0; i < list.size(); i++)
+			order[i] = i;
+		}
+		std::sort(order.begin(), order.end(), [this](int a, int b)
+		{
+			return m_names[a] < m_names[b];
+		});
+		for(auto i: order)
+		{
+			auto &name = m_names[i];
+			auto &child = m_children[i];
+			QStringList list = child.toStringList();
+			for(int j = 0; j < list.size(); j++)
 			{
-				list[i] = iter.key() + Tseparator + list[i];
+				list[j] = name + Tseparator + list[j];
 			}
 			collected.append(list);
-			if((*iter).m_contained)
+			if(child.m_contained)
 			{
-				collected.append(iter.key());
+				collected.append(name);
 			}
-			iter++;
 		}
 		return collected;
 	}
@@ -228,7 +217,7 @@ private:
 		Succeeded,
 		HasChildren
 	};
-	Removal removeInternal(QString path = QString())
+	Removal removeInternal(const QStringRef &path = QStringRef())
 	{
 		if(path.isEmpty())
 		{
@@ -239,34 +228,32 @@ private:
 				return Succeeded;
 			}
 			m_contained = false;
-			if(children.size())
+			if(m_children.size())
 			{
 				return HasChildren;
 			}
 			return Succeeded;
 		}
 		Removal remStatus = Failed;
-		QString childToRemove;
+		int childToRemove = -1;
 		auto sepIndex = path.indexOf(Tseparator);
 		if(sepIndex == -1)
 		{
-			childToRemove = path;
-			auto found = children.find(childToRemove);
-			if(found == children.end())
+			childToRemove = childIndex(path);
+			if(childToRemove == -1)
 			{
 				return Failed;
 			}
-			remStatus = (*found).removeInternal();
+			remStatus = m_children[childToRemove].removeInternal();
 		}
 		else
 		{
-			childToRemove = path.left(sepIndex);
-			auto found = children.find(childToRemove);
-			if(found == children.end())
+			childToRemove = childIndex(path.left(sepIndex));
+			if(childToRemove == -1)
 			{
 				return Failed;
 			}
-			remStatus = (*found).removeInternal(path.mid(sepIndex + 1));
+			remStatus = m_children[childToRemove].removeInternal(path.mid(sepIndex + 1));
 		}
 		switch (remStatus)
 		{
@@ -277,12 +264,12 @@ private:
 			}
 			case Succeeded:
 			{
-				children.remove(childToRemove);
+				removeChild(childToRemove);
 				if(m_contained)
 				{
 					return HasChildren;
 				}
-				if(children.size())
+				if(m_children.size())
 				{
 					return HasChildren;
 				}
@@ -292,7 +279,66 @@ private:
 		return Failed;
 	}
 
+	/// index of the child with the given name, or -1. Doesn't allocate.
+	int childIndex(const QStringRef &name) const
+	{
+		uint hash = qHash(name);
+		auto iter = m_index.constFind(hash);
+		while(iter != m_index.constEnd() && iter.key() == hash)
+		{
+			if(m_names[iter.value()] == name)
+			{
+				return iter.value();
+			}
+			iter++;
+		}
+		return -1;
+	}
+
+	const SeparatorPrefixTree * child(const QStringRef &name) const
+	{
+		auto index = childIndex(name);
+		if(index == -1)
+		{
+			return nullptr;
+		}
+		return &m_children[index];
+	}
+
+	SeparatorPrefixTree & getOrCreateChild(const QStringRef &name)
+	{
+		auto index = childIndex(name);
+		if(index == -1)
+		{
+			index = m_children.size();
+			m_names.append(name.toString());
+			m_children.append(SeparatorPrefixTree(false));
+			m_index.insert(qHash(name), index);
+		}
+		return m_children[index];
+	}
+
+	void removeChild(int index)
+	{
+		int last = m_children.size() - 1;
+		m_index.remove(qHash(m_names[index]), index);
+		if(index != last)
+		{
+			// move the last child into the hole
+			uint lastHash = qHash(m_names[last]);
+			m_index.remove(lastHash, last);
+			m_index.insert(lastHash, index);
+			m_names[index] = m_names[last];
+			m_children[index] = m_children[last];
+		}
+		m_names.removeLast();
+		m_children.removeLast();
+	}
+
 private:
-	QMap<QString,SeparatorPrefixTree<Tseparator>> children;
+	// children are looked up by the hash of their name, so a path can be walked without copying parts of it
+	QVector<QString> m_names;
+	QVector<SeparatorPrefixTree<Tseparator>> m_children;
+	QMultiHash<uint, int> m_index;
 	bool m_contained = false;
 };
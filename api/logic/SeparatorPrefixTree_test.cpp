@@ -0,0 +1,125 @@
+#include <QTest>
+#include "TestUtil.h"
+
+#include "SeparatorPrefixTree.h"
+
+class SeparatorPrefixTreeTest : public QObject
+{
+	Q_OBJECT
+private:
+	// something shaped like an instance folder: a few big folders with lots of files in them
+	QStringList syntheticPaths(int folders, int files)
+	{
+		QStringList paths;
+		for(int i = 0; i < folders; i++)
+		{
+			for(int j = 0; j < files; j++)
+			{
+				paths.append(QString("minecraft/folder%1/sub%2/file%3.dat").arg(i).arg(j % 10).arg(j));
+			}
+		}
+		return paths;
+	}
+
+private
+slots:
+	void test_covers()
+	{
+		SeparatorPrefixTree<'/'> tree({"saves/world", "mods", "options.txt"});
+		QVERIFY(tree.covers("mods"));
+		QVERIFY(tree.covers("mods/foo.jar"));
+		QVERIFY(tree.covers("saves/world/level.dat"));
+		QVERIFY(!tree.covers("saves"));
+		QVERIFY(!tree.covers("saves/otherworld/level.dat"));
+		QVERIFY(!tree.covers("options"));
+		QVERIFY(!tree.covers("modsfoo"));
+		QCOMPARE(tree.cover("saves/world/region/r.0.0.mca"), QString("saves/world"));
+		QCOMPARE(tree.cover("options.txt"), QString("options.txt"));
+		QVERIFY(tree.cover("saves/otherworld").isNull());
+	}
+
+	void test_covers_trailing_separator()
+	{
+		// "config/" is stored as "config" with a child named by an empty string
+		SeparatorPrefixTree<'/'> tree({"config/", "resourcepacks//"});
+		QVERIFY(tree.covers("config"));
+		QVERIFY(tree.covers("config/"));
+		QVERIFY(tree.covers("resourcepacks"));
+		QVERIFY(!tree.covers("conf"));
+		QCOMPARE(tree.cover("config"), QString("config"));
+		QCOMPARE(tree.cover("config/"), QString("config/"));
+		QCOMPARE(tree.cover("resourcepacks"), QString("resourcepacks"));
+		QVERIFY(tree.cover("conf").isNull());
+	}
+
+	void test_contains()
+	{
+		SeparatorPrefixTree<'/'> tree({"saves/world", "mods"});
+		QVERIFY(tree.contains("saves/world"));
+		QVERIFY(tree.exists("saves"));
+		QVERIFY(!tree.exists("saves/world/level.dat"));
+		QVERIFY(tree.find("saves")->leaf() == false);
+		QVERIFY(tree.find("saves")->contained() == false);
+		QVERIFY(tree.find("saves/world")->contained());
+	}
+
+	void test_remove()
+	{
+		SeparatorPrefixTree<'/'> tree({"a/b", "a/c", "d", "e/f/g"});
+		QVERIFY(tree.remove("a/b"));
+		QVERIFY(!tree.remove("a/b"));
+		QVERIFY(tree.covers("a/c"));
+		QVERIFY(!tree.covers("a/b"));
+		QVERIFY(tree.remove("e/f/g"));
+		QVERIFY(!tree.exists("e"));
+		QCOMPARE(tree.toStringList(), QStringList({"a/c", "d"}));
+		// removing a prefix removes everything under it
+		QVERIFY(tree.remove("a"));
+		QCOMPARE(tree.toStringList(), QStringList({"d"}));
+	}
+
+	void test_toStringList()
+	{
+		SeparatorPrefixTree<'/'> tree({"z", "b", "b/y", "a/x"});
+		QCOMPARE(tree.toStringList(), QStringList({"a/x", "b/y", "b", "z"}));
+	}
+
+	void test_covers_benchmark()
+	{
+		SeparatorPrefixTree<'/'> tree;
+		QStringList blocked;
+		for(int i = 0; i < 200; i += 2)
+		{
+			blocked.append(QString("minecraft/folder%1/sub3").arg(i));
+		}
+		tree.insert(blocked);
+		auto paths = syntheticPaths(200, 500);
+		int covered = 0;
+		QBENCHMARK
+		{
+			covered = 0;
+			for(auto &path: paths)
+			{
+				if(tree.covers(path))
+				{
+					covered++;
+				}
+			}
+		}
+		QCOMPARE(covered, 100 * 50);
+	}
+
+	void test_insert_benchmark()
+	{
+		auto paths = syntheticPaths(200, 500);
+		QBENCHMARK
+		{
+			SeparatorPrefixTree<'/'> tree(paths);
+			QVERIFY(tree.contains(paths.last()));
+		}
+	}
+};
+
+QTEST_GUILESS_MAIN(SeparatorPrefixTreeTest)
+
+#include "SeparatorPrefixTree_test.moc"
@@ -0,0 +1,153 @@
+/* Copyright 2013-2017 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ClassDataSharing.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonObject>
+
+#include <FileSystem.h>
+#include <Json.h>
+
+namespace
+{
+const char *archiveSuffix = ".jsa";
+const char *timingsFile = "startup.json";
+}
+
+ClassDataSharing::ClassDataSharing(const QString &folder, const QString &javaPath, JavaVersion javaVersion, const QStringList &classPath)
+	: m_folder(folder)
+{
+	m_supported = javaVersion.supportsDynamicCDS();
+	m_fingerprint = computeFingerprint(javaPath, javaVersion.toString(), classPath);
+}
+
+QString ClassDataSharing::computeFingerprint(const QString &javaPath, const QString &javaVersion, const QStringList &classPath)
+{
+	// the JVM refuses archives that don't match its classpath exactly, including the jar timestamps
+	QCryptographicHash hash(QCryptographicHash::Sha1);
+	hash.addData(javaPath.toUtf8());
+	hash.addData("\n", 1);
+	hash.addData(javaVersion.toUtf8());
+	hash.addData("\n", 1);
+	for(auto &item: classPath)
+	{
+		QFileInfo info(item);
+		hash.addData(item.toUtf8());
+		hash.addData(QString(":%1:%2\n").arg(info.size()).arg(info.lastModified().toMSecsSinceEpoch()).toUtf8());
+	}
+	return hash.result().toHex();
+}
+
+QString ClassDataSharing::archivePath() const
+{
+	return FS::PathCombine(m_folder, m_fingerprint + archiveSuffix);
+}
+
+bool ClassDataSharing::hasArchive() const
+{
+	QFileInfo info(archivePath());
+	return info.isFile() && info.size() > 0;
+}
+
+QStringList ClassDataSharing::arguments() const
+{
+	if(!m_supported)
+	{
+		return {};
+	}
+	if(hasArchive())
+	{
+		return {"-XX:SharedArchiveFile=" + archivePath()};
+	}
+	if(!FS::ensureFolderPathExists(m_folder))
+	{
+		qWarning() << "Couldn't create class data sharing folder" << m_folder;
+		return {};
+	}
+	return {"-XX:ArchiveClassesAtExit=" + archivePath()};
+}
+
+int ClassDataSharing::removeStaleArchives() const
+{
+	QDir folder(m_folder);
+	if(!folder.exists())
+	{
+		return 0;
+	}
+	int removed = 0;
+	auto current = m_fingerprint + archiveSuffix;
+	for(auto &name: folder.entryList({QString("*") + archiveSuffix}, QDir::Files))
+	{
+		if(name == current)
+		{
+			continue;
+		}
+		if(folder.remove(name))
+		{
+			removed++;
+		}
+		else
+		{
+			qWarning() << "Couldn't remove stale class data sharing archive" << folder.absoluteFilePath(name);
+		}
+	}
+	return removed;
+}
+
+QString ClassDataSharing::recordStartupTime(bool withArchive, qint64 msecs) const
+{
+	auto path = FS::PathCombine(m_folder, timingsFile);
+	QJsonObject timings;
+	try
+	{
+		if(QFile::exists(path))
+		{
+			timings = Json::requireObject(Json::requireDocument(path, "Startup timings"), "Startup timings");
+		}
+	}
+	catch(Exception &e)
+	{
+		qWarning() << "Ignoring broken startup timings:" << e.cause();
+	}
+	auto ours = withArchive ? "shared" : "cold";
+	auto theirs = withArchive ? "cold" : "shared";
+	timings.insert(ours, msecs);
+	try
+	{
+		FS::ensureFolderPathExists(m_folder);
+		Json::write(timings, path);
+	}
+	catch(Exception &e)
+	{
+		qWarning() << "Couldn't save startup timings:" << e.cause();
+	}
+
+	auto line = QString("Reached the main menu in %1 ms %2 the class data sharing archive.")
+		.arg(msecs).arg(withArchive ? "with" : "without");
+	if(timings.contains(theirs))
+	{
+		auto other = qint64(timings.value(theirs).toDouble());
+		auto cold = withArchive ? other : msecs;
+		auto shared = withArchive ? msecs : other;
+		line += QString(" Last launch %1 it took %2 ms, the archive saves %3 ms.")
+			.arg(withArchive ? "without" : "with").arg(other).arg(cold - shared);
+	}
+	return line;
+}
@@ -0,0 +1,71 @@
+/* Copyright 2013-2017 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <QString>
+#include <QStringList>
+
+#include "JavaVersion.h"
+
+#include "multimc_logic_export.h"
+
+/**
+ * Per-instance AppCDS (application class data sharing) archives.
+ *
+ * An archive is only valid for the exact JVM and classpath it was dumped with, so archives are named
+ * by a fingerprint of both. If there is no archive for the current fingerprint, the game JVM is asked
+ * to dump one when it exits and the next launch uses it. Archives with other fingerprints are stale.
+ */
+class MULTIMC_LOGIC_EXPORT ClassDataSharing
+{
+public:
+	ClassDataSharing(const QString &folder, const QString &javaPath, JavaVersion javaVersion, const QStringList &classPath);
+
+	/// is the runtime capable of dumping and using the archives?
+	bool isSupported() const
+	{
+		return m_supported;
+	}
+
+	QString fingerprint() const
+	{
+		return m_fingerprint;
+	}
+
+	/// path of the archive that matches the current JVM and classpath
+	QString archivePath() const;
+
+	bool hasArchive() const;
+
+	/// JVM arguments that either use the archive or create it
+	QStringList arguments() const;
+
+	/// remove archives that don't match the current fingerprint. Returns the number of removed archives.
+	int removeStaleArchives() const;
+
+	/**
+	 * Remember how long the game took to reach the main menu, with or without the archive.
+	 * Returns a line for the log that compares it to the last launch of the other kind.
+	 */
+	QString recordStartupTime(bool withArchive, qint64 msecs) const;
+
+	static QString computeFingerprint(const QString &javaPath, const QString &javaVersion, const QStringList &classPath);
+
+private:
+	QString m_folder;
+	QString m_fingerprint;
+	bool m_supported = false;
+};
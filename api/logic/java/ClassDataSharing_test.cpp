@@ -0,0 +1,75 @@
+#include <QTest>
+#include <QTemporaryDir>
+#include "TestUtil.h"
+
+#include "java/ClassDataSharing.h"
+#include <FileSystem.h>
+
+class ClassDataSharingTest : public QObject
+{
+	Q_OBJECT
+private
+slots:
+	void test_Fingerprint()
+	{
+		QTemporaryDir temp;
+		auto jar = FS::PathCombine(temp.path(), "a.jar");
+		FS::write(jar, "first");
+		auto first = ClassDataSharing::computeFingerprint("java", "17.0.1", {jar});
+		QCOMPARE(ClassDataSharing::computeFingerprint("java", "17.0.1", {jar}), first);
+		QVERIFY(ClassDataSharing::computeFingerprint("java", "17.0.2", {jar}) != first);
+		QVERIFY(ClassDataSharing::computeFingerprint("/other/java", "17.0.1", {jar}) != first);
+
+		// a changed jar means a different archive
+		FS::write(jar, "second, longer");
+		QVERIFY(ClassDataSharing::computeFingerprint("java", "17.0.1", {jar}) != first);
+	}
+
+	void test_Arguments()
+	{
+		QTemporaryDir temp;
+		auto folder = FS::PathCombine(temp.path(), "cds");
+
+		ClassDataSharing old(folder, "java", JavaVersion("1.8.0_151"), {});
+		QVERIFY(!old.isSupported());
+		QCOMPARE(old.arguments(), QStringList());
+
+		ClassDataSharing cds(folder, "java", JavaVersion("17.0.1"), {});
+		QVERIFY(cds.isSupported());
+		QVERIFY(!cds.hasArchive());
+		QCOMPARE(cds.arguments(), QStringList() << "-XX:ArchiveClassesAtExit=" + cds.archivePath());
+
+		FS::write(cds.archivePath(), "archive");
+		QVERIFY(cds.hasArchive());
+		QCOMPARE(cds.arguments(), QStringList() << "-XX:SharedArchiveFile=" + cds.archivePath());
+	}
+
+	void test_RemoveStale()
+	{
+		QTemporaryDir temp;
+		auto folder = FS::PathCombine(temp.path(), "cds");
+		ClassDataSharing cds(folder, "java", JavaVersion("17.0.1"), {});
+		QCOMPARE(cds.removeStaleArchives(), 0);
+
+		auto stale = FS::PathCombine(folder, "0123456789abcdef.jsa");
+		FS::write(stale, "stale");
+		FS::write(cds.archivePath(), "archive");
+		QCOMPARE(cds.removeStaleArchives(), 1);
+		QVERIFY(!QFile::exists(stale));
+		QVERIFY(cds.hasArchive());
+	}
+
+	void test_StartupTime()
+	{
+		QTemporaryDir temp;
+		ClassDataSharing cds(temp.path(), "java", JavaVersion("17.0.1"), {});
+		auto first = cds.recordStartupTime(false, 9000);
+		QVERIFY(!first.contains("saves"));
+		auto second = cds.recordStartupTime(true, 6500);
+		QVERIFY(second.contains("saves 2500 ms"));
+	}
+};
+
+QTEST_GUILESS_MAIN(ClassDataSharingTest)
+
+#include "ClassDataSharing_test.moc"
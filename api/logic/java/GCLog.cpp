@@ -0,0 +1,246 @@
+/* Copyright 2013-2017 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "GCLog.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QRegularExpression>
+
+#include <FileSystem.h>
+#include <Json.h>
+
+#include <cmath>
+
+namespace
+{
+const char *logFolder = "gclogs";
+const char *currentLog = "current.log";
+const char *summaryFile = "summary.json";
+const int keptLogs = 10;
+
+double toDouble(QString value)
+{
+	// java 8 formats the numbers using the locale
+	return value.replace(',', '.').toDouble();
+}
+
+qint64 toKiB(const QString &value, const QString &unit)
+{
+	double number = toDouble(value);
+	switch(unit[0].toLatin1())
+	{
+		case 'B':
+			return qint64(number / 1024);
+		case 'M':
+			return qint64(number * 1024);
+		case 'G':
+			return qint64(number * 1024 * 1024);
+		case 'K':
+		default:
+			return qint64(number);
+	}
+}
+}
+
+double GCLogSummary::averagePauseMs() const
+{
+	if(!collections)
+	{
+		return 0;
+	}
+	return totalPauseMs / collections;
+}
+
+double GCLogSummary::allocationRateMiBs() const
+{
+	if(uptime <= 0)
+	{
+		return 0;
+	}
+	return (allocatedKiB / 1024.0) / uptime;
+}
+
+int GCLogSummary::suggestedMaxMemory() const
+{
+	// young collections stay cheap and full ones rare with about three times the live set as heap
+	double liveMiB = peakLiveKiB / 1024.0;
+	int suggestion = int(std::ceil(liveMiB * 3 / 256.0)) * 256;
+	return qMax(suggestion, 512);
+}
+
+QJsonObject GCLogSummary::toJson() const
+{
+	QJsonObject obj;
+	obj.insert("collections", collections);
+	obj.insert("fullCollections", fullCollections);
+	obj.insert("totalPauseMs", totalPauseMs);
+	obj.insert("maxPauseMs", maxPauseMs);
+	obj.insert("uptime", uptime);
+	obj.insert("allocatedKiB", double(allocatedKiB));
+	obj.insert("peakLiveKiB", double(peakLiveKiB));
+	obj.insert("peakHeapKiB", double(peakHeapKiB));
+	return obj;
+}
+
+GCLogSummary GCLogSummary::fromJson(const QJsonObject &obj)
+{
+	GCLogSummary out;
+	out.collections = obj.value("collections").toInt();
+	out.fullCollections = obj.value("fullCollections").toInt();
+	out.totalPauseMs = obj.value("totalPauseMs").toDouble();
+	out.maxPauseMs = obj.value("maxPauseMs").toDouble();
+	out.uptime = obj.value("uptime").toDouble();
+	out.allocatedKiB = qint64(obj.value("allocatedKiB").toDouble());
+	out.peakLiveKiB = qint64(obj.value("peakLiveKiB").toDouble());
+	out.peakHeapKiB = qint64(obj.value("peakHeapKiB").toDouble());
+	return out;
+}
+
+QStringList GCLog::javaArguments(JavaVersion version, const QString &path)
+{
+	if(version.major() >= 9)
+	{
+		// unified logging. Quote the file name, it may contain the ':' separator. Don't rotate, we do that.
+		return {QString("-Xlog:gc:file=\"%1\":uptime:filecount=0").arg(path)};
+	}
+	if(version.major() > 0)
+	{
+		return {"-Xloggc:" + path, "-XX:+PrintGC", "-XX:+PrintGCTimeStamps"};
+	}
+	// the flags of the two formats are fatal errors for the other kind of JVM, don't guess
+	return {};
+}
+
+GCLogSummary GCLog::parse(const QString &log)
+{
+	static const QString size = "(\\d+(?:[.,]\\d+)?)([BKMG])";
+	// 1.234: [GC (Allocation Failure)  33280K->5112K(125952K), 0.0041260 secs]
+	static const QRegularExpression legacy(
+		"(\\d+[.,]\\d+): \\[((?:Full )?GC)[^\\]]*?\\s" + size + "->" + size + "\\(" + size + "\\), (\\d+[.,]\\d+) secs\\]");
+	// [0.123s][info][gc] GC(0) Pause Young (Normal) (G1 Evacuation Pause) 24M->5M(256M) 3.456ms
+	static const QRegularExpression unified(
+		"^\\[(\\d+[.,]\\d+)s\\].*GC\\(\\d+\\) (Pause .*?) " + size + "->" + size + "\\(" + size + "\\) (\\d+[.,]\\d+)ms");
+
+	GCLogSummary out;
+	qint64 lastAfter = 0;
+	for(auto &line: log.split('\n'))
+	{
+		double uptime, pauseMs;
+		QString name;
+		qint64 before, after, heap;
+		auto match = unified.match(line);
+		if(match.hasMatch())
+		{
+			uptime = toDouble(match.captured(1));
+			name = match.captured(2);
+			pauseMs = toDouble(match.captured(9));
+		}
+		else
+		{
+			match = legacy.match(line);
+			if(!match.hasMatch())
+			{
+				continue;
+			}
+			uptime = toDouble(match.captured(1));
+			name = match.captured(2);
+			pauseMs = toDouble(match.captured(9)) * 1000.0;
+		}
+		before = toKiB(match.captured(3), match.captured(4));
+		after = toKiB(match.captured(5), match.captured(6));
+		heap = toKiB(match.captured(7), match.captured(8));
+
+		out.collections++;
+		if(name.contains("Full"))
+		{
+			out.fullCollections++;
+		}
+		out.totalPauseMs += pauseMs;
+		out.maxPauseMs = qMax(out.maxPauseMs, pauseMs);
+		out.uptime = qMax(out.uptime, uptime);
+		if(before > lastAfter)
+		{
+			out.allocatedKiB += before - lastAfter;
+		}
+		lastAfter = after;
+		out.peakLiveKiB = qMax(out.peakLiveKiB, after);
+		out.peakHeapKiB = qMax(out.peakHeapKiB, heap);
+	}
+	return out;
+}
+
+QString GCLog::currentLogPath(const QString &instanceRoot)
+{
+	return FS::PathCombine(QDir(instanceRoot).absolutePath(), logFolder, currentLog);
+}
+
+GCLogSummary GCLog::lastSummary(const QString &instanceRoot)
+{
+	auto path = FS::PathCombine(instanceRoot, logFolder, summaryFile);
+	if(!QFile::exists(path))
+	{
+		return GCLogSummary();
+	}
+	try
+	{
+		return GCLogSummary::fromJson(Json::requireObject(Json::requireDocument(path, "GC log summary"), "GC log summary"));
+	}
+	catch(Exception &e)
+	{
+		qWarning() << "Couldn't read GC log summary:" << e.cause();
+		return GCLogSummary();
+	}
+}
+
+GCLogSummary GCLog::archiveCurrentLog(const QString &instanceRoot)
+{
+	QDir folder(FS::PathCombine(instanceRoot, logFolder));
+	QFileInfo current(folder.absoluteFilePath(currentLog));
+	if(!current.isFile())
+	{
+		return GCLogSummary();
+	}
+	GCLogSummary summary;
+	try
+	{
+		summary = parse(QString::fromUtf8(FS::read(current.absoluteFilePath())));
+		if(summary.isValid())
+		{
+			Json::write(summary.toJson(), folder.absoluteFilePath(summaryFile));
+		}
+	}
+	catch(Exception &e)
+	{
+		qWarning() << "Couldn't analyze GC log:" << e.cause();
+	}
+
+	auto archived = "gc-" + current.lastModified().toString("yyyy-MM-dd_HH-mm-ss") + ".log";
+	folder.remove(archived);
+	if(!folder.rename(currentLog, archived))
+	{
+		qWarning() << "Couldn't keep GC log" << current.absoluteFilePath();
+	}
+
+	// the names sort by time
+	auto logs = folder.entryList({"gc-*.log"}, QDir::Files, QDir::Name);
+	while(logs.size() > keptLogs)
+	{
+		folder.remove(logs.takeFirst());
+	}
+	return summary;
+}
@@ -0,0 +1,78 @@
+/* Copyright 2013-2017 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QJsonObject>
+
+#include "JavaVersion.h"
+
+#include "multimc_logic_export.h"
+
+/**
+ * Summary of one game session's garbage collector log.
+ * Sizes are in KiB, times in milliseconds unless stated otherwise.
+ */
+struct MULTIMC_LOGIC_EXPORT GCLogSummary
+{
+	int collections = 0;
+	int fullCollections = 0;
+	double totalPauseMs = 0;
+	double maxPauseMs = 0;
+	/// JVM uptime at the last collection, in seconds
+	double uptime = 0;
+	/// allocated between collections, summed up
+	qint64 allocatedKiB = 0;
+	/// largest heap occupancy after a collection, the closest thing to the live set we can see
+	qint64 peakLiveKiB = 0;
+	/// largest committed heap size
+	qint64 peakHeapKiB = 0;
+
+	bool isValid() const
+	{
+		return collections > 0;
+	}
+	double averagePauseMs() const;
+	double allocationRateMiBs() const;
+
+	/// maximum heap size in MiB that would fit this session comfortably
+	int suggestedMaxMemory() const;
+
+	QJsonObject toJson() const;
+	static GCLogSummary fromJson(const QJsonObject &obj);
+};
+
+namespace GCLog
+{
+/// JVM arguments that write the GC log to path, in the format the runtime understands
+MULTIMC_LOGIC_EXPORT QStringList javaArguments(JavaVersion version, const QString &path);
+
+/// parse a log written with javaArguments(). Lines it doesn't understand are skipped.
+MULTIMC_LOGIC_EXPORT GCLogSummary parse(const QString &log);
+
+/// where the running session writes its log, relative to the instance folder
+MULTIMC_LOGIC_EXPORT QString currentLogPath(const QString &instanceRoot);
+
+/// summary of the last analyzed session, invalid if there is none
+MULTIMC_LOGIC_EXPORT GCLogSummary lastSummary(const QString &instanceRoot);
+
+/**
+ * Analyze the log of the session that just ended, keep it under a per-session name and remember the summary.
+ * The summary is invalid if there was no log or no collection in it.
+ */
+MULTIMC_LOGIC_EXPORT GCLogSummary archiveCurrentLog(const QString &instanceRoot);
+}
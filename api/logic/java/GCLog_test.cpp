@@ -0,0 +1,95 @@
+#include <QTest>
+#include <QTemporaryDir>
+#include "TestUtil.h"
+
+#include "java/GCLog.h"
+#include <FileSystem.h>
+
+class GCLogTest : public QObject
+{
+	Q_OBJECT
+private
+slots:
+	void test_Parse_data()
+	{
+		QTest::addColumn<QString>("file");
+		QTest::addColumn<int>("collections");
+		QTest::addColumn<int>("fullCollections");
+		QTest::addColumn<double>("totalPauseMs");
+		QTest::addColumn<double>("maxPauseMs");
+		QTest::addColumn<double>("uptime");
+		QTest::addColumn<qint64>("allocatedKiB");
+		QTest::addColumn<qint64>("peakLiveKiB");
+		QTest::addColumn<qint64>("peakHeapKiB");
+		QTest::addColumn<int>("suggestion");
+
+		QTest::newRow("java 8 parallel") << "data/gc-java8-parallel.log" << 5 << 1 << 243.2780 << 96.2317 << 12.441
+			<< qint64(480563) << qint64(140312) << qint64(571392) << 512;
+		// with a decimal comma, as written on a german windows
+		QTest::newRow("java 8 G1") << "data/gc-java8-g1.log" << 4 << 0 << 144.4768 << 110.2031 << 9.388
+			<< qint64(717824) << qint64(293888) << qint64(1048576) << 1024;
+		QTest::newRow("java 11 G1") << "data/gc-java11-g1.log" << 6 << 1 << 550.266 << 412.887 << 15.1
+			<< qint64(939008) << qint64(305152) << qint64(1048576) << 1024;
+	}
+	void test_Parse()
+	{
+		QFETCH(QString, file);
+		QFETCH(int, collections);
+		QFETCH(int, fullCollections);
+		QFETCH(double, totalPauseMs);
+		QFETCH(double, maxPauseMs);
+		QFETCH(double, uptime);
+		QFETCH(qint64, allocatedKiB);
+		QFETCH(qint64, peakLiveKiB);
+		QFETCH(qint64, peakHeapKiB);
+		QFETCH(int, suggestion);
+
+		auto summary = GCLog::parse(MULTIMC_GET_TEST_FILE_UTF8(file));
+		QVERIFY(summary.isValid());
+		QCOMPARE(summary.collections, collections);
+		QCOMPARE(summary.fullCollections, fullCollections);
+		QVERIFY(qAbs(summary.totalPauseMs - totalPauseMs) < 0.001);
+		QVERIFY(qAbs(summary.maxPauseMs - maxPauseMs) < 0.001);
+		QCOMPARE(summary.uptime, uptime);
+		QCOMPARE(summary.allocatedKiB, allocatedKiB);
+		QCOMPARE(summary.peakLiveKiB, peakLiveKiB);
+		QCOMPARE(summary.peakHeapKiB, peakHeapKiB);
+		QCOMPARE(summary.suggestedMaxMemory(), suggestion);
+	}
+
+	void test_Garbage()
+	{
+		QVERIFY(!GCLog::parse("").isValid());
+		QVERIFY(!GCLog::parse("[GC concurrent-mark-start]\n[0.009s] Using G1\n").isValid());
+	}
+
+	void test_Arguments()
+	{
+		QCOMPARE(GCLog::javaArguments(JavaVersion("1.8.0_151"), "/i/gc.log"),
+				 QStringList() << "-Xloggc:/i/gc.log" << "-XX:+PrintGC" << "-XX:+PrintGCTimeStamps");
+		QCOMPARE(GCLog::javaArguments(JavaVersion("11.0.2"), "C:/i/gc.log"),
+				 QStringList() << "-Xlog:gc:file=\"C:/i/gc.log\":uptime:filecount=0");
+		QCOMPARE(GCLog::javaArguments(JavaVersion("garbage"), "/i/gc.log"), QStringList());
+	}
+
+	void test_Archive()
+	{
+		QTemporaryDir temp;
+		QVERIFY(!GCLog::archiveCurrentLog(temp.path()).isValid());
+		QVERIFY(!GCLog::lastSummary(temp.path()).isValid());
+
+		FS::write(GCLog::currentLogPath(temp.path()), MULTIMC_GET_TEST_FILE("data/gc-java11-g1.log"));
+		auto summary = GCLog::archiveCurrentLog(temp.path());
+		QVERIFY(summary.isValid());
+		QVERIFY(!QFile::exists(GCLog::currentLogPath(temp.path())));
+		QCOMPARE(QDir(FS::PathCombine(temp.path(), "gclogs")).entryList({"gc-*.log"}, QDir::Files).size(), 1);
+
+		auto last = GCLog::lastSummary(temp.path());
+		QCOMPARE(last.collections, summary.collections);
+		QCOMPARE(last.peakLiveKiB, summary.peakLiveKiB);
+	}
+};
+
+QTEST_GUILESS_MAIN(GCLogTest)
+
+#include "GCLog_test.moc"
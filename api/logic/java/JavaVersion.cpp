@@ -56,6 +56,16 @@ bool JavaVersion::requiresPermGen()
 	return true;
 }
 
+bool JavaVersion::supportsDynamicCDS()
+{
+	// AppCDS became available in 10, dynamic archiving at exit in 13
+	if(m_parseable)
+	{
+		return m_major >= 13;
+	}
+	return false;
+}
+
 bool JavaVersion::operator<(const JavaVersion &rhs)
 {
 	if(m_parseable && rhs.m_parseable)
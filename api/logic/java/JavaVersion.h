@@ -26,6 +26,9 @@ public:
 
 	bool requiresPermGen();
 
+	/// can this runtime dump a class data sharing archive of the application classes on exit? (-XX:ArchiveClassesAtExit)
+	bool supportsDynamicCDS();
+
 	QString toString();
 
 	int major()
@@ -109,6 +109,23 @@ slots:
 		JavaVersion v(version);
 		QCOMPARE(needs_permgen, v.requiresPermGen());
 	}
+	void test_DynamicCDS_data()
+	{
+		QTest::addColumn<QString>("version");
+		QTest::addColumn<bool>("supported");
+		QTest::newRow("1.8.0_22") << "1.8.0_22" << false;
+		QTest::newRow("11.0.2") << "11.0.2" << false;
+		QTest::newRow("13-ea") << "13-ea" << true;
+		QTest::newRow("17.0.1") << "17.0.1" << true;
+		QTest::newRow("garbage") << "garbage" << false;
+	}
+	void test_DynamicCDS()
+	{
+		QFETCH(QString, version);
+		QFETCH(bool, supported);
+		JavaVersion v(version);
+		QCOMPARE(supported, v.supportsDynamicCDS());
+	}
 };
 
 QTEST_GUILESS_MAIN(JavaVersionTest)
@@ -0,0 +1,59 @@
+/* Copyright 2013-2017 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <QMap>
+#include <QProcessEnvironment>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <memory>
+
+/**
+ * Everything needed to start the game, worked out once per launch.
+ *
+ * The instance makes it when the files it refers to are final, after updates and jar mods.
+ * The launch steps after that only read it, so libraries, arguments and variables are not resolved again.
+ */
+struct LaunchPlan
+{
+	/// jars on the class path, in order
+	QStringList classPath;
+	/// jars with native libraries to extract before launch
+	QStringList nativeJars;
+	/// where the native libraries get extracted to
+	QString nativePath;
+
+	/// arguments for java itself, without the ones added by the launch task
+	QStringList javaArguments;
+	QString mainClass;
+	QString appletClass;
+	/// arguments for the game, with the account details filled in
+	QStringList minecraftArguments;
+	/// arguments for the game without the account details, for showing to the user
+	QStringList publicMinecraftArguments;
+
+	QString windowTitle;
+	/// "max" or "<width>x<height>"
+	QString windowParams;
+	QSet<QString> traits;
+
+	/// variables for command substitution, also exported to the environment
+	QMap<QString, QString> variables;
+	QProcessEnvironment environment;
+};
+
+typedef std::shared_ptr<const LaunchPlan> LaunchPlanPtr;
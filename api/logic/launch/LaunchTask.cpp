@@ -23,6 +23,7 @@
 #include <QDebug>
 #include <QDir>
 #include <QEventLoop>
+#include <QFile>
 #include <QRegularExpression>
 #include <QCoreApplication>
 #include <QStandardPaths>
@@ -109,6 +110,10 @@ void LaunchTask::finalizeSteps(bool successful, const QString& error)
 	{
 		m_steps[step]->finalize();
 	}
+	if(!m_profilerOutput.isEmpty() && QFile::exists(m_profilerOutput))
+	{
+		onLogLine(tr("Profiling data saved to: %1").arg(m_profilerOutput), MessageLevel::MultiMC);
+	}
 	if(successful)
 	{
 		emitSucceeded();
@@ -265,7 +270,8 @@ void LaunchTask::emitFailed(QString reason)
 QString LaunchTask::substituteVariables(const QString &cmd) const
 {
 	QString out = cmd;
-	auto variables = m_instance->getVariables();
+	// once there's a plan, don't work the variables out again
+	auto variables = m_launchPlan ? m_launchPlan->variables : m_instance->getVariables();
 	for (auto it = variables.begin(); it != variables.end(); ++it)
 	{
 		out.replace("$" + it.key(), it.value());
@@ -23,6 +23,7 @@
 #include "MessageLevel.h"
 #include "LoggedProcess.h"
 #include "LaunchStep.h"
+#include "LaunchPlan.h"
 
 #include "multimc_logic_export.h"
 
@@ -67,6 +68,39 @@ public: /* methods */
 		return m_pid;
 	}
 
+	/// JVM arguments added by something other than the instance, like a profiler
+	void setExtraJavaArguments(const QStringList &args)
+	{
+		m_extraJavaArguments = args;
+	}
+
+	QStringList extraJavaArguments() const
+	{
+		return m_extraJavaArguments;
+	}
+
+	/// file the game writes profiling data to, if any
+	void setProfilerOutput(const QString &path)
+	{
+		m_profilerOutput = path;
+	}
+
+	QString profilerOutput() const
+	{
+		return m_profilerOutput;
+	}
+
+	/// what the steps after the updates launch, see LaunchPlan
+	void setLaunchPlan(LaunchPlanPtr plan)
+	{
+		m_launchPlan = plan;
+	}
+
+	LaunchPlanPtr launchPlan() const
+	{
+		return m_launchPlan;
+	}
+
 	/**
 	 * @brief prepare the process for launch (for multi-stage launch)
 	 */
@@ -122,4 +156,7 @@ protected: /* data */
 	int currentStep = -1;
 	State state = NotStarted;
 	qint64 m_pid = -1;
+	QStringList m_extraJavaArguments;
+	QString m_profilerOutput;
+	LaunchPlanPtr m_launchPlan;
 };
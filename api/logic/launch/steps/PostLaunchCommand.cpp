@@ -20,13 +20,14 @@ PostLaunchCommand::PostLaunchCommand(LaunchTask *parent) : LaunchStep(parent)
 {
 	auto instance = m_parent->instance();
 	m_command = instance->getPostExitCommand();
-	m_process.setProcessEnvironment(instance->createEnvironment());
 	connect(&m_process, &LoggedProcess::log, this, &PostLaunchCommand::logLines);
 	connect(&m_process, &LoggedProcess::stateChanged, this, &PostLaunchCommand::on_state);
 }
 
 void PostLaunchCommand::executeTask()
 {
+	auto plan = m_parent->launchPlan();
+	m_process.setProcessEnvironment(plan ? plan->environment : m_parent->instance()->createEnvironment());
 	QString postlaunch_cmd = m_parent->substituteVariables(m_command);
 	emit logLine(tr("Running Post-Launch command: %1").arg(postlaunch_cmd), MessageLevel::MultiMC);
 	m_process.start(postlaunch_cmd);
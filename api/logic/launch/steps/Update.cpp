@@ -23,6 +23,12 @@ void Update::executeTask()
 		emitFailed(tr("Task aborted."));
 		return;
 	}
+	if(m_parent->instance()->isUpToDate())
+	{
+		emit logLine(tr("Nothing changed since the last update, not updating the instance.\n"), MessageLevel::MultiMC);
+		emitSucceeded();
+		return;
+	}
 	m_updateTask.reset(m_parent->instance()->createUpdateTask());
 	if(m_updateTask)
 	{
@@ -118,11 +118,12 @@ void Meta::BaseEntity::load()
 	auto url = this->url();
 	auto entry = ENV.metacache()->resolveEntry("meta", localFilename());
 	entry->setStale(true);
-	auto dl = Net::Download::makeCached(url, entry);
 	/*
 	 * The validator parses the file and loads it into the object.
 	 * If that fails, the file is not written to storage.
+	 * The entity is merged into models the GUI is looking at, so this can't run on the network thread.
 	 */
+	auto dl = Net::Download::makeCached(url, entry, Net::Download::Option::StayOnCallerThread);
 	dl->addValidator(new ParsingValidator(this));
 	job->addNetAction(dl);
 	m_updateStatus = UpdateStatus::InProgress;
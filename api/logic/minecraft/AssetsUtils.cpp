@@ -22,11 +22,13 @@
 #include <QJsonObject>
 #include <QVariant>
 #include <QDebug>
+#include <QtConcurrentRun>
 
 #include "AssetsUtils.h"
 #include "FileSystem.h"
 #include "net/Download.h"
 #include "net/ChecksumValidator.h"
+#include "net/FileSink.h"
 
 
 namespace AssetsUtils
@@ -188,12 +190,39 @@ QDir reconstructAssets(QString assetsId)
 
 }
 
-NetActionPtr AssetObject::getDownloadAction()
+namespace {
+// exists while downloaded objects may not be on the disk intact yet
+const QString unsyncedMarker = "assets/objects/.unsynced";
+
+bool hashMatches(const QString &path, const QString &hash)
+{
+	QFile file(path);
+	if(!file.open(QIODevice::ReadOnly))
+	{
+		return false;
+	}
+	QCryptographicHash sha1(QCryptographicHash::Sha1);
+	sha1.addData(&file);
+	return sha1.result().toHex() == hash.toLatin1();
+}
+}
+
+NetActionPtr AssetObject::getDownloadAction(std::shared_ptr<Net::FileSinkBatch> batch, const QDateTime &unsyncedSince)
 {
 	QFileInfo objectFile(getLocalPath());
-	if ((!objectFile.isFile()) || (objectFile.size() != size))
+	bool suspect = objectFile.isFile() && unsyncedSince.isValid() && objectFile.lastModified() >= unsyncedSince && hash.size();
+	if ((!objectFile.isFile()) || (objectFile.size() != size) || (suspect && !hashMatches(objectFile.filePath(), hash)))
 	{
-		auto objectDL = Net::Download::makeFile(getUrl(), objectFile.filePath());
+		Net::Download::Ptr objectDL;
+		// objects are named by their hash, so they can skip the safe file replacement
+		if(batch && hash.size())
+		{
+			objectDL = Net::Download::makeBatchedFile(getUrl(), objectFile.filePath(), batch);
+		}
+		else
+		{
+			objectDL = Net::Download::makeFile(getUrl(), objectFile.filePath());
+		}
 		if(hash.size())
 		{
 			auto rawHash = QByteArray::fromHex(hash.toLatin1());
@@ -223,15 +252,34 @@ QString AssetObject::getRelPath()
 NetJobPtr AssetsIndex::getDownloadJob()
 {
 	auto job = new NetJob(QObject::tr("Assets for %1").arg(id));
+	auto batch = std::make_shared<Net::FileSinkBatch>(unsyncedMarker);
+	// after a crash, the objects written since the last flush are checked by content
+	auto unsyncedSince = Net::FileSinkBatch::unsyncedSince(unsyncedMarker);
 	for (auto &object : objects.values())
 	{
-		auto dl = object.getDownloadAction();
+		auto dl = object.getDownloadAction(batch, unsyncedSince);
 		if(dl)
 		{
 			job->addNetAction(dl);
 		}
 	}
 	if(job->size())
+	{
+		// whatever got downloaded is fine, even if the job failed. Flushing it can take a while.
+		QObject::connect(job, &NetJob::finished, [batch]()
+		{
+			QtConcurrent::run([batch]()
+			{
+				batch->commit();
+			});
+		});
 		return job;
+	}
+	delete job;
+	// everything is there and checked
+	if(unsyncedSince.isValid())
+	{
+		Net::FileSinkBatch::markSynced(unsyncedMarker);
+	}
 	return nullptr;
 }
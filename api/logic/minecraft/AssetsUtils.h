@@ -16,16 +16,22 @@
 #pragma once
 
 #include <QString>
+#include <QDateTime>
 #include <QMap>
 #include "net/NetAction.h"
 #include "net/NetJob.h"
 
+namespace Net {
+class FileSinkBatch;
+}
+
 struct AssetObject
 {
 	QString getRelPath();
 	QUrl getUrl();
 	QString getLocalPath();
-	NetActionPtr getDownloadAction();
+	/// files changed since unsyncedSince are checked by content, not just by size. See Net::FileSinkBatch.
+	NetActionPtr getDownloadAction(std::shared_ptr<Net::FileSinkBatch> batch = nullptr, const QDateTime &unsyncedSince = QDateTime());
 
 	QString hash;
 	qint64 size;
@@ -0,0 +1,302 @@
+/* Copyright 2013-2017 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "CacheGCTask.h"
+#include "InstanceList.h"
+#include "Env.h"
+#include "minecraft/MinecraftInstance.h"
+#include "minecraft/ComponentList.h"
+#include "minecraft/AssetsUtils.h"
+#include "minecraft/VersionFilterData.h"
+#include "minecraft/legacy/LegacyInstance.h"
+#include "net/HttpMetaCache.h"
+#include <FileSystem.h>
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QtConcurrentRun>
+#include <QDebug>
+
+namespace {
+// the metacache bases the collector looks at
+const QStringList allAreas = {"libraries", "asset_objects", "asset_indexes", "fmllibs", "versions"};
+
+QString absolute(const QString &path)
+{
+	return QFileInfo(path).absoluteFilePath();
+}
+}
+
+CacheGCTask::CacheGCTask(std::shared_ptr<InstanceList> instances, bool remove, QObject *parent)
+	: Task(parent), m_instances(instances), m_remove(remove)
+{
+	connect(&m_watcher, &QFutureWatcher<Result>::finished, this, &CacheGCTask::sweepFinished);
+}
+
+void CacheGCTask::skipArea(const QString &base, const QString &reason)
+{
+	if(!m_skipped.contains(base))
+	{
+		qWarning() << "Not collecting" << base << ":" << reason;
+		m_skipped.append(base);
+	}
+}
+
+void CacheGCTask::executeTask()
+{
+	setStatus(tr("Finding the files used by instances..."));
+	m_needs.clear();
+	m_pending.clear();
+	for(int i = 0; i < m_instances->count(); i++)
+	{
+		m_pending.append(m_instances->at(i));
+	}
+	collectNext();
+}
+
+// one instance at a time, so loading their components doesn't freeze the GUI
+void CacheGCTask::collectNext()
+{
+	if(!m_pending.isEmpty())
+	{
+		m_needs.append(needsOf(m_pending.takeFirst()));
+		setProgress(m_needs.size(), m_needs.size() + m_pending.size());
+		QMetaObject::invokeMethod(this, "collectNext", Qt::QueuedConnection);
+		return;
+	}
+
+	auto reachable = reachability(m_needs);
+	for(auto &skipped: reachable.skipped)
+	{
+		skipArea(skipped.first, skipped.second);
+	}
+
+	QList<Area> areas;
+	auto metacache = ENV.metacache();
+	for(auto &base: allAreas)
+	{
+		if(!m_skipped.contains(base))
+		{
+			areas.append({base, metacache->getBasePath(base)});
+		}
+	}
+
+	setStatus(m_remove ? tr("Removing unused files...") : tr("Looking for unused files..."));
+	m_watcher.setFuture(QtConcurrent::run(&CacheGCTask::sweep, areas, reachable.files, reachable.dirs, m_remove));
+}
+
+CacheGCTask::Needs CacheGCTask::needsOf(InstancePtr instance)
+{
+	Needs needs;
+	needs.instanceId = instance->id();
+	if(auto legacy = std::dynamic_pointer_cast<LegacyInstance>(instance))
+	{
+		needs.versionId = legacy->intendedVersionId();
+		if(needs.versionId.isEmpty())
+		{
+			needs.unknownReason = tr("instance %1 has no version").arg(instance->id());
+		}
+		return needs;
+	}
+	auto minecraft = std::dynamic_pointer_cast<MinecraftInstance>(instance);
+	if(!minecraft)
+	{
+		// we have no idea what this uses
+		needs.unknownReason = tr("unknown instance type of %1").arg(instance->id());
+		return needs;
+	}
+
+	// the components are read into a list of our own. The instance's may be open in an editor, and stays unloaded if it was.
+	ComponentList profile(minecraft.get());
+	try
+	{
+		profile.reload();
+	}
+	catch (...)
+	{
+		needs.unknownReason = tr("instance %1 can't be loaded").arg(instance->id());
+		return needs;
+	}
+	if(profile.getProblemSeverity() == ProblemSeverity::Error)
+	{
+		needs.unknownReason = tr("instance %1 can't be loaded").arg(instance->id());
+		return needs;
+	}
+
+	needs.libraries.append(profile.getLibraries());
+	needs.libraries.append(profile.getNativeLibraries());
+	needs.libraries.append(profile.getJarMods());
+	if(auto mainJar = profile.getMainJar())
+	{
+		needs.libraries.append(mainJar);
+	}
+	needs.localLibraryPath = minecraft->getLocalLibraryPath();
+	if(auto assets = profile.getMinecraftAssets())
+	{
+		needs.assetsId = assets->id;
+	}
+	if(profile.hasTrait("legacyFML"))
+	{
+		for(auto &lib: g_VersionFilterData.fmlLibsMapping.value(minecraft->getComponentVersion("net.minecraft")))
+		{
+			needs.fmlLibs.append(lib.filename);
+		}
+	}
+	return needs;
+}
+
+CacheGCTask::Reachability CacheGCTask::reachability(const QList<Needs> &needs)
+{
+	Reachability out;
+	auto skip = [&](const QString &base, const QString &reason)
+	{
+		out.skipped.append(qMakePair(base, reason));
+	};
+	// libraries, for all systems - the folder may be shared by different machines
+	const QList<OpSys> systems = {Os_Windows, Os_Linux, Os_OSX};
+	for(auto &instance: needs)
+	{
+		if(!instance.unknownReason.isEmpty())
+		{
+			// it could need anything
+			for(auto &base: allAreas)
+			{
+				skip(base, instance.unknownReason);
+			}
+			continue;
+		}
+		if(!instance.versionId.isEmpty())
+		{
+			out.dirs.append(absolute("versions/" + instance.versionId));
+		}
+		for(auto &library: instance.libraries)
+		{
+			for(auto system: systems)
+			{
+				QStringList jar, native, native32, native64;
+				library->getApplicableFiles(system, jar, native, native32, native64, instance.localLibraryPath);
+				for(auto &file: jar + native + native32 + native64)
+				{
+					out.files.insert(absolute(file));
+				}
+			}
+		}
+		if(!instance.assetsId.isEmpty())
+		{
+			QString indexPath = "assets/indexes/" + instance.assetsId + ".json";
+			out.files.insert(absolute(indexPath));
+			AssetsIndex index;
+			if(AssetsUtils::loadAssetsIndexJson(instance.assetsId, indexPath, &index))
+			{
+				for(auto &object: index.objects)
+				{
+					out.files.insert(absolute(object.getLocalPath()));
+				}
+			}
+			else
+			{
+				skip("asset_objects", tr("the asset index %1 can't be read").arg(instance.assetsId));
+			}
+		}
+		// legacy FML libraries
+		for(auto &lib: instance.fmlLibs)
+		{
+			out.files.insert(absolute("mods/minecraftforge/libs/" + lib));
+		}
+	}
+	return out;
+}
+
+CacheGCTask::Result CacheGCTask::sweep(const QList<Area> &areas, const QSet<QString> &reachable, const QStringList &reachableDirs, bool remove)
+{
+	Result result;
+	auto isReachable = [&](const QString &path)
+	{
+		if(reachable.contains(path))
+		{
+			return true;
+		}
+		for(auto &dir: reachableDirs)
+		{
+			if(path.startsWith(dir + '/'))
+			{
+				return true;
+			}
+		}
+		return false;
+	};
+	for(auto &area: areas)
+	{
+		if(area.path.isEmpty() || !QDir(area.path).exists())
+		{
+			continue;
+		}
+		QDir root(area.path);
+		QStringList touchedDirs;
+		QDirIterator iter(root.absolutePath(), QDir::Files | QDir::Hidden | QDir::NoSymLinks, QDirIterator::Subdirectories);
+		while(iter.hasNext())
+		{
+			QString path = iter.next();
+			if(isReachable(path))
+			{
+				continue;
+			}
+			qint64 size = iter.fileInfo().size();
+			if(remove)
+			{
+				if(!QFile::remove(path))
+				{
+					result.errors.append(path);
+					continue;
+				}
+				touchedDirs.append(iter.fileInfo().absolutePath());
+			}
+			result.bytes += size;
+			result.files++;
+			result.unreachable.append(qMakePair(area.base, root.relativeFilePath(path)));
+		}
+		// remove the folders that are now empty, deepest first
+		touchedDirs.removeDuplicates();
+		std::sort(touchedDirs.begin(), touchedDirs.end(), [](const QString &a, const QString &b)
+		{
+			return a.size() > b.size();
+		});
+		for(auto dir: touchedDirs)
+		{
+			while(dir.startsWith(root.absolutePath() + '/') && QDir().rmdir(dir))
+			{
+				dir = QFileInfo(dir).absolutePath();
+			}
+		}
+	}
+	return result;
+}
+
+void CacheGCTask::sweepFinished()
+{
+	m_result = m_watcher.result();
+	if(m_remove && !m_result.unreachable.isEmpty())
+	{
+		ENV.metacache()->evictEntries(m_result.unreachable);
+	}
+	qDebug() << (m_remove ? "Removed" : "Found") << m_result.files << "unused files," << m_result.bytes << "bytes";
+	if(!m_result.errors.isEmpty())
+	{
+		emitFailed(tr("Could not remove %1 files:\n%2").arg(m_result.errors.size()).arg(m_result.errors.join("\n")));
+		return;
+	}
+	emitSucceeded();
+}
@@ -0,0 +1,121 @@
+/* Copyright 2013-2017 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tasks/Task.h"
+#include "BaseInstance.h"
+#include "minecraft/Library.h"
+#include <QFutureWatcher>
+#include <QSet>
+#include <QStringList>
+#include <memory>
+
+#include "multimc_logic_export.h"
+
+class InstanceList;
+
+/**
+ * Finds the files in the shared libraries/assets/versions folders that no instance uses anymore,
+ * and optionally deletes them along with their metacache entries.
+ *
+ * If the files used by an instance can't be determined, the affected folders are left alone.
+ */
+class MULTIMC_LOGIC_EXPORT CacheGCTask : public Task
+{
+	Q_OBJECT
+public:
+	/// a folder to collect, and the metacache base that holds its entries
+	struct Area
+	{
+		QString base;
+		QString path;
+	};
+	/// what one instance needs from the shared folders
+	struct Needs
+	{
+		QString instanceId;
+		/// why the needs can't be determined. Empty if they can.
+		QString unknownReason;
+		QList<LibraryPtr> libraries;
+		QString localLibraryPath;
+		QString assetsId;
+		QStringList fmlLibs;
+		/// a version folder that is kept whole, for legacy instances
+		QString versionId;
+	};
+	struct Reachability
+	{
+		/// absolute file paths
+		QSet<QString> files;
+		/// absolute folders that are kept whole
+		QStringList dirs;
+		/// metacache base and reason for the areas that can't be collected
+		QList<QPair<QString, QString>> skipped;
+	};
+	struct Result
+	{
+		qint64 bytes = 0;
+		int files = 0;
+		/// metacache base and path relative to it for every unreachable file
+		QList<QPair<QString, QString>> unreachable;
+		QStringList errors;
+	};
+
+	explicit CacheGCTask(std::shared_ptr<InstanceList> instances, bool remove, QObject *parent = 0);
+
+	const Result &result() const
+	{
+		return m_result;
+	}
+	QStringList skippedAreas() const
+	{
+		return m_skipped;
+	}
+
+	/**
+	 * Turns what the instances need into the files that have to stay.
+	 * Paths are relative to the working directory, like everywhere else. Reads asset indexes from disk.
+	 */
+	static Reachability reachability(const QList<Needs> &needs);
+
+	/**
+	 * Walks the areas and counts everything that isn't reachable.
+	 * `reachable` holds absolute file paths, `reachableDirs` absolute folders that are kept whole.
+	 * Safe to call from any thread.
+	 */
+	static Result sweep(const QList<Area> &areas, const QSet<QString> &reachable, const QStringList &reachableDirs, bool remove);
+
+protected:
+	void executeTask() override;
+
+private slots:
+	void collectNext();
+	void sweepFinished();
+
+private:
+	Needs needsOf(InstancePtr instance);
+	void skipArea(const QString &base, const QString &reason);
+
+private:
+	std::shared_ptr<InstanceList> m_instances;
+	bool m_remove = false;
+	/// instances still to look at, and what the ones looked at need
+	QList<InstancePtr> m_pending;
+	QList<Needs> m_needs;
+	QStringList m_skipped;
+	Result m_result;
+	QFutureWatcher<Result> m_watcher;
+};
@@ -0,0 +1,112 @@
+#include <QTest>
+#include <QTemporaryDir>
+#include "TestUtil.h"
+
+#include "minecraft/CacheGCTask.h"
+#include "FileSystem.h"
+
+class CacheGCTaskTest : public QObject
+{
+	Q_OBJECT
+private:
+	QString makeFile(const QString &root, const QString &path, int size)
+	{
+		auto fullPath = FS::PathCombine(root, path);
+		FS::ensureFilePathExists(fullPath);
+		FS::write(fullPath, QByteArray(size, 'x'));
+		return QFileInfo(fullPath).absoluteFilePath();
+	}
+
+private
+slots:
+	void test_sweep()
+	{
+		QTemporaryDir tempDir;
+		QString libraries = FS::PathCombine(tempDir.path(), "libraries");
+		QString versions = FS::PathCombine(tempDir.path(), "versions");
+		auto used = makeFile(libraries, "org/used/used.jar", 10);
+		auto unused = makeFile(libraries, "org/unused/unused.jar", 20);
+		makeFile(libraries, "org/unused/unused-natives.jar", 30);
+		makeFile(versions, "1.5.2/1.5.2.jar", 40);
+		makeFile(versions, "1.4.7/1.4.7.jar", 50);
+
+		QList<CacheGCTask::Area> areas = {{"libraries", libraries}, {"versions", versions}};
+		QSet<QString> reachable = {used};
+		QStringList reachableDirs = {QFileInfo(FS::PathCombine(versions, "1.5.2")).absoluteFilePath()};
+
+		// just looking doesn't delete anything
+		auto report = CacheGCTask::sweep(areas, reachable, reachableDirs, false);
+		QCOMPARE(report.files, 3);
+		QCOMPARE(report.bytes, qint64(20 + 30 + 50));
+		QVERIFY(QFile::exists(unused));
+		QVERIFY(report.unreachable.contains(qMakePair(QString("libraries"), QString("org/unused/unused.jar"))));
+
+		auto result = CacheGCTask::sweep(areas, reachable, reachableDirs, true);
+		QCOMPARE(result.files, 3);
+		QCOMPARE(result.bytes, qint64(20 + 30 + 50));
+		QVERIFY(result.errors.isEmpty());
+		QVERIFY(QFile::exists(used));
+		QVERIFY(!QFile::exists(unused));
+		QVERIFY(QFile::exists(FS::PathCombine(versions, "1.5.2/1.5.2.jar")));
+		// empty folders go away too, the area itself stays
+		QVERIFY(!QDir(FS::PathCombine(libraries, "org/unused")).exists());
+		QVERIFY(!QDir(FS::PathCombine(versions, "1.4.7")).exists());
+		QVERIFY(QDir(versions).exists());
+
+		// nothing left
+		QCOMPARE(CacheGCTask::sweep(areas, reachable, reachableDirs, true).files, 0);
+	}
+
+	void test_reachability()
+	{
+		QTemporaryDir tempDir;
+		auto oldCurrent = QDir::currentPath();
+		QDir::setCurrent(tempDir.path());
+		FS::ensureFilePathExists("assets/indexes/1.12.json");
+		FS::write("assets/indexes/1.12.json", R"({"objects": {"sound.ogg": {"hash": "0123456789abcdef0123456789abcdef01234567", "size": 5}}})");
+
+		CacheGCTask::Needs modern;
+		modern.instanceId = "modern";
+		modern.libraries.append(std::make_shared<Library>("org.used:used:1.0"));
+		modern.assetsId = "1.12";
+		modern.fmlLibs.append("scala-library.jar");
+		CacheGCTask::Needs legacy;
+		legacy.instanceId = "legacy";
+		legacy.versionId = "1.5.2";
+
+		auto known = CacheGCTask::reachability({modern, legacy});
+		QVERIFY(known.skipped.isEmpty());
+		QVERIFY(known.files.contains(QFileInfo("libraries/org/used/used/1.0/used-1.0.jar").absoluteFilePath()));
+		QVERIFY(known.files.contains(QFileInfo("assets/indexes/1.12.json").absoluteFilePath()));
+		QVERIFY(known.files.contains(QFileInfo("assets/objects/01/0123456789abcdef0123456789abcdef01234567").absoluteFilePath()));
+		QVERIFY(known.files.contains(QFileInfo("mods/minecraftforge/libs/scala-library.jar").absoluteFilePath()));
+		QCOMPARE(known.dirs, QStringList() << QFileInfo("versions/1.5.2").absoluteFilePath());
+
+		// an index that can't be read keeps all the asset objects
+		modern.assetsId = "missing";
+		auto noIndex = CacheGCTask::reachability({modern});
+		QCOMPARE(noIndex.skipped.size(), 1);
+		QCOMPARE(noIndex.skipped[0].first, QString("asset_objects"));
+
+		// an instance that could need anything keeps every area, versions included
+		CacheGCTask::Needs unknown;
+		unknown.instanceId = "unknown";
+		unknown.unknownReason = "unknown";
+		QStringList skipped;
+		for(auto &area: CacheGCTask::reachability({modern, unknown}).skipped)
+		{
+			skipped.append(area.first);
+		}
+		QVERIFY(skipped.contains("libraries"));
+		QVERIFY(skipped.contains("asset_objects"));
+		QVERIFY(skipped.contains("asset_indexes"));
+		QVERIFY(skipped.contains("fmllibs"));
+		QVERIFY(skipped.contains("versions"));
+
+		QDir::setCurrent(oldCurrent);
+	}
+};
+
+QTEST_GUILESS_MAIN(CacheGCTaskTest)
+
+#include "CacheGCTask_test.moc"
@@ -22,6 +22,7 @@
 #include <QDebug>
 
 #include "minecraft/ComponentList.h"
+#include "LoggingCategories.h"
 #include "Exception.h"
 #include <minecraft/OneSixVersionFormat.h>
 #include <FileSystem.h>
@@ -368,7 +369,7 @@ bool ComponentList::reapplyPatches()
 		clear();
 		for(auto file: m_patches)
 		{
-			qDebug() << "Applying" << file->getID() << (file->getProblemSeverity() == ProblemSeverity::Error ? "ERROR" : "GOOD");
+			qCDebug(logComponents) << "Applying" << file->getID() << (file->getProblemSeverity() == ProblemSeverity::Error ? "ERROR" : "GOOD");
 			file->applyTo(this);
 		}
 	}
@@ -776,7 +777,7 @@ void ComponentList::loadUserPatches_internal()
 	for (auto info : patchesDir.entryInfoList(QStringList() << "*.json", QDir::Files))
 	{
 		// parse the file
-		qDebug() << "Reading" << info.fileName();
+		qCDebug(logComponents) << "Reading" << info.fileName();
 		auto file = ProfileUtils::parseJsonFile(info, true);
 		// ignore builtins
 		if (file->uid == "net.minecraft")
@@ -1,5 +1,7 @@
 #include "MinecraftInstance.h"
 #include <minecraft/launch/CreateServerResourcePacksFolder.h>
+#include <minecraft/launch/PrewarmClasspath.h>
+#include <minecraft/launch/AnalyzeGCLog.h>
 #include <minecraft/launch/ExtractNatives.h>
 #include <minecraft/launch/PrintInstanceInfo.h>
 #include <settings/Setting.h>
@@ -10,6 +12,7 @@
 #include <pathmatcher/MultiMatcher.h>
 #include <FileSystem.h>
 #include <java/JavaVersion.h>
+#include <java/GCLog.h>
 
 #include "launch/LaunchTask.h"
 #include "launch/steps/PostLaunchCommand.h"
@@ -20,6 +23,7 @@
 #include "minecraft/launch/DirectJavaLaunch.h"
 #include "minecraft/launch/ModMinecraftJar.h"
 #include "minecraft/launch/ClaimAccount.h"
+#include "minecraft/launch/CreateLaunchPlan.h"
 #include "java/launch/CheckJava.h"
 #include "java/JavaUtils.h"
 #include "meta/Index.h"
@@ -31,6 +35,7 @@
 #include "icons/IIconList.h"
 
 #include <QCoreApplication>
+#include <QCryptographicHash>
 #include "ComponentList.h"
 #include "AssetsUtils.h"
 #include "MinecraftUpdate.h"
@@ -80,6 +85,8 @@ MinecraftInstance::MinecraftInstance(SettingsObjectPtr globalSettings, SettingsO
 
 	m_settings->registerOverride(globalSettings->getSetting("JavaPath"), javaOrLocation);
 	m_settings->registerOverride(globalSettings->getSetting("JvmArgs"), javaOrArgs);
+	m_settings->registerOverride(globalSettings->getSetting("UseClassDataSharing"), javaOrArgs);
+	m_settings->registerOverride(globalSettings->getSetting("EnableGCLogging"), javaOrArgs);
 
 	// special!
 	m_settings->registerPassthrough(globalSettings->getSetting("JavaTimestamp"), javaOrLocation);
@@ -101,6 +108,13 @@ MinecraftInstance::MinecraftInstance(SettingsObjectPtr globalSettings, SettingsO
 	// Minecraft launch method
 	auto launchMethodOverride = m_settings->registerSetting("OverrideMCLaunchMethod", false);
 	m_settings->registerOverride(globalSettings->getSetting("MCLaunchMethod"), launchMethodOverride);
+
+	// Process resources. These only make sense per instance.
+	m_settings->registerSetting("CPUAffinity", "");
+	m_settings->registerSetting("ProcessPriority", 0);
+	m_settings->registerSetting("IOPriority", "");
+	m_settings->registerSetting("MemoryLimit", 0);
+	m_settings->registerSetting("CPULimit", 0);
 }
 
 void MinecraftInstance::init()
@@ -138,6 +152,7 @@ void MinecraftInstance::createProfile()
 
 void MinecraftInstance::reloadProfile()
 {
+	touchModels();
 	m_profile->reload();
 	setVersionBroken(m_profile->getProblemSeverity() == ProblemSeverity::Error);
 	emit versionReloaded();
@@ -235,6 +250,12 @@ QString MinecraftInstance::worldDir() const
 	return FS::PathCombine(minecraftRoot(), "saves");
 }
 
+QString MinecraftInstance::worldBackupDir() const
+{
+	// outside of the game folder, the game has no business there
+	return FS::PathCombine(instanceRoot(), "world-backups");
+}
+
 QDir MinecraftInstance::librariesPath() const
 {
 	return QDir::current().absoluteFilePath("libraries");
@@ -250,11 +271,16 @@ QDir MinecraftInstance::versionsPath() const
 	return QDir::current().absoluteFilePath("versions");
 }
 
-QStringList MinecraftInstance::getClassPath() const
+void MinecraftInstance::getLibraryFiles(QStringList &jars, QStringList &nativeJars) const
 {
-	QStringList jars, nativeJars;
 	auto javaArchitecture = settings()->get("JavaArchitecture").toString();
 	m_profile->getLibraryFiles(javaArchitecture, jars, nativeJars, getLocalLibraryPath(), binRoot());
+}
+
+QStringList MinecraftInstance::getClassPath() const
+{
+	QStringList jars, nativeJars;
+	getLibraryFiles(jars, nativeJars);
 	return jars;
 }
 
@@ -266,8 +292,7 @@ QString MinecraftInstance::getMainClass() const
 QStringList MinecraftInstance::getNativeJars() const
 {
 	QStringList jars, nativeJars;
-	auto javaArchitecture = settings()->get("JavaArchitecture").toString();
-	m_profile->getLibraryFiles(javaArchitecture, jars, nativeJars, getLocalLibraryPath(), binRoot());
+	getLibraryFiles(jars, nativeJars);
 	return nativeJars;
 }
 
@@ -338,12 +363,22 @@ QStringList MinecraftInstance::javaArguments() const
 		}
 	}
 
+	if(settings()->get("EnableGCLogging").toBool())
+	{
+		args << GCLog::javaArguments(javaVersion, GCLog::currentLogPath(instanceRoot()));
+	}
+
 	args << "-Duser.language=en";
 
 	return args;
 }
 
 QMap<QString, QString> MinecraftInstance::getVariables() const
+{
+	return getVariables(javaArguments());
+}
+
+QMap<QString, QString> MinecraftInstance::getVariables(const QStringList &javaArgs) const
 {
 	QMap<QString, QString> out;
 	out.insert("INST_NAME", name());
@@ -351,7 +386,7 @@ QMap<QString, QString> MinecraftInstance::getVariables() const
 	out.insert("INST_DIR", QDir(instanceRoot()).absolutePath());
 	out.insert("INST_MC_DIR", QDir(minecraftRoot()).absolutePath());
 	out.insert("INST_JAVA", settings()->get("JavaPath").toString());
-	out.insert("INST_JAVA_ARGS", javaArguments().join(' '));
+	out.insert("INST_JAVA_ARGS", javaArgs.join(' '));
 	return out;
 }
 
@@ -394,6 +429,14 @@ static QString replaceTokensIn(QString text, QMap<QString, QString> with)
 }
 
 QStringList MinecraftInstance::processMinecraftArgs(AuthSessionPtr session) const
+{
+	auto assets = m_profile->getMinecraftAssets();
+	// FIXME: this is wrong and should be run as an async task
+	auto gameAssets = AssetsUtils::reconstructAssets(assets->id).absolutePath();
+	return processMinecraftArgs(session, gameAssets);
+}
+
+QStringList MinecraftInstance::processMinecraftArgs(AuthSessionPtr session, const QString &gameAssets) const
 {
 	QString args_pattern = m_profile->getMinecraftArguments();
 	for (auto tweaker : m_profile->getTweakers())
@@ -429,8 +472,7 @@ QStringList MinecraftInstance::processMinecraftArgs(AuthSessionPtr session) cons
 	token_mapping["game_directory"] = absRootDir;
 	QString absAssetsDir = QDir("assets/").absolutePath();
 	auto assets = m_profile->getMinecraftAssets();
-	// FIXME: this is wrong and should be run as an async task
-	token_mapping["game_assets"] = AssetsUtils::reconstructAssets(assets->id).absolutePath();
+	token_mapping["game_assets"] = gameAssets;
 
 	// 1.7.3+ assets tokens
 	token_mapping["assets_root"] = absAssetsDir;
@@ -444,42 +486,71 @@ QStringList MinecraftInstance::processMinecraftArgs(AuthSessionPtr session) cons
 	return parts;
 }
 
-QString MinecraftInstance::createLaunchScript(AuthSessionPtr session)
+QString MinecraftInstance::windowParams() const
 {
-	QString launchScript;
+	if (settings()->get("LaunchMaximized").toBool())
+	{
+		return "max";
+	}
+	return QString("%1x%2")
+		.arg(settings()->get("MinecraftWinWidth").toInt())
+		.arg(settings()->get("MinecraftWinHeight").toInt());
+}
 
+LaunchPlanPtr MinecraftInstance::createLaunchPlan(AuthSessionPtr session) const
+{
 	if (!m_profile)
 		return nullptr;
 
-	auto mainClass = getMainClass();
-	if (!mainClass.isEmpty())
+	auto plan = std::make_shared<LaunchPlan>();
+	getLibraryFiles(plan->classPath, plan->nativeJars);
+	plan->nativePath = getNativePath();
+
+	plan->javaArguments = javaArguments();
+	plan->mainClass = getMainClass();
+	plan->appletClass = m_profile->getAppletClass();
+
+	auto assets = m_profile->getMinecraftAssets();
+	// FIXME: this is wrong and should be run as an async task
+	auto gameAssets = AssetsUtils::reconstructAssets(assets->id).absolutePath();
+	plan->minecraftArguments = processMinecraftArgs(session, gameAssets);
+	plan->publicMinecraftArguments = processMinecraftArgs(nullptr, gameAssets);
+
+	plan->windowTitle = windowTitle();
+	plan->windowParams = windowParams();
+	plan->traits = m_profile->getTraits();
+
+	plan->variables = getVariables(plan->javaArguments);
+	plan->environment = CleanEnviroment();
+	for (auto it = plan->variables.begin(); it != plan->variables.end(); ++it)
 	{
-		launchScript += "mainClass " + mainClass + "\n";
+		plan->environment.insert(it.key(), it.value());
 	}
-	auto appletClass = m_profile->getAppletClass();
-	if (!appletClass.isEmpty())
+	return plan;
+}
+
+QString MinecraftInstance::createLaunchScript(const LaunchPlan &plan, AuthSessionPtr session) const
+{
+	QString launchScript;
+
+	if (!plan.mainClass.isEmpty())
+	{
+		launchScript += "mainClass " + plan.mainClass + "\n";
+	}
+	if (!plan.appletClass.isEmpty())
 	{
-		launchScript += "appletClass " + appletClass + "\n";
+		launchScript += "appletClass " + plan.appletClass + "\n";
 	}
 
 	// generic minecraft params
-	for (auto param : processMinecraftArgs(session))
+	for (auto param : plan.minecraftArguments)
 	{
 		launchScript += "param " + param + "\n";
 	}
 
 	// window size, title and state, legacy
-	{
-		QString windowParams;
-		if (settings()->get("LaunchMaximized").toBool())
-			windowParams = "max";
-		else
-			windowParams = QString("%1x%2")
-							   .arg(settings()->get("MinecraftWinWidth").toInt())
-							   .arg(settings()->get("MinecraftWinHeight").toInt());
-		launchScript += "windowTitle " + windowTitle() + "\n";
-		launchScript += "windowParams " + windowParams + "\n";
-	}
+	launchScript += "windowTitle " + plan.windowTitle + "\n";
+	launchScript += "windowParams " + plan.windowParams + "\n";
 
 	// legacy auth
 	if(session)
@@ -489,22 +560,17 @@ QString MinecraftInstance::createLaunchScript(AuthSessionPtr session)
 	}
 
 	// libraries and class path.
+	for(auto file: plan.classPath)
 	{
-		QStringList jars, nativeJars;
-		auto javaArchitecture = settings()->get("JavaArchitecture").toString();
-		m_profile->getLibraryFiles(javaArchitecture, jars, nativeJars, getLocalLibraryPath(), binRoot());
-		for(auto file: jars)
-		{
-			launchScript += "cp " + file + "\n";
-		}
-		for(auto file: nativeJars)
-		{
-			launchScript += "ext " + file + "\n";
-		}
-		launchScript += "natives " + getNativePath() + "\n";
+		launchScript += "cp " + file + "\n";
 	}
+	for(auto file: plan.nativeJars)
+	{
+		launchScript += "ext " + file + "\n";
+	}
+	launchScript += "natives " + plan.nativePath + "\n";
 
-	for (auto trait : m_profile->getTraits())
+	for (auto trait : plan.traits)
 	{
 		launchScript += "traits " + trait + "\n";
 	}
@@ -514,13 +580,23 @@ QString MinecraftInstance::createLaunchScript(AuthSessionPtr session)
 }
 
 QStringList MinecraftInstance::verboseDescription(AuthSessionPtr session)
+{
+	auto plan = createLaunchPlan(session);
+	if(!plan)
+	{
+		return {"Instance has no profile"};
+	}
+	return verboseDescription(*plan);
+}
+
+QStringList MinecraftInstance::verboseDescription(const LaunchPlan &plan)
 {
 	QStringList out;
-	out << "Main Class:" << "  " + getMainClass() << "";
-	out << "Native path:" << "  " + getNativePath() << "";
+	out << "Main Class:" << "  " + plan.mainClass << "";
+	out << "Native path:" << "  " + plan.nativePath << "";
 
 
-	auto alltraits = traits();
+	auto alltraits = plan.traits;
 	if(alltraits.size())
 	{
 		out << "Traits:";
@@ -534,9 +610,6 @@ QStringList MinecraftInstance::verboseDescription(AuthSessionPtr session)
 	// libraries and class path.
 	{
 		out << "Libraries:";
-		QStringList jars, nativeJars;
-		auto javaArchitecture = settings()->get("JavaArchitecture").toString();
-		m_profile->getLibraryFiles(javaArchitecture, jars, nativeJars, getLocalLibraryPath(), binRoot());
 		auto printLibFile = [&](const QString & path)
 		{
 			QFileInfo info(path);
@@ -549,13 +622,13 @@ QStringList MinecraftInstance::verboseDescription(AuthSessionPtr session)
 				out << "  " + path + " (missing)";
 			}
 		};
-		for(auto file: jars)
+		for(auto file: plan.classPath)
 		{
 			printLibFile(file);
 		}
 		out << "";
 		out << "Native libraries:";
-		for(auto file: nativeJars)
+		for(auto file: plan.nativeJars)
 		{
 			printLibFile(file);
 		}
@@ -614,12 +687,10 @@ QStringList MinecraftInstance::verboseDescription(AuthSessionPtr session)
 		out << "";
 	}
 
-	auto params = processMinecraftArgs(nullptr);
 	out << "Params:";
-	out << "  " + params.join(' ');
+	out << "  " + plan.publicMinecraftArguments.join(' ');
 	out << "";
 
-	QString windowParams;
 	if (settings()->get("LaunchMaximized").toBool())
 	{
 		out << "Window size: max (if available)";
@@ -631,9 +702,26 @@ QStringList MinecraftInstance::verboseDescription(AuthSessionPtr session)
 		out << "Window size: " + QString::number(width) + " x " + QString::number(height);
 	}
 	out << "";
+
+	out << processLimits().describe();
+	out << "";
 	return out;
 }
 
+ProcessLimits MinecraftInstance::processLimits() const
+{
+	ProcessLimits limits;
+	if(!ProcessLimits::parseCpuList(settings()->get("CPUAffinity").toString(), limits.cpus))
+	{
+		qWarning() << "Ignoring invalid CPU affinity" << settings()->get("CPUAffinity").toString();
+	}
+	limits.nice = qBound(-20, settings()->get("ProcessPriority").toInt(), 19);
+	limits.ioPriority = ProcessLimits::parseIOPriority(settings()->get("IOPriority").toString());
+	limits.memoryLimit = qMax(0, settings()->get("MemoryLimit").toInt());
+	limits.cpuLimit = qMax(0, settings()->get("CPULimit").toInt());
+	return limits;
+}
+
 QMap<QString, QString> MinecraftInstance::createCensorFilterFromSession(AuthSessionPtr session)
 {
 	if(!session)
@@ -779,11 +867,136 @@ shared_qobject_ptr<Task> MinecraftInstance::createUpdateTask()
 	return shared_qobject_ptr<Task>(new OneSixUpdate(this));
 }
 
+ReadinessStamp MinecraftInstance::readinessStamp() const
+{
+	return ReadinessStamp(FS::PathCombine(instanceRoot(), "readiness.dat"));
+}
+
+QByteArray MinecraftInstance::readinessFingerprint() const
+{
+	QStringList parts;
+	parts << QDir(instanceRoot()).absolutePath();
+	parts << settings()->get("JavaArchitecture").toString();
+	parts << m_profile->getMinecraftVersion() << m_profile->getMainClass() << m_profile->getAppletClass();
+	parts << m_profile->getMinecraftArguments() << m_profile->getTweakers();
+	auto traits = m_profile->getTraits().toList();
+	std::sort(traits.begin(), traits.end());
+	parts << traits;
+	auto assets = m_profile->getMinecraftAssets();
+	if(assets)
+	{
+		parts << assets->id << assets->sha1;
+	}
+	auto addLibraries = [&](const QString &kind, const QList<LibraryPtr> &libraries)
+	{
+		parts << kind;
+		for(auto &library: libraries)
+		{
+			if(library)
+			{
+				parts << QString(library->rawName()) << library->hint();
+			}
+		}
+	};
+	addLibraries("libraries", m_profile->getLibraries());
+	addLibraries("natives", m_profile->getNativeLibraries());
+	addLibraries("jarmods", m_profile->getJarMods());
+	addLibraries("main", {m_profile->getMainJar()});
+	return QCryptographicHash::hash(parts.join('\n').toUtf8(), QCryptographicHash::Sha1);
+}
+
+QStringList MinecraftInstance::readinessFiles() const
+{
+	QStringList files;
+
+	// where the profile comes from. Missing ones are recorded too, they have to stay missing.
+	files << FS::PathCombine(instanceRoot(), "version.json");
+	files << FS::PathCombine(instanceRoot(), "custom.json");
+	files << FS::PathCombine(instanceRoot(), "order.json");
+	QDir patchesDir(FS::PathCombine(instanceRoot(), "patches"));
+	files << patchesDir.absolutePath();
+	for (auto info : patchesDir.entryInfoList(QStringList() << "*.json", QDir::Files))
+	{
+		files << info.absoluteFilePath();
+	}
+	// libraries put there override the shared ones
+	files << getLocalLibraryPath();
+	files << jarModsDir();
+
+	// libraries, except for the jar the jar mods get applied to, which is made at launch
+	QStringList jars, nativeJars;
+	getLibraryFiles(jars, nativeJars);
+	auto tempPath = QDir(binRoot()).absolutePath();
+	for(auto &jar: jars + nativeJars)
+	{
+		if(!QFileInfo(jar).absoluteFilePath().startsWith(tempPath))
+		{
+			files << jar;
+		}
+	}
+
+	// assets
+	auto assets = m_profile->getMinecraftAssets();
+	if(assets)
+	{
+		QString indexPath = "assets/indexes/" + assets->id + ".json";
+		files << QFileInfo(indexPath).absoluteFilePath();
+		AssetsIndex index;
+		if(AssetsUtils::loadAssetsIndexJson(assets->id, indexPath, &index))
+		{
+			for(auto &object: index.objects)
+			{
+				files << QFileInfo(object.getLocalPath()).absoluteFilePath();
+			}
+		}
+	}
+
+	// FML libraries copied into the instance
+	if(m_profile->hasTrait("legacyFML"))
+	{
+		QDir fmlLibDir(libDir());
+		files << fmlLibDir.absolutePath();
+		for (auto info : fmlLibDir.entryInfoList(QDir::Files))
+		{
+			files << info.absoluteFilePath();
+		}
+	}
+	return files;
+}
+
+bool MinecraftInstance::isUpToDate()
+{
+	if(!m_profile || hasVersionBroken())
+	{
+		return false;
+	}
+	QString reason;
+	if(!readinessStamp().check(readinessFingerprint(), &reason))
+	{
+		qDebug() << "Instance" << id() << "needs an update:" << reason;
+		return false;
+	}
+	return true;
+}
+
 std::shared_ptr<LaunchTask> MinecraftInstance::createLaunchTask(AuthSessionPtr session)
 {
 	auto process = LaunchTask::create(std::dynamic_pointer_cast<MinecraftInstance>(getSharedPtr()));
 	auto pptr = process.get();
 
+	// the models may have been unloaded while idle. Offline launches have no update step to load them again.
+	if(!m_profile->rowCount())
+	{
+		try
+		{
+			reloadProfile();
+		}
+		catch (...)
+		{
+			// the broken version is reported by the launch steps
+		}
+	}
+
 	ENV.icons()->saveIcon(iconKey(), FS::PathCombine(minecraftRoot(), "icon.png"), "PNG");
 
 	// print a header
@@ -791,6 +1004,12 @@ std::shared_ptr<LaunchTask> MinecraftInstance::createLaunchTask(AuthSessionPtr s
 		process->appendStep(std::make_shared<TextPrint>(pptr, "Minecraft folder is:\n" + minecraftRoot() + "\n\n", MessageLevel::MultiMC));
 	}
 
+	// get the jars into the page cache while we wait for auth and updates
+	{
+		auto step = std::make_shared<PrewarmClasspath>(pptr);
+		process->appendStep(step);
+	}
+
 	// check java
 	{
 		auto step = std::make_shared<CheckJava>(pptr);
@@ -828,6 +1047,12 @@ std::shared_ptr<LaunchTask> MinecraftInstance::createLaunchTask(AuthSessionPtr s
 		process->appendStep(step);
 	}
 
+	// from here on, the libraries and arguments don't change anymore
+	{
+		auto step = std::make_shared<CreateLaunchPlan>(pptr, session);
+		process->appendStep(step);
+	}
+
 	// print some instance info here...
 	{
 		auto step = std::make_shared<PrintInstanceInfo>(pptr, session);
@@ -846,6 +1071,13 @@ std::shared_ptr<LaunchTask> MinecraftInstance::createLaunchTask(AuthSessionPtr s
 		process->appendStep(step);
 	}
 
+	// summarize the garbage collector log once the game exits
+	if(settings()->get("EnableGCLogging").toBool())
+	{
+		auto step = std::make_shared<AnalyzeGCLog>(pptr);
+		process->appendStep(step);
+	}
+
 	{
 		// actually launch the game
 		auto method = launchMethod();
@@ -940,6 +1172,7 @@ QString MinecraftInstance::getComponentVersion(const QString& uid) const
 
 std::shared_ptr<ModList> MinecraftInstance::loaderModList() const
 {
+	touchModels();
 	if (!m_loader_mod_list)
 	{
 		m_loader_mod_list.reset(new ModList(loaderModsDir()));
@@ -950,6 +1183,7 @@ std::shared_ptr<ModList> MinecraftInstance::loaderModList() const
 
 std::shared_ptr<ModList> MinecraftInstance::coreModList() const
 {
+	touchModels();
 	if (!m_core_mod_list)
 	{
 		m_core_mod_list.reset(new ModList(coreModsDir()));
@@ -960,6 +1194,7 @@ std::shared_ptr<ModList> MinecraftInstance::coreModList() const
 
 std::shared_ptr<ModList> MinecraftInstance::resourcePackList() const
 {
+	touchModels();
 	if (!m_resource_pack_list)
 	{
 		m_resource_pack_list.reset(new ModList(resourcePacksDir()));
@@ -970,6 +1205,7 @@ std::shared_ptr<ModList> MinecraftInstance::resourcePackList() const
 
 std::shared_ptr<ModList> MinecraftInstance::texturePackList() const
 {
+	touchModels();
 	if (!m_texture_pack_list)
 	{
 		m_texture_pack_list.reset(new ModList(texturePacksDir()));
@@ -980,13 +1216,36 @@ std::shared_ptr<ModList> MinecraftInstance::texturePackList() const
 
 std::shared_ptr<WorldList> MinecraftInstance::worldList() const
 {
+	touchModels();
 	if (!m_world_list)
 	{
 		m_world_list.reset(new WorldList(worldDir()));
+		m_world_list->setBackupDir(worldBackupDir());
 	}
 	return m_world_list;
 }
 
+bool MinecraftInstance::hasLoadedModels() const
+{
+	return m_loader_mod_list || m_core_mod_list || m_resource_pack_list || m_texture_pack_list || m_world_list
+		|| (m_profile && m_profile->rowCount());
+}
+
+void MinecraftInstance::unloadModels()
+{
+	// anyone still holding on to the models keeps them alive, they just don't get updated anymore
+	m_loader_mod_list.reset();
+	m_core_mod_list.reset();
+	m_resource_pack_list.reset();
+	m_texture_pack_list.reset();
+	m_world_list.reset();
+	if(m_profile && m_profile->rowCount())
+	{
+		// back to how it was after init(). Whatever needs the components reloads the profile first.
+		createProfile();
+	}
+}
+
 QList< Mod > MinecraftInstance::getJarMods() const
 {
 	QList<Mod> mods;
@@ -2,6 +2,9 @@
 #include "BaseInstance.h"
 #include <java/JavaVersion.h>
 #include "minecraft/Mod.h"
+#include "ProcessLimits.h"
+#include "launch/LaunchPlan.h"
+#include "ReadinessStamp.h"
 #include <QProcess>
 #include <QDir>
 #include "multimc_logic_export.h"
@@ -40,6 +43,7 @@ public:
 	QString coreModsDir() const;
 	QString libDir() const;
 	QString worldDir() const;
+	QString worldBackupDir() const;
 	QDir jarmodsPath() const;
 	QDir librariesPath() const;
 	QDir versionsPath() const;
@@ -65,14 +69,30 @@ public:
 	std::shared_ptr<ModList> texturePackList() const;
 	std::shared_ptr<WorldList> worldList() const;
 
+	bool hasLoadedModels() const override;
+	void unloadModels() override;
+
 
 	//////  Launch stuff //////
 	shared_qobject_ptr<Task> createUpdateTask() override;
+	bool isUpToDate() override;
+
+	/// written after a complete update, see ReadinessStamp
+	ReadinessStamp readinessStamp() const;
+	/// fingerprint of the resolved profile and the settings that change which files it uses
+	QByteArray readinessFingerprint() const;
+	/// the files an update makes sure of, and the ones the profile is loaded from
+	QStringList readinessFiles() const;
 	std::shared_ptr<LaunchTask> createLaunchTask(AuthSessionPtr account) override;
 	QStringList extraArguments() const override;
 	QStringList verboseDescription(AuthSessionPtr session) override;
+	QStringList verboseDescription(const LaunchPlan &plan);
 	QList<Mod> getJarMods() const;
-	QString createLaunchScript(AuthSessionPtr session);
+	QString createLaunchScript(const LaunchPlan &plan, AuthSessionPtr session) const;
+
+	/// work out everything the launch needs from the current profile and settings. Returns nullptr without a profile.
+	LaunchPlanPtr createLaunchPlan(AuthSessionPtr session) const;
+
 	/// get arguments passed to java
 	QStringList javaArguments() const;
 
@@ -91,6 +111,8 @@ public:
 
 	QString getStatusbarDescription() override;
 
+	/// resolve the class path and the native jars in one go
+	void getLibraryFiles(QStringList &jars, QStringList &nativeJars) const;
 	virtual QStringList getClassPath() const;
 	virtual QStringList getNativeJars() const;
 	virtual QString getMainClass() const;
@@ -99,6 +121,9 @@ public:
 
 	virtual JavaVersion getJavaVersion() const;
 
+	/// scheduling and resource limits for the game process
+	ProcessLimits processLimits() const;
+
 	QString getComponentVersion(const QString &uid) const;
 	bool setComponentVersion(const QString &uid, const QString &version);
 
@@ -112,6 +137,9 @@ protected:
 
 private:
 	QString prettifyTimeDuration(int64_t duration);
+	QStringList processMinecraftArgs(AuthSessionPtr session, const QString &gameAssets) const;
+	QMap<QString, QString> getVariables(const QStringList &javaArgs) const;
+	QString windowParams() const;
 
 protected: // data
 	std::shared_ptr<ComponentList> m_profile;
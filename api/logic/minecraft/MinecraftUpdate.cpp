@@ -31,20 +31,21 @@
 
 #include "update/FoldersTask.h"
 #include "update/LibrariesTask.h"
+#include "update/ReloadProfileTask.h"
 #include "update/FMLLibrariesTask.h"
 #include "update/AssetUpdateTask.h"
 
 #include <meta/Index.h>
 #include <meta/Version.h>
 
-OneSixUpdate::OneSixUpdate(MinecraftInstance *inst, QObject *parent) : Task(parent), m_inst(inst)
+OneSixUpdate::OneSixUpdate(MinecraftInstance *inst, QObject *parent)
+	: TaskGraph(parent), m_inst(inst), m_instanceLock(inst->shared_from_this())
 {
 	// create folders
-	{
-		m_tasks.append(std::make_shared<FoldersTask>(m_inst));
-	}
+	int folders = addTask(std::make_shared<FoldersTask>(m_inst));
 
 	// add metadata update tasks, if necessary
+	QList<int> metadataTasks;
 	{
 		/*
 		 * FIXME: there are some corner cases here that remain unhandled:
@@ -66,7 +67,7 @@ OneSixUpdate::OneSixUpdate(MinecraftInstance *inst, QObject *parent) : Task(pare
 				if(task)
 				{
 					qDebug() << "Loading remote meta patch" << id;
-					m_tasks.append(task.unwrap());
+					metadataTasks.append(addTask(task.unwrap()));
 				}
 			}
 			else
@@ -76,20 +77,17 @@ OneSixUpdate::OneSixUpdate(MinecraftInstance *inst, QObject *parent) : Task(pare
 		}
 	}
 
+	// everything below needs the final profile
+	int profile = addTask(std::make_shared<ReloadProfileTask>(m_inst), metadataTasks);
+
 	// libraries download
-	{
-		m_tasks.append(std::make_shared<LibrariesTask>(m_inst));
-	}
+	addTask(std::make_shared<LibrariesTask>(m_inst), {profile});
 
 	// FML libraries download and copy into the instance
-	{
-		m_tasks.append(std::make_shared<FMLLibrariesTask>(m_inst));
-	}
+	addTask(std::make_shared<FMLLibrariesTask>(m_inst), {profile, folders});
 
 	// assets update
-	{
-		m_tasks.append(std::make_shared<AssetUpdateTask>(m_inst));
-	}
+	addTask(std::make_shared<AssetUpdateTask>(m_inst), {profile});
 }
 
 void OneSixUpdate::executeTask()
@@ -99,105 +97,14 @@ void OneSixUpdate::executeTask()
 		emitFailed(m_preFailure);
 		return;
 	}
-	next();
-}
-
-void OneSixUpdate::next()
-{
-	if(m_abort)
-	{
-		emitFailed(tr("Aborted by user."));
-		return;
-	}
-	if(m_failed_out_of_order)
-	{
-		emitFailed(m_fail_reason);
-		return;
-	}
-	m_currentTask ++;
-	if(m_currentTask > 0)
-	{
-		auto task = m_tasks[m_currentTask - 1];
-		disconnect(task.get(), &Task::succeeded, this, &OneSixUpdate::subtaskSucceeded);
-		disconnect(task.get(), &Task::failed, this, &OneSixUpdate::subtaskFailed);
-		disconnect(task.get(), &Task::progress, this, &OneSixUpdate::progress);
-		disconnect(task.get(), &Task::status, this, &OneSixUpdate::setStatus);
-	}
-	if(m_currentTask == m_tasks.size())
-	{
-		emitSucceeded();
-		return;
-	}
-	auto task = m_tasks[m_currentTask];
-	// if the task is already finished by the time we look at it, skip it
-	if(task->isFinished())
-	{
-		qCritical() << "OneSixUpdate: Skipping finished subtask" << m_currentTask << ":" << task.get();
-		next();
-	}
-	connect(task.get(), &Task::succeeded, this, &OneSixUpdate::subtaskSucceeded);
-	connect(task.get(), &Task::failed, this, &OneSixUpdate::subtaskFailed);
-	connect(task.get(), &Task::progress, this, &OneSixUpdate::progress);
-	connect(task.get(), &Task::status, this, &OneSixUpdate::setStatus);
-	// if the task is already running, do not start it again
-	if(!task->isRunning())
-	{
-		task->start();
-	}
-}
-
-void OneSixUpdate::subtaskSucceeded()
-{
-	if(isFinished())
-	{
-		qCritical() << "OneSixUpdate: Subtask" << sender() << "succeeded, but work was already done!";
-		return;
-	}
-	auto senderTask = QObject::sender();
-	auto currentTask = m_tasks[m_currentTask].get();
-	if(senderTask != currentTask)
-	{
-		qDebug() << "OneSixUpdate: Subtask" << sender() << "succeeded out of order.";
-		return;
-	}
-	next();
-}
-
-void OneSixUpdate::subtaskFailed(QString error)
-{
-	if(isFinished())
-	{
-		qCritical() << "OneSixUpdate: Subtask" << sender() << "failed, but work was already done!";
-		return;
-	}
-	auto senderTask = QObject::sender();
-	auto currentTask = m_tasks[m_currentTask].get();
-	if(senderTask != currentTask)
-	{
-		qDebug() << "OneSixUpdate: Subtask" << sender() << "failed out of order.";
-		m_failed_out_of_order = true;
-		m_fail_reason = error;
-		return;
-	}
-	emitFailed(error);
-}
-
-
-bool OneSixUpdate::abort()
-{
-	if(!m_abort)
-	{
-		m_abort = true;
-		auto task = m_tasks[m_currentTask];
-		if(task->canAbort())
-		{
-			return task->abort();
-		}
-	}
-	return true;
+	// an update that doesn't finish must not leave the old stamp behind
+	m_inst->readinessStamp().remove();
+	TaskGraph::executeTask();
 }
 
-bool OneSixUpdate::canAbort() const
+void OneSixUpdate::emitSucceeded()
 {
-	return true;
+	// everything is in place now, the next launch can skip all this if nothing changes
+	m_inst->readinessStamp().write(m_inst->readinessFingerprint(), m_inst->readinessFiles());
+	TaskGraph::emitSucceeded();
 }
@@ -20,36 +20,27 @@
 #include <QUrl>
 
 #include "net/NetJob.h"
-#include "tasks/Task.h"
+#include "tasks/TaskGraph.h"
 #include "minecraft/VersionFilterData.h"
+#include "Usable.h"
 #include <quazip.h>
 
 class MinecraftVersion;
 class MinecraftInstance;
 
-class OneSixUpdate : public Task
+class OneSixUpdate : public TaskGraph
 {
 	Q_OBJECT
 public:
 	explicit OneSixUpdate(MinecraftInstance *inst, QObject *parent = 0);
 	void executeTask() override;
-	bool canAbort() const override;
 
-private
-slots:
-	bool abort() override;
-	void subtaskSucceeded();
-	void subtaskFailed(QString error);
-
-private:
-	void next();
+protected:
+	void emitSucceeded() override;
 
 private:
 	MinecraftInstance *m_inst = nullptr;
-	QList<std::shared_ptr<Task>> m_tasks;
+	// keeps the idle model unloader from resetting the profile under the update
+	UseLock m_instanceLock;
 	QString m_preFailure;
-	int m_currentTask = -1;
-	bool m_abort = false;
-	bool m_failed_out_of_order = false;
-	QString m_fail_reason;
 };
@@ -0,0 +1,127 @@
+/* Copyright 2013-2017 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ReadinessStamp.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QSet>
+#include <algorithm>
+
+#include "FileSystem.h"
+
+namespace
+{
+const quint32 stampMagic = 0x4D4D5253;
+const quint32 stampVersion = 1;
+}
+
+ReadinessStamp::ReadinessStamp(const QString &path) : m_path(path)
+{
+}
+
+bool ReadinessStamp::write(const QByteArray &fingerprint, const QStringList &files) const
+{
+	// sorted, so files in the same folder get checked together
+	auto sorted = files.toSet().toList();
+	std::sort(sorted.begin(), sorted.end());
+
+	QByteArray data;
+	QDataStream out(&data, QIODevice::WriteOnly);
+	out.setVersion(QDataStream::Qt_5_4);
+	out << stampMagic << stampVersion << fingerprint << quint32(sorted.size());
+	for(auto &file: sorted)
+	{
+		QFileInfo info(file);
+		if(!info.exists())
+		{
+			out << file << qint64(-1) << qint64(0);
+			continue;
+		}
+		out << file << qint64(info.size()) << info.lastModified().toMSecsSinceEpoch();
+	}
+	try
+	{
+		FS::write(m_path, data);
+	}
+	catch (const FS::FileSystemException &e)
+	{
+		qWarning() << "Couldn't write the readiness stamp" << m_path << ":" << e.cause();
+		return false;
+	}
+	return true;
+}
+
+bool ReadinessStamp::check(const QByteArray &fingerprint, QString *reason) const
+{
+	auto fail = [reason](const QString &why)
+	{
+		if(reason)
+		{
+			*reason = why;
+		}
+		return false;
+	};
+	QFile file(m_path);
+	if(!file.open(QIODevice::ReadOnly))
+	{
+		return fail("no stamp");
+	}
+	QDataStream in(&file);
+	in.setVersion(QDataStream::Qt_5_4);
+	quint32 magic = 0, version = 0, count = 0;
+	QByteArray storedFingerprint;
+	in >> magic >> version >> storedFingerprint >> count;
+	if(in.status() != QDataStream::Ok || magic != stampMagic || version != stampVersion)
+	{
+		return fail("unreadable stamp");
+	}
+	if(storedFingerprint != fingerprint)
+	{
+		return fail("the profile changed");
+	}
+	for(quint32 i = 0; i < count; i++)
+	{
+		QString path;
+		qint64 size = 0, modified = 0;
+		in >> path >> size >> modified;
+		if(in.status() != QDataStream::Ok)
+		{
+			return fail("unreadable stamp");
+		}
+		QFileInfo info(path);
+		if(size < 0)
+		{
+			if(info.exists())
+			{
+				return fail(QString("%1 appeared").arg(path));
+			}
+			continue;
+		}
+		if(!info.exists() || info.size() != size || info.lastModified().toMSecsSinceEpoch() != modified)
+		{
+			return fail(QString("%1 changed").arg(path));
+		}
+	}
+	return true;
+}
+
+void ReadinessStamp::remove() const
+{
+	QFile::remove(m_path);
+}
@@ -0,0 +1,52 @@
+/* Copyright 2013-2017 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+#include "multimc_logic_export.h"
+
+/**
+ * Remembers that an instance was completely updated, so a launch can skip the update when nothing changed since.
+ *
+ * The stamp holds a fingerprint of the resolved profile and the size and modification time of every file the
+ * update made sure of. It is valid as long as the fingerprint is the same and none of the files changed, which
+ * takes one stat per file instead of resolving the profile and checking the downloads again.
+ */
+class MULTIMC_LOGIC_EXPORT ReadinessStamp
+{
+public:
+	explicit ReadinessStamp(const QString &path);
+
+	/// record the files as ready for the fingerprint. Files that don't exist are recorded as such and have to stay missing.
+	bool write(const QByteArray &fingerprint, const QStringList &files) const;
+
+	/// is the stamp there, for the same fingerprint, with all the files unchanged? The reason says why not.
+	bool check(const QByteArray &fingerprint, QString *reason = nullptr) const;
+
+	/// forget the stamp, so the next launch does a full update
+	void remove() const;
+
+	QString path() const
+	{
+		return m_path;
+	}
+
+private:
+	QString m_path;
+};
@@ -0,0 +1,72 @@
+#include <QTest>
+#include <QTemporaryDir>
+#include "TestUtil.h"
+
+#include "minecraft/ReadinessStamp.h"
+#include "FileSystem.h"
+
+#include <QFile>
+
+class ReadinessStampTest : public QObject
+{
+	Q_OBJECT
+private:
+	QString makeFile(const QString &root, const QString &path, int size)
+	{
+		auto fullPath = FS::PathCombine(root, path);
+		FS::ensureFilePathExists(fullPath);
+		FS::write(fullPath, QByteArray(size, 'x'));
+		return fullPath;
+	}
+
+private
+slots:
+	void test_check()
+	{
+		QTemporaryDir tempDir;
+		auto root = tempDir.path();
+		auto library = makeFile(root, "libraries/lib.jar", 10);
+		auto asset = makeFile(root, "assets/objects/ab/abcd", 20);
+		auto custom = FS::PathCombine(root, "custom.json");
+
+		ReadinessStamp stamp(FS::PathCombine(root, "readiness.dat"));
+		QString reason;
+		QVERIFY(!stamp.check("one", &reason));
+
+		QVERIFY(stamp.write("one", {library, asset, custom}));
+		QVERIFY(stamp.check("one"));
+
+		// a different profile needs an update
+		QVERIFY(!stamp.check("two", &reason));
+
+		// so does a file that changed size
+		{
+			QFile file(asset);
+			QVERIFY(file.open(QIODevice::Append));
+			file.write("more");
+		}
+		QVERIFY(!stamp.check("one", &reason));
+		QVERIFY(reason.contains(asset));
+		QVERIFY(stamp.write("one", {library, asset, custom}));
+		QVERIFY(stamp.check("one"));
+
+		// one that went missing
+		QVERIFY(QFile::remove(library));
+		QVERIFY(!stamp.check("one"));
+		makeFile(root, "libraries/lib.jar", 10);
+		QVERIFY(stamp.write("one", {library, asset, custom}));
+		QVERIFY(stamp.check("one"));
+
+		// and one that was missing before and isn't anymore
+		makeFile(root, "custom.json", 5);
+		QVERIFY(!stamp.check("one", &reason));
+		QVERIFY(reason.contains(custom));
+
+		stamp.remove();
+		QVERIFY(!stamp.check("one"));
+	}
+};
+
+QTEST_GUILESS_MAIN(ReadinessStampTest)
+
+#include "ReadinessStamp_test.moc"
@@ -0,0 +1,861 @@
+/* Copyright 2013-2017 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "WorldBackupStore.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLockFile>
+#include <QSaveFile>
+#include <QUuid>
+#include <QtEndian>
+
+#include <algorithm>
+
+#include "FileSystem.h"
+#include "Exception.h"
+
+namespace
+{
+const char *idFormat = "yyyyMMdd-HHmmss-zzz";
+const quint32 indexMagic = 0x4D4D4350;
+const quint32 indexVersion = 1;
+const qint64 sectorSize = 4096;
+const qint64 blockSize = 1024 * 1024;
+
+bool isRegionFile(const QString &fileName)
+{
+	return fileName.endsWith(".mca") || fileName.endsWith(".mcr");
+}
+
+QByteArray hashOf(const QByteArray &data)
+{
+	return QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+}
+}
+
+QSet<int> WorldBackupRetention::select(const QList<QDateTime> &created) const
+{
+	QSet<int> keep;
+	if(created.isEmpty())
+	{
+		return keep;
+	}
+	keep.insert(0);
+	for(int i = 0; i < created.size() && i < keepLast; i++)
+	{
+		keep.insert(i);
+	}
+	QSet<QDate> days;
+	QSet<int> weeks;
+	for(int i = 0; i < created.size(); i++)
+	{
+		auto date = created[i].toLocalTime().date();
+		if(!days.contains(date) && days.size() < keepDaily)
+		{
+			days.insert(date);
+			keep.insert(i);
+		}
+		int year = 0;
+		int week = date.weekNumber(&year) + year * 100;
+		if(!weeks.contains(week) && weeks.size() < keepWeekly)
+		{
+			weeks.insert(week);
+			keep.insert(i);
+		}
+	}
+	return keep;
+}
+
+/// Appends pieces to a new pack. Nothing of it is visible until finish() succeeds.
+class WorldBackupStore::PackWriter
+{
+public:
+	explicit PackWriter(WorldBackupStore *store)
+		: m_store(store), m_name(QUuid::createUuid().toString().remove('{').remove('}'))
+	{
+	}
+	~PackWriter()
+	{
+		if(m_file.isOpen())
+		{
+			m_file.close();
+			m_file.remove();
+		}
+	}
+
+	bool contains(const QByteArray &hash) const
+	{
+		return m_contained.contains(hash);
+	}
+
+	bool append(const QByteArray &hash, const QByteArray &piece, QString &error)
+	{
+		if(!m_file.isOpen())
+		{
+			m_file.setFileName(m_store->packPath(m_name, ".pack.part"));
+			if(!m_file.open(QIODevice::WriteOnly))
+			{
+				error = QObject::tr("Couldn't create %1: %2").arg(m_file.fileName(), m_file.errorString());
+				return false;
+			}
+		}
+		Location location;
+		location.pack = m_name;
+		location.offset = m_file.pos();
+		location.size = piece.size();
+		if(m_file.write(piece) != piece.size())
+		{
+			error = QObject::tr("Couldn't write to %1: %2").arg(m_file.fileName(), m_file.errorString());
+			return false;
+		}
+		m_entries.append(qMakePair(hash, location));
+		m_contained.insert(hash);
+		return true;
+	}
+
+	/// make the pack part of the store. The pieces in it replace any other copies.
+	bool finish(QString &error)
+	{
+		if(!m_file.isOpen())
+		{
+			return true;
+		}
+		// the pack has to be on the disk before the index points into it
+		bool flushed = m_file.flush() && FS::syncToDisk(m_file.fileName());
+		m_file.close();
+		QString packsDir = FS::PathCombine(m_store->m_path, "packs");
+		if(!flushed || !m_file.rename(m_store->packPath(m_name, ".pack")) || !FS::syncToDisk(packsDir))
+		{
+			error = QObject::tr("Couldn't finish %1: %2").arg(m_file.fileName(), m_file.errorString());
+			m_file.remove();
+			return false;
+		}
+		// the index makes the pack count. Without it, the pack gets cleaned up on the next open.
+		if(!m_store->writeIndex(m_name, m_entries, error) || !FS::syncToDisk(packsDir))
+		{
+			QFile::remove(m_store->packPath(m_name, ".idx"));
+			QFile::remove(m_store->packPath(m_name, ".pack"));
+			if(error.isEmpty())
+			{
+				error = QObject::tr("Couldn't flush %1 to the disk.").arg(packsDir);
+			}
+			return false;
+		}
+		for(auto &entry: m_entries)
+		{
+			m_store->m_index.insert(entry.first, entry.second);
+		}
+		m_store->m_packs.insert(m_name, m_entries);
+		return true;
+	}
+
+private:
+	WorldBackupStore *m_store;
+	QString m_name;
+	QFile m_file;
+	QList<QPair<QByteArray, Location>> m_entries;
+	QSet<QByteArray> m_contained;
+};
+
+WorldBackupStore::WorldBackupStore(const QString &path) : m_path(path)
+{
+}
+
+WorldBackupStore::~WorldBackupStore()
+{
+}
+
+QString WorldBackupStore::packPath(const QString &pack, const QString &suffix) const
+{
+	return FS::PathCombine(m_path, "packs", pack + suffix);
+}
+
+QString WorldBackupStore::snapshotPath(const QString &world, const QString &id) const
+{
+	return FS::PathCombine(m_path, "snapshots", world, id + ".json");
+}
+
+bool WorldBackupStore::open(QString &error)
+{
+	QString packsDir = FS::PathCombine(m_path, "packs");
+	if(!FS::ensureFolderPathExists(packsDir) || !FS::ensureFolderPathExists(FS::PathCombine(m_path, "snapshots")))
+	{
+		error = QObject::tr("Couldn't create the backup folder %1.").arg(m_path);
+		return false;
+	}
+	m_lock.reset(new QLockFile(FS::PathCombine(m_path, "lock")));
+	if(!m_lock->tryLock(100))
+	{
+		m_lock.reset();
+		error = QObject::tr("The backups in %1 are in use by something else.").arg(m_path);
+		return false;
+	}
+
+	m_index.clear();
+	m_packs.clear();
+	QDir dir(packsDir);
+	auto indexed = dir.entryList({"*.idx"}, QDir::Files);
+	for(auto &name: dir.entryList({"*.part", "*.pack"}, QDir::Files))
+	{
+		if(name.endsWith(".part") || !indexed.contains(name.left(name.size() - 5) + ".idx"))
+		{
+			qDebug() << "Removing unfinished backup pack" << name;
+			dir.remove(name);
+		}
+	}
+	for(auto &name: indexed)
+	{
+		auto pack = name.left(name.size() - 4);
+		if(!QFile::exists(packPath(pack, ".pack")))
+		{
+			qWarning() << "Backup pack" << pack << "is missing, snapshots using it can't be restored";
+			continue;
+		}
+		if(!readIndex(pack, error))
+		{
+			m_lock.reset();
+			return false;
+		}
+	}
+	return true;
+}
+
+bool WorldBackupStore::readIndex(const QString &pack, QString &error)
+{
+	QFile file(packPath(pack, ".idx"));
+	if(!file.open(QIODevice::ReadOnly))
+	{
+		error = QObject::tr("Couldn't read %1: %2").arg(file.fileName(), file.errorString());
+		return false;
+	}
+	QDataStream in(&file);
+	quint32 magic = 0, version = 0, count = 0;
+	in >> magic >> version >> count;
+	if(magic != indexMagic || version != indexVersion)
+	{
+		error = QObject::tr("%1 is not a backup pack index.").arg(file.fileName());
+		return false;
+	}
+	QList<QPair<QByteArray, Location>> entries;
+	for(quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++)
+	{
+		QByteArray hash(20, 0);
+		Location location;
+		location.pack = pack;
+		in.readRawData(hash.data(), hash.size());
+		in >> location.offset >> location.size;
+		entries.append(qMakePair(hash, location));
+	}
+	if(in.status() != QDataStream::Ok)
+	{
+		error = QObject::tr("The backup pack index %1 is truncated.").arg(file.fileName());
+		return false;
+	}
+	for(auto &entry: entries)
+	{
+		if(!m_index.contains(entry.first))
+		{
+			m_index.insert(entry.first, entry.second);
+		}
+	}
+	m_packs.insert(pack, entries);
+	return true;
+}
+
+bool WorldBackupStore::writeIndex(const QString &pack, const QList<QPair<QByteArray, Location>> &entries, QString &error)
+{
+	QSaveFile file(packPath(pack, ".idx"));
+	if(!file.open(QIODevice::WriteOnly))
+	{
+		error = QObject::tr("Couldn't create %1: %2").arg(file.fileName(), file.errorString());
+		return false;
+	}
+	QDataStream out(&file);
+	out << indexMagic << indexVersion << quint32(entries.size());
+	for(auto &entry: entries)
+	{
+		out.writeRawData(entry.first.constData(), entry.first.size());
+		out << entry.second.offset << entry.second.size;
+	}
+	if(out.status() != QDataStream::Ok || !file.commit())
+	{
+		error = QObject::tr("Couldn't write %1: %2").arg(file.fileName(), file.errorString());
+		return false;
+	}
+	return true;
+}
+
+void WorldBackupStore::removePack(const QString &pack)
+{
+	// index first, a pack without one is only garbage
+	QFile::remove(packPath(pack, ".idx"));
+	QFile::remove(packPath(pack, ".pack"));
+	for(auto &entry: m_packs.value(pack))
+	{
+		auto iter = m_index.find(entry.first);
+		if(iter != m_index.end() && iter->pack == pack)
+		{
+			m_index.erase(iter);
+		}
+	}
+	m_packs.remove(pack);
+}
+
+QStringList WorldBackupStore::worlds() const
+{
+	QDir snapshots(FS::PathCombine(m_path, "snapshots"));
+	QStringList worlds;
+	for(auto &world: snapshots.entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name))
+	{
+		if(!snapshotIds(world).isEmpty())
+		{
+			worlds.append(world);
+		}
+	}
+	return worlds;
+}
+
+QStringList WorldBackupStore::snapshotIds(const QString &world) const
+{
+	QDir dir(FS::PathCombine(m_path, "snapshots", world));
+	QStringList ids;
+	for(auto &name: dir.entryList({"*.json"}, QDir::Files, QDir::Name | QDir::Reversed))
+	{
+		ids.append(name.left(name.size() - 5));
+	}
+	return ids;
+}
+
+QDateTime WorldBackupStore::snapshotTime(const QString &id)
+{
+	auto time = QDateTime::fromString(id, idFormat);
+	time.setTimeSpec(Qt::UTC);
+	return time;
+}
+
+bool WorldBackupStore::loadSnapshot(const QString &world, const QString &id, Snapshot &snapshot, QString &error) const
+{
+	QJsonParseError parseError;
+	QJsonDocument doc;
+	try
+	{
+		doc = QJsonDocument::fromJson(FS::read(snapshotPath(world, id)), &parseError);
+	}
+	catch(Exception &e)
+	{
+		error = e.cause();
+		return false;
+	}
+	if(parseError.error != QJsonParseError::NoError || !doc.isObject())
+	{
+		error = QObject::tr("The snapshot %1 of %2 is damaged: %3").arg(id, world, parseError.errorString());
+		return false;
+	}
+	auto root = doc.object();
+	snapshot = Snapshot();
+	snapshot.id = id;
+	snapshot.world = world;
+	snapshot.created = snapshotTime(id);
+	snapshot.size = qint64(root.value("size").toDouble());
+	snapshot.stored = qint64(root.value("stored").toDouble());
+	for(auto folder: root.value("folders").toArray())
+	{
+		snapshot.folders.append(folder.toString());
+	}
+	for(auto value: root.value("files").toArray())
+	{
+		auto obj = value.toObject();
+		File file;
+		file.path = obj.value("path").toString();
+		file.size = qint64(obj.value("size").toDouble());
+		file.mtime = qint64(obj.value("mtime").toDouble());
+		auto hashes = QByteArray::fromBase64(obj.value("pieces").toString().toLatin1());
+		for(int i = 0; i + 20 <= hashes.size(); i += 20)
+		{
+			file.pieces.append(hashes.mid(i, 20));
+		}
+		snapshot.files.append(file);
+	}
+	return true;
+}
+
+bool WorldBackupStore::saveSnapshot(const Snapshot &snapshot, QString &error)
+{
+	QJsonArray files;
+	for(auto &file: snapshot.files)
+	{
+		QJsonObject obj;
+		obj.insert("path", file.path);
+		obj.insert("size", double(file.size));
+		obj.insert("mtime", double(file.mtime));
+		// raw hashes, base64 encoded. Keeps snapshots of big worlds small.
+		QByteArray hashes;
+		for(auto &hash: file.pieces)
+		{
+			hashes.append(hash);
+		}
+		obj.insert("pieces", QString::fromLatin1(hashes.toBase64()));
+		files.append(obj);
+	}
+	QJsonObject root;
+	root.insert("formatVersion", 1);
+	root.insert("size", double(snapshot.size));
+	root.insert("stored", double(snapshot.stored));
+	root.insert("folders", QJsonArray::fromStringList(snapshot.folders));
+	root.insert("files", files);
+	try
+	{
+		auto path = snapshotPath(snapshot.world, snapshot.id);
+		FS::ensureFilePathExists(path);
+		FS::write(path, QJsonDocument(root).toJson(QJsonDocument::Compact));
+	}
+	catch(Exception &e)
+	{
+		error = e.cause();
+		return false;
+	}
+	return true;
+}
+
+QList<QPair<qint64, qint64>> WorldBackupStore::pieces(const QString &fileName, const QByteArray &data)
+{
+	const qint64 size = data.size();
+	QList<qint64> cuts;
+	cuts.append(0);
+	if(isRegionFile(fileName) && size >= 2 * sectorSize)
+	{
+		// the first sector holds where the chunks are, the second when they were saved. The chunks follow in sectors.
+		cuts << sectorSize << 2 * sectorSize;
+		auto header = reinterpret_cast<const uchar *>(data.constData());
+		for(int i = 0; i < 1024; i++)
+		{
+			quint32 location = qFromBigEndian<quint32>(header + i * 4);
+			qint64 start = qint64(location >> 8) * sectorSize;
+			qint64 end = start + qint64(location & 0xFF) * sectorSize;
+			if(start < 2 * sectorSize || start == end)
+			{
+				continue;
+			}
+			cuts << start << end;
+		}
+	}
+	else
+	{
+		for(qint64 offset = blockSize; offset < size; offset += blockSize)
+		{
+			cuts.append(offset);
+		}
+	}
+	std::sort(cuts.begin(), cuts.end());
+	cuts.erase(std::unique(cuts.begin(), cuts.end()), cuts.end());
+
+	QList<QPair<qint64, qint64>> result;
+	for(int i = 0; i < cuts.size() && cuts[i] < size; i++)
+	{
+		qint64 end = (i + 1 < cuts.size()) ? qMin(cuts[i + 1], size) : size;
+		result.append(qMakePair(cuts[i], end - cuts[i]));
+	}
+	return result;
+}
+
+bool WorldBackupStore::backup(const QString &worldPath, const QString &world, Snapshot &snapshot, QString &error, ProgressCallback progress)
+{
+	QDir root(worldPath);
+	if(!root.exists())
+	{
+		error = QObject::tr("The world folder %1 doesn't exist.").arg(worldPath);
+		return false;
+	}
+
+	// the previous snapshot tells which files didn't change
+	QHash<QString, File> previousFiles;
+	auto ids = snapshotIds(world);
+	if(!ids.isEmpty())
+	{
+		Snapshot previous;
+		QString previousError;
+		if(loadSnapshot(world, ids.first(), previous, previousError))
+		{
+			for(auto &file: previous.files)
+			{
+				previousFiles.insert(file.path, file);
+			}
+		}
+		else
+		{
+			qWarning() << "Can't use the previous snapshot of" << world << ":" << previousError;
+		}
+	}
+
+	snapshot = Snapshot();
+	snapshot.world = world;
+	snapshot.created = QDateTime::currentDateTimeUtc();
+	snapshot.id = snapshot.created.toString(idFormat);
+	if(QFile::exists(snapshotPath(world, snapshot.id)))
+	{
+		error = QObject::tr("A snapshot of %1 was just made.").arg(world);
+		return false;
+	}
+
+	QStringList files;
+	QDirIterator iter(worldPath, QDir::Files | QDir::Dirs | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot | QDir::NoSymLinks,
+					  QDirIterator::Subdirectories);
+	while(iter.hasNext())
+	{
+		iter.next();
+		auto relative = root.relativeFilePath(iter.filePath());
+		if(iter.fileInfo().isDir())
+		{
+			snapshot.folders.append(relative);
+		}
+		else
+		{
+			files.append(relative);
+		}
+	}
+	files.sort();
+	snapshot.folders.sort();
+
+	PackWriter writer(this);
+	auto store = [&](File &file, const QByteArray &piece) -> bool
+	{
+		auto hash = hashOf(piece);
+		file.pieces.append(hash);
+		file.size += piece.size();
+		if(m_index.contains(hash) || writer.contains(hash))
+		{
+			return true;
+		}
+		snapshot.stored += piece.size();
+		return writer.append(hash, piece, error);
+	};
+
+	for(int i = 0; i < files.size(); i++)
+	{
+		if(progress)
+		{
+			progress(i, files.size());
+		}
+		QFileInfo info(root.filePath(files[i]));
+		File file;
+		file.path = files[i];
+		file.mtime = info.lastModified().toMSecsSinceEpoch();
+
+		auto previous = previousFiles.constFind(file.path);
+		if(previous != previousFiles.constEnd() && previous->size == info.size() && previous->mtime == file.mtime)
+		{
+			bool complete = std::all_of(previous->pieces.begin(), previous->pieces.end(), [this](const QByteArray &hash)
+			{
+				return m_index.contains(hash);
+			});
+			if(complete)
+			{
+				file.size = previous->size;
+				file.pieces = previous->pieces;
+				snapshot.size += file.size;
+				snapshot.files.append(file);
+				continue;
+			}
+		}
+
+		QFile input(info.absoluteFilePath());
+		if(!input.open(QIODevice::ReadOnly))
+		{
+			error = QObject::tr("Couldn't read %1: %2").arg(input.fileName(), input.errorString());
+			return false;
+		}
+		if(isRegionFile(file.path))
+		{
+			// region files are a few megabytes at most, the header is needed to cut them
+			auto data = input.readAll();
+			for(auto &piece: pieces(file.path, data))
+			{
+				if(!store(file, data.mid(piece.first, piece.second)))
+				{
+					return false;
+				}
+			}
+		}
+		else
+		{
+			while(!input.atEnd())
+			{
+				auto piece = input.read(blockSize);
+				if(piece.isEmpty() && input.error() != QFile::NoError)
+				{
+					error = QObject::tr("Couldn't read %1: %2").arg(input.fileName(), input.errorString());
+					return false;
+				}
+				if(!store(file, piece))
+				{
+					return false;
+				}
+			}
+		}
+		snapshot.size += file.size;
+		snapshot.files.append(file);
+	}
+
+	if(!writer.finish(error) || !saveSnapshot(snapshot, error))
+	{
+		return false;
+	}
+	qDebug() << "Backed up" << world << "as" << snapshot.id << ":" << snapshot.size << "bytes," << snapshot.stored << "of them new";
+	return true;
+}
+
+QByteArray WorldBackupStore::readPiece(const QByteArray &hash, QHash<QString, std::shared_ptr<QFile>> &openPacks, QString &error) const
+{
+	auto location = m_index.constFind(hash);
+	if(location == m_index.constEnd())
+	{
+		error = QObject::tr("A piece of the snapshot is missing from the backups.");
+		return QByteArray();
+	}
+	auto &pack = openPacks[location->pack];
+	if(!pack)
+	{
+		pack = std::make_shared<QFile>(packPath(location->pack, ".pack"));
+		if(!pack->open(QIODevice::ReadOnly))
+		{
+			error = QObject::tr("Couldn't read %1: %2").arg(pack->fileName(), pack->errorString());
+			pack.reset();
+			return QByteArray();
+		}
+	}
+	QByteArray piece;
+	if(pack->seek(location->offset))
+	{
+		piece = pack->read(location->size);
+	}
+	if(piece.size() != location->size || hashOf(piece) != hash)
+	{
+		error = QObject::tr("The backup pack %1 is damaged.").arg(pack->fileName());
+		return QByteArray();
+	}
+	return piece;
+}
+
+bool WorldBackupStore::restore(const QString &world, const QString &id, const QString &targetPath, QString &error, ProgressCallback progress)
+{
+	Snapshot snapshot;
+	if(!loadSnapshot(world, id, snapshot, error))
+	{
+		return false;
+	}
+
+	// put the world together next to the target, then swap them. Hidden, so world lists don't pick them up.
+	QFileInfo target(targetPath);
+	QString staging = FS::PathCombine(target.absolutePath(), "." + target.fileName() + ".restoring");
+	QString replaced = FS::PathCombine(target.absolutePath(), "." + target.fileName() + ".replaced");
+	FS::deletePath(staging);
+	FS::deletePath(replaced);
+	auto fail = [&](const QString &reason)
+	{
+		error = reason;
+		FS::deletePath(staging);
+		return false;
+	};
+	if(!FS::ensureFolderPathExists(staging))
+	{
+		return fail(QObject::tr("Couldn't create %1.").arg(staging));
+	}
+	for(auto &folder: snapshot.folders)
+	{
+		FS::ensureFolderPathExists(FS::PathCombine(staging, folder));
+	}
+
+	QHash<QString, std::shared_ptr<QFile>> openPacks;
+	qint64 done = 0;
+	for(auto &file: snapshot.files)
+	{
+		QFile output(FS::PathCombine(staging, file.path));
+		FS::ensureFilePathExists(output.fileName());
+		if(!output.open(QIODevice::WriteOnly))
+		{
+			return fail(QObject::tr("Couldn't create %1: %2").arg(output.fileName(), output.errorString()));
+		}
+		for(auto &hash: file.pieces)
+		{
+			QString pieceError;
+			auto piece = readPiece(hash, openPacks, pieceError);
+			if(piece.isNull())
+			{
+				return fail(pieceError);
+			}
+			if(output.write(piece) != piece.size())
+			{
+				return fail(QObject::tr("Couldn't write %1: %2").arg(output.fileName(), output.errorString()));
+			}
+			done += piece.size();
+			if(progress)
+			{
+				progress(done, snapshot.size);
+			}
+		}
+		// the next backup tells unchanged files apart by their size and time
+		if(!output.flush() || !output.setFileTime(QDateTime::fromMSecsSinceEpoch(file.mtime), QFileDevice::FileModificationTime))
+		{
+			qWarning() << "Couldn't restore the modification time of" << output.fileName();
+		}
+		output.close();
+	}
+	openPacks.clear();
+
+	if(target.exists() && !QDir().rename(targetPath, replaced))
+	{
+		return fail(QObject::tr("Couldn't move %1 out of the way.").arg(targetPath));
+	}
+	if(!QDir().rename(staging, targetPath))
+	{
+		QDir().rename(replaced, targetPath);
+		return fail(QObject::tr("Couldn't move the restored world to %1.").arg(targetPath));
+	}
+	FS::deletePath(replaced);
+	qDebug() << "Restored" << world << "from" << id;
+	return true;
+}
+
+bool WorldBackupStore::removeSnapshot(const QString &world, const QString &id, QString &error)
+{
+	QFile file(snapshotPath(world, id));
+	if(!file.remove())
+	{
+		error = QObject::tr("Couldn't remove the snapshot %1 of %2: %3").arg(id, world, file.errorString());
+		return false;
+	}
+	return true;
+}
+
+int WorldBackupStore::applyRetention(const QString &world, const WorldBackupRetention &policy, QString &error)
+{
+	auto ids = snapshotIds(world);
+	QList<QDateTime> created;
+	for(auto &id: ids)
+	{
+		created.append(snapshotTime(id));
+	}
+	auto keep = policy.select(created);
+	int removed = 0;
+	for(int i = 0; i < ids.size(); i++)
+	{
+		if(keep.contains(i))
+		{
+			continue;
+		}
+		if(!removeSnapshot(world, ids[i], error))
+		{
+			return -1;
+		}
+		removed++;
+	}
+	return removed;
+}
+
+bool WorldBackupStore::collectGarbage(QString &error, qint64 *freed)
+{
+	// everything any snapshot uses. If a snapshot can't be read, nothing can be dropped safely.
+	QSet<QByteArray> live;
+	QDir snapshots(FS::PathCombine(m_path, "snapshots"));
+	for(auto &world: snapshots.entryList(QDir::Dirs | QDir::NoDotAndDotDot))
+	{
+		for(auto &id: snapshotIds(world))
+		{
+			Snapshot snapshot;
+			if(!loadSnapshot(world, id, snapshot, error))
+			{
+				return false;
+			}
+			for(auto &file: snapshot.files)
+			{
+				for(auto &hash: file.pieces)
+				{
+					live.insert(hash);
+				}
+			}
+		}
+	}
+
+	qint64 dropped = 0;
+	for(auto &pack: m_packs.keys())
+	{
+		qint64 total = 0;
+		qint64 used = 0;
+		QList<QByteArray> keep;
+		for(auto &entry: m_packs.value(pack))
+		{
+			total += entry.second.size;
+			if(live.contains(entry.first) && m_index.value(entry.first).pack == pack)
+			{
+				used += entry.second.size;
+				keep.append(entry.first);
+			}
+		}
+		if(used * 2 >= total && used > 0)
+		{
+			continue;
+		}
+		if(used > 0)
+		{
+			// mostly garbage. Copy what's used to a new pack, which takes over before the old one goes away.
+			PackWriter writer(this);
+			QHash<QString, std::shared_ptr<QFile>> openPacks;
+			for(auto &hash: keep)
+			{
+				auto piece = readPiece(hash, openPacks, error);
+				if(piece.isNull() || !writer.append(hash, piece, error))
+				{
+					return false;
+				}
+			}
+			openPacks.clear();
+			if(!writer.finish(error))
+			{
+				return false;
+			}
+		}
+		removePack(pack);
+		dropped += total - used;
+	}
+	if(freed)
+	{
+		*freed = dropped;
+	}
+	qDebug() << "Dropped" << dropped << "bytes of unused world backup data";
+	return true;
+}
+
+qint64 WorldBackupStore::storedSize() const
+{
+	qint64 total = 0;
+	for(auto &entries: m_packs)
+	{
+		for(auto &entry: entries)
+		{
+			total += entry.second.size;
+		}
+	}
+	return total;
+}
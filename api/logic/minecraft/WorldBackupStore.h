@@ -0,0 +1,155 @@
+/* Copyright 2013-2017 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <functional>
+#include <memory>
+
+#include "multimc_logic_export.h"
+
+class QFile;
+class QLockFile;
+
+/// Which snapshots of a world to keep. A rule set to 0 keeps nothing by itself. The newest snapshot is always kept.
+struct MULTIMC_LOGIC_EXPORT WorldBackupRetention
+{
+	/// the newest snapshots
+	int keepLast = 10;
+	/// the newest snapshot of each of the last days that have one
+	int keepDaily = 7;
+	/// the newest snapshot of each of the last weeks that have one
+	int keepWeekly = 4;
+
+	/// indexes of the snapshots to keep, given their creation times, newest first
+	QSet<int> select(const QList<QDateTime> &created) const;
+};
+
+/**
+ * Incremental, deduplicated backups of worlds.
+ *
+ * Files are cut into pieces which are stored once, by their SHA-1, no matter how many snapshots or worlds use them.
+ * Region files are cut at the boundaries of the chunks they contain, so a backup only stores the chunks that changed
+ * since the last one. Other files are cut every megabyte. Files that have the same size and modification time as in
+ * the previous snapshot of the world are not even read again.
+ *
+ * Pieces are appended to pack files, one per backup, so a restore reads a few large files instead of many small ones.
+ * A pack is only indexed after it's complete, and a snapshot only written after its pack is indexed, so an
+ * interrupted backup leaves nothing but garbage behind.
+ *
+ * The world must not be in use while it's backed up or restored. The store is locked while open.
+ * Not thread safe.
+ */
+class MULTIMC_LOGIC_EXPORT WorldBackupStore
+{
+public:
+	struct File
+	{
+		/// relative to the world folder, with '/' as separator
+		QString path;
+		qint64 size = 0;
+		/// modification time, msecs since epoch
+		qint64 mtime = 0;
+		/// hashes of the pieces, in order
+		QList<QByteArray> pieces;
+	};
+
+	struct Snapshot
+	{
+		QString id;
+		/// folder name of the world
+		QString world;
+		QDateTime created;
+		/// bytes of the world
+		qint64 size = 0;
+		/// bytes this snapshot added to the store
+		qint64 stored = 0;
+		QList<File> files;
+		/// folders, so empty ones come back too
+		QStringList folders;
+	};
+
+	/// done, total
+	typedef std::function<void(qint64, qint64)> ProgressCallback;
+
+public:
+	explicit WorldBackupStore(const QString &path);
+	~WorldBackupStore();
+
+	/// lock the store and read the pack indexes. Leftovers of interrupted backups are removed.
+	bool open(QString &error);
+
+	/// folder names of the worlds with snapshots, including worlds that were deleted since
+	QStringList worlds() const;
+
+	/// ids of the snapshots of a world, newest first. Ids are the UTC creation times.
+	QStringList snapshotIds(const QString &world) const;
+	static QDateTime snapshotTime(const QString &id);
+
+	bool loadSnapshot(const QString &world, const QString &id, Snapshot &snapshot, QString &error) const;
+
+	/// snapshot the world folder at worldPath as world
+	bool backup(const QString &worldPath, const QString &world, Snapshot &snapshot, QString &error, ProgressCallback progress = nullptr);
+
+	/// replace the folder at targetPath with the snapshot. The folder stays as it was if this fails.
+	bool restore(const QString &world, const QString &id, const QString &targetPath, QString &error, ProgressCallback progress = nullptr);
+
+	bool removeSnapshot(const QString &world, const QString &id, QString &error);
+
+	/// remove the snapshots of a world the policy doesn't keep. Returns how many were removed, or -1.
+	int applyRetention(const QString &world, const WorldBackupRetention &policy, QString &error);
+
+	/// drop the pieces no snapshot uses anymore. Packs that are mostly unused get rewritten.
+	bool collectGarbage(QString &error, qint64 *freed = nullptr);
+
+	/// bytes of pieces in the store
+	qint64 storedSize() const;
+
+	/// where to cut a file into pieces, as (offset, length)
+	static QList<QPair<qint64, qint64>> pieces(const QString &fileName, const QByteArray &data);
+
+private:
+	struct Location
+	{
+		QString pack;
+		qint64 offset = 0;
+		qint64 size = 0;
+	};
+	class PackWriter;
+
+	QString packPath(const QString &pack, const QString &suffix) const;
+	QString snapshotPath(const QString &world, const QString &id) const;
+	bool readIndex(const QString &pack, QString &error);
+	bool writeIndex(const QString &pack, const QList<QPair<QByteArray, Location>> &entries, QString &error);
+	void removePack(const QString &pack);
+	bool saveSnapshot(const Snapshot &snapshot, QString &error);
+	QByteArray readPiece(const QByteArray &hash, QHash<QString, std::shared_ptr<QFile>> &openPacks, QString &error) const;
+
+private:
+	QString m_path;
+	std::unique_ptr<QLockFile> m_lock;
+	QHash<QByteArray, Location> m_index;
+	/// what each pack contains. A piece can be in more than one pack, m_index says which copy is used.
+	QHash<QString, QList<QPair<QByteArray, Location>>> m_packs;
+};
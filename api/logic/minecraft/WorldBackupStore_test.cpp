@@ -0,0 +1,212 @@
+#include <QTest>
+#include <QTemporaryDir>
+#include <QtEndian>
+#include "TestUtil.h"
+
+#include "minecraft/WorldBackupStore.h"
+#include "FileSystem.h"
+
+class WorldBackupStoreTest : public QObject
+{
+	Q_OBJECT
+private:
+	// a region file with the chunks in consecutive sectors after the header
+	QByteArray makeRegion(const QList<QByteArray> &chunks)
+	{
+		QByteArray header(8192, 0);
+		QByteArray body;
+		int sector = 2;
+		for(int i = 0; i < chunks.size(); i++)
+		{
+			int sectors = (chunks[i].size() + 4095) / 4096;
+			qToBigEndian<quint32>((sector << 8) | sectors, reinterpret_cast<uchar *>(header.data()) + i * 4);
+			QByteArray padded = chunks[i];
+			padded.append(QByteArray(sectors * 4096 - padded.size(), 0));
+			body.append(padded);
+			sector += sectors;
+		}
+		return header + body;
+	}
+
+	void writeFile(const QString &path, const QByteArray &data)
+	{
+		FS::ensureFilePathExists(path);
+		FS::write(path, data);
+	}
+
+	void makeWorld(const QString &path, const QByteArray &region, const QByteArray &level)
+	{
+		writeFile(FS::PathCombine(path, "region", "r.0.0.mca"), region);
+		writeFile(FS::PathCombine(path, "level.dat"), level);
+		FS::ensureFolderPathExists(FS::PathCombine(path, "data"));
+	}
+
+	void verifyWorld(const QString &path, const QByteArray &region, const QByteArray &level)
+	{
+		QCOMPARE(FS::read(FS::PathCombine(path, "region", "r.0.0.mca")), region);
+		QCOMPARE(FS::read(FS::PathCombine(path, "level.dat")), level);
+		QVERIFY(QFileInfo(FS::PathCombine(path, "data")).isDir());
+	}
+
+private
+slots:
+	void test_pieces()
+	{
+		auto region = makeRegion({QByteArray(100, 'a'), QByteArray(5000, 'b'), QByteArray(10, 'c')});
+		QList<QPair<qint64, qint64>> expected = {{0, 4096}, {4096, 4096}, {8192, 4096}, {12288, 8192}, {20480, 4096}};
+		QCOMPARE(WorldBackupStore::pieces("r.0.0.mca", region), expected);
+
+		// everything else is cut every megabyte
+		QCOMPARE(WorldBackupStore::pieces("r.0.0.mca.bak", region).size(), 1);
+		QCOMPARE(WorldBackupStore::pieces("level.dat", QByteArray(2500 * 1024, 'x')).size(), 3);
+		QCOMPARE(WorldBackupStore::pieces("level.dat", QByteArray()).size(), 0);
+
+		// garbage in the header still covers the whole file exactly once
+		QByteArray garbage = region;
+		garbage.replace(0, 8, QByteArray(8, char(0xFF)));
+		qint64 covered = 0;
+		for(auto &piece: WorldBackupStore::pieces("r.0.0.mca", garbage))
+		{
+			QCOMPARE(piece.first, covered);
+			covered += piece.second;
+		}
+		QCOMPARE(covered, qint64(garbage.size()));
+	}
+
+	void test_backupRestore()
+	{
+		QTemporaryDir tempDir;
+		QString worldPath = FS::PathCombine(tempDir.path(), "saves", "World");
+		QString storePath = FS::PathCombine(tempDir.path(), "world-backups");
+		auto region1 = makeRegion({QByteArray(4000, 'a'), QByteArray(4000, 'b'), QByteArray(4000, 'c')});
+		auto region2 = makeRegion({QByteArray(4000, 'a'), QByteArray(4000, 'B'), QByteArray(4000, 'c')});
+		makeWorld(worldPath, region1, "level one");
+		auto levelTime = QDateTime::currentDateTime().addDays(-3);
+		{
+			QFile level(FS::PathCombine(worldPath, "level.dat"));
+			QVERIFY(level.open(QIODevice::ReadWrite));
+			QVERIFY(level.setFileTime(levelTime, QFileDevice::FileModificationTime));
+		}
+
+		WorldBackupStore store(storePath);
+		QString error;
+		QVERIFY(store.open(error));
+		WorldBackupStore::Snapshot first;
+		QVERIFY2(store.backup(worldPath, "World", first, error), qPrintable(error));
+		QCOMPARE(first.size, qint64(region1.size() + 9));
+		QCOMPARE(first.stored, first.size);
+
+		// only the changed chunk and the changed file get stored
+		QTest::qSleep(5);
+		writeFile(FS::PathCombine(worldPath, "region", "r.0.0.mca"), region2);
+		writeFile(FS::PathCombine(worldPath, "level.dat"), "level two");
+		WorldBackupStore::Snapshot second;
+		QVERIFY2(store.backup(worldPath, "World", second, error), qPrintable(error));
+		QCOMPARE(second.stored, qint64(4096 + 9));
+		QCOMPARE(store.snapshotIds("World"), QStringList() << second.id << first.id);
+
+		// nothing changed, nothing gets stored
+		QTest::qSleep(5);
+		WorldBackupStore::Snapshot third;
+		QVERIFY(store.backup(worldPath, "World", third, error));
+		QCOMPARE(third.stored, qint64(0));
+
+		QVERIFY2(store.restore("World", first.id, worldPath, error), qPrintable(error));
+		verifyWorld(worldPath, region1, "level one");
+		QCOMPARE(QFileInfo(FS::PathCombine(worldPath, "level.dat")).lastModified().toMSecsSinceEpoch(), levelTime.toMSecsSinceEpoch());
+		QCOMPARE(QDir(FS::PathCombine(tempDir.path(), "saves")).entryList(QDir::AllEntries | QDir::Hidden | QDir::NoDotAndDotDot),
+				 QStringList() << "World");
+
+		// a deleted world can still be restored
+		FS::deletePath(worldPath);
+		QCOMPARE(store.worlds(), QStringList() << "World");
+		QVERIFY2(store.restore("World", second.id, worldPath, error), qPrintable(error));
+		verifyWorld(worldPath, region2, "level two");
+	}
+
+	void test_retention()
+	{
+		auto now = QDateTime::currentDateTime();
+		QList<QDateTime> created;
+		// two a day, for ten days
+		for(int i = 0; i < 20; i++)
+		{
+			created.append(now.addSecs(-i * 12 * 3600));
+		}
+		WorldBackupRetention policy;
+		policy.keepLast = 3;
+		policy.keepDaily = 0;
+		policy.keepWeekly = 0;
+		QCOMPARE(policy.select(created), (QSet<int>{0, 1, 2}));
+
+		policy.keepLast = 0;
+		QCOMPARE(policy.select(created), (QSet<int>{0}));
+		QCOMPARE(policy.select(QList<QDateTime>()), QSet<int>());
+
+		policy.keepDaily = 5;
+		auto keep = policy.select(created);
+		QCOMPARE(keep.size(), 5);
+		QSet<QDate> days;
+		for(auto i: keep)
+		{
+			days.insert(created[i].date());
+		}
+		QCOMPARE(days.size(), 5);
+	}
+
+	void test_garbage()
+	{
+		QTemporaryDir tempDir;
+		QString worldPath = FS::PathCombine(tempDir.path(), "saves", "World");
+		QString storePath = FS::PathCombine(tempDir.path(), "world-backups");
+		auto region1 = makeRegion({QByteArray(4000, 'a'), QByteArray(4000, 'b')});
+		auto region2 = makeRegion({QByteArray(4000, 'x'), QByteArray(4000, 'y')});
+		makeWorld(worldPath, region1, "level one");
+
+		QString error;
+		{
+			WorldBackupStore store(storePath);
+			QVERIFY(store.open(error));
+
+			// open stores are locked
+			WorldBackupStore other(storePath);
+			QVERIFY(!other.open(error));
+
+			WorldBackupStore::Snapshot first, second;
+			QVERIFY(store.backup(worldPath, "World", first, error));
+			QTest::qSleep(5);
+			makeWorld(worldPath, region2, "level two");
+			QVERIFY(store.backup(worldPath, "World", second, error));
+			QCOMPARE(store.storedSize(), first.stored + second.stored);
+
+			WorldBackupRetention policy;
+			policy.keepLast = 1;
+			policy.keepDaily = 0;
+			policy.keepWeekly = 0;
+			QCOMPARE(store.applyRetention("World", policy, error), 1);
+			qint64 freed = 0;
+			QVERIFY(store.collectGarbage(error, &freed));
+			// only the header sectors were shared. The first pack is mostly garbage now, so it gets rewritten.
+			QCOMPARE(freed, first.stored - 8192);
+			QCOMPARE(store.storedSize(), second.stored + 8192);
+		}
+
+		// leftovers of an interrupted backup are cleaned up
+		writeFile(FS::PathCombine(storePath, "packs", "interrupted.pack.part"), "junk");
+		writeFile(FS::PathCombine(storePath, "packs", "unindexed.pack"), "junk");
+		WorldBackupStore store(storePath);
+		QVERIFY(store.open(error));
+		QVERIFY(!QFile::exists(FS::PathCombine(storePath, "packs", "interrupted.pack.part")));
+		QVERIFY(!QFile::exists(FS::PathCombine(storePath, "packs", "unindexed.pack")));
+
+		FS::deletePath(worldPath);
+		auto ids = store.snapshotIds("World");
+		QCOMPARE(ids.size(), 1);
+		QVERIFY2(store.restore("World", ids.first(), worldPath, error), qPrintable(error));
+		verifyWorld(worldPath, region2, "level two");
+	}
+};
+
+QTEST_GUILESS_MAIN(WorldBackupStoreTest)
+
+#include "WorldBackupStore_test.moc"
@@ -0,0 +1,123 @@
+/* Copyright 2013-2017 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "WorldBackupTask.h"
+
+#include <QtConcurrentRun>
+#include <QMetaObject>
+#include <QDebug>
+
+WorldBackupTask::WorldBackupTask(const QString &storePath, const QString &worldPath, const QString &world,
+								 const WorldBackupRetention &retention, QObject *parent)
+	: Task(parent), m_storePath(storePath), m_worldPath(worldPath), m_world(world), m_retention(retention)
+{
+	connect(&m_watcher, &QFutureWatcher<QString>::finished, this, &WorldBackupTask::backupFinished);
+}
+
+WorldBackupTask::~WorldBackupTask()
+{
+	// the worker uses the task
+	m_watcher.waitForFinished();
+}
+
+void WorldBackupTask::executeTask()
+{
+	setStatus(tr("Backing up %1...").arg(m_world));
+	auto storePath = m_storePath;
+	auto worldPath = m_worldPath;
+	auto world = m_world;
+	auto retention = m_retention;
+	auto snapshot = &m_snapshot;
+	auto progress = [this](qint64 done, qint64 total)
+	{
+		QMetaObject::invokeMethod(this, "setProgress", Qt::QueuedConnection, Q_ARG(qint64, done), Q_ARG(qint64, total));
+	};
+	m_watcher.setFuture(QtConcurrent::run([storePath, worldPath, world, retention, snapshot, progress]() -> QString
+	{
+		QString error;
+		WorldBackupStore store(storePath);
+		if(!store.open(error) || !store.backup(worldPath, world, *snapshot, error, progress))
+		{
+			return error;
+		}
+		snapshot->files.clear();
+		// a failure to clean up doesn't make the backup any worse
+		int removed = store.applyRetention(world, retention, error);
+		if(removed < 0 || (removed > 0 && !store.collectGarbage(error)))
+		{
+			qWarning() << "Couldn't clean up old backups of" << world << ":" << error;
+		}
+		return QString();
+	}));
+}
+
+void WorldBackupTask::backupFinished()
+{
+	auto error = m_watcher.result();
+	if(!error.isEmpty())
+	{
+		emitFailed(error);
+		return;
+	}
+	emitSucceeded();
+}
+
+WorldRestoreTask::WorldRestoreTask(const QString &storePath, const QString &world, const QString &id, const QString &worldPath,
+								   QObject *parent)
+	: Task(parent), m_storePath(storePath), m_world(world), m_id(id), m_worldPath(worldPath)
+{
+	connect(&m_watcher, &QFutureWatcher<QString>::finished, this, &WorldRestoreTask::restoreFinished);
+}
+
+WorldRestoreTask::~WorldRestoreTask()
+{
+	// the worker uses the task
+	m_watcher.waitForFinished();
+}
+
+void WorldRestoreTask::executeTask()
+{
+	setStatus(tr("Restoring %1...").arg(m_world));
+	auto storePath = m_storePath;
+	auto worldPath = m_worldPath;
+	auto world = m_world;
+	auto id = m_id;
+	auto progress = [this](qint64 done, qint64 total)
+	{
+		QMetaObject::invokeMethod(this, "setProgress", Qt::QueuedConnection, Q_ARG(qint64, done), Q_ARG(qint64, total));
+	};
+	m_watcher.setFuture(QtConcurrent::run([storePath, worldPath, world, id, progress]() -> QString
+	{
+		QString error;
+		WorldBackupStore store(storePath);
+		if(!store.open(error) || !store.restore(world, id, worldPath, error, progress))
+		{
+			return error;
+		}
+		return QString();
+	}));
+}
+
+void WorldRestoreTask::restoreFinished()
+{
+	auto error = m_watcher.result();
+	if(!error.isEmpty())
+	{
+		emitFailed(error);
+		return;
+	}
+	emitSucceeded();
+}
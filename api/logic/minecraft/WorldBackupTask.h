@@ -0,0 +1,76 @@
+/* Copyright 2013-2017 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include "tasks/Task.h"
+#include "WorldBackupStore.h"
+#include <QFutureWatcher>
+
+#include "multimc_logic_export.h"
+
+/// Snapshots a world into a backup store, then drops the snapshots the retention policy doesn't keep.
+class MULTIMC_LOGIC_EXPORT WorldBackupTask : public Task
+{
+	Q_OBJECT
+public:
+	explicit WorldBackupTask(const QString &storePath, const QString &worldPath, const QString &world,
+							 const WorldBackupRetention &retention, QObject *parent = 0);
+	virtual ~WorldBackupTask();
+
+	/// the snapshot that was made, without its files
+	WorldBackupStore::Snapshot snapshot() const
+	{
+		return m_snapshot;
+	}
+
+protected:
+	void executeTask() override;
+
+private slots:
+	void backupFinished();
+
+private:
+	QString m_storePath;
+	QString m_worldPath;
+	QString m_world;
+	WorldBackupRetention m_retention;
+	WorldBackupStore::Snapshot m_snapshot;
+	QFutureWatcher<QString> m_watcher;
+};
+
+/// Replaces a world folder with one of its snapshots.
+class MULTIMC_LOGIC_EXPORT WorldRestoreTask : public Task
+{
+	Q_OBJECT
+public:
+	explicit WorldRestoreTask(const QString &storePath, const QString &world, const QString &id, const QString &worldPath,
+							  QObject *parent = 0);
+	virtual ~WorldRestoreTask();
+
+protected:
+	void executeTask() override;
+
+private slots:
+	void restoreFinished();
+
+private:
+	QString m_storePath;
+	QString m_world;
+	QString m_id;
+	QString m_worldPath;
+	QFutureWatcher<QString> m_watcher;
+};
@@ -15,6 +15,7 @@
 
 #include "WorldList.h"
 #include <FileSystem.h>
+#include <MMCStrings.h>
 #include <QMimeData>
 #include <QUrl>
 #include <QUuid>
@@ -138,7 +139,18 @@ bool WorldList::deleteWorlds(int first, int last)
 
 int WorldList::columnCount(const QModelIndex &parent) const
 {
-	return 2;
+	return 3;
+}
+
+void WorldList::setWorldSizes(const QMap<QString, qint64> &sizes)
+{
+	if(sizes == m_worldSizes)
+		return;
+	m_worldSizes = sizes;
+	if(worlds.size())
+	{
+		emit dataChanged(index(0, SizeColumn), index(worlds.size() - 1, SizeColumn));
+	}
 }
 
 QVariant WorldList::data(const QModelIndex &index, int role) const
@@ -164,6 +176,32 @@ QVariant WorldList::data(const QModelIndex &index, int role) const
 		case LastPlayedColumn:
 			return world.lastPlayed();
 
+		case SizeColumn:
+		{
+			auto size = m_worldSizes.value(world.folderName(), -1);
+			if(size < 0)
+				return QVariant();
+			return Strings::humanReadableSize(size);
+		}
+
+		default:
+			return QVariant();
+		}
+
+	case Qt::TextAlignmentRole:
+		if(column == SizeColumn)
+			return int(Qt::AlignRight | Qt::AlignVCenter);
+		return QVariant();
+
+	case SortRole:
+		switch (column)
+		{
+		case NameColumn:
+			return world.name();
+		case LastPlayedColumn:
+			return world.lastPlayed();
+		case SizeColumn:
+			return m_worldSizes.value(world.folderName(), -1);
 		default:
 			return QVariant();
 		}
@@ -192,6 +230,10 @@ QVariant WorldList::data(const QModelIndex &index, int role) const
 	{
 		return world.lastPlayed();
 	}
+	case SizeRole:
+	{
+		return m_worldSizes.value(world.folderName(), -1);
+	}
 	default:
 		return QVariant();
 	}
@@ -208,6 +250,8 @@ QVariant WorldList::headerData(int section, Qt::Orientation orientation, int rol
 			return tr("Name");
 		case LastPlayedColumn:
 			return tr("Last Played");
+		case SizeColumn:
+			return tr("Size");
 		default:
 			return QVariant();
 		}
@@ -219,6 +263,8 @@ QVariant WorldList::headerData(int section, Qt::Orientation orientation, int rol
 			return tr("The name of the world.");
 		case LastPlayedColumn:
 			return tr("Date and time the world was last played.");
+		case SizeColumn:
+			return tr("Space the world takes up on disk, as of the last disk usage scan.");
 		default:
 			return QVariant();
 		}
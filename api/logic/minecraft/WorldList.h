@@ -18,6 +18,7 @@
 #include <QList>
 #include <QString>
 #include <QDir>
+#include <QMap>
 #include <QAbstractListModel>
 #include <QMimeData>
 #include "minecraft/World.h"
@@ -33,7 +34,8 @@ public:
 	enum Columns
 	{
 		NameColumn,
-		LastPlayedColumn
+		LastPlayedColumn,
+		SizeColumn
 	};
 
 	enum Roles
@@ -42,7 +44,10 @@ public:
 		FolderRole,
 		SeedRole,
 		NameRole,
-		LastPlayedRole
+		LastPlayedRole,
+		SizeRole,
+		/// the value to sort each column by
+		SortRole
 	};
 
 	WorldList(const QString &dir);
@@ -111,6 +116,19 @@ public:
 		return worlds;
 	}
 
+	/// where the backups of the worlds are kept, see WorldBackupStore
+	QString backupDir() const
+	{
+		return m_backupDir;
+	}
+	void setBackupDir(const QString &dir)
+	{
+		m_backupDir = dir;
+	}
+
+	/// set the sizes of the worlds in bytes, by folder name. They come from the disk usage scan.
+	void setWorldSizes(const QMap<QString, qint64> &sizes);
+
 private slots:
 	void directoryChanged(QString path);
 
@@ -122,4 +140,6 @@ protected:
 	bool is_watching;
 	QDir m_dir;
 	QList<World> worlds;
+	QMap<QString, qint64> m_worldSizes;
+	QString m_backupDir;
 };
@@ -22,15 +22,261 @@
 #include <QDateTime>
 #include <QDir>
 #include <QDebug>
+#include <QMutex>
+#include <QSaveFile>
+#include <QWaitCondition>
+#include <QThreadPool>
+#include <QtConcurrentRun>
+
+#include "xz.h"
+#include "unpack200.h"
+#include <mutex>
+#include <stdexcept>
+#include <unistd.h>
+
+/**
+ * Compressed data on its way from the network (GUI thread) to the unpacking worker.
+ * The producer never blocks, the worker waits for data as needed.
+ */
+struct ForgeXzStream
+{
+	void push(const QByteArray &data)
+	{
+		QMutexLocker locker(&mutex);
+		pending.append(data);
+		dataReady.wakeAll();
+	}
+
+	void close(bool success)
+	{
+		QMutexLocker locker(&mutex);
+		closed = true;
+		failed = !success;
+		dataReady.wakeAll();
+	}
+
+	/// Take all the available data, waiting for some if there is none. Empty means there's no more.
+	QByteArray take()
+	{
+		QMutexLocker locker(&mutex);
+		while (pending.isEmpty() && !closed)
+		{
+			dataReady.wait(&mutex);
+		}
+		if (failed)
+		{
+			return QByteArray();
+		}
+		QByteArray data;
+		data.swap(pending);
+		return data;
+	}
+
+	bool hasFailed()
+	{
+		QMutexLocker locker(&mutex);
+		return failed;
+	}
+
+	QMutex mutex;
+	QWaitCondition dataReady;
+	QByteArray pending;
+	bool closed = false;
+	bool failed = false;
+
+	// worker side: the xz decoder and the compressed chunk it's working on
+	struct xz_dec *decoder = nullptr;
+	struct xz_buf buf;
+	QByteArray chunk;
+	bool xzEnded = false;
+	QString error;
+};
+
+namespace {
+// Called by unpack200 on the worker thread - decompresses as much as it asks for, waiting for the network as needed.
+int64_t readDecompressed(void *context, void *out, int64_t minlen, int64_t maxlen)
+{
+	auto stream = (ForgeXzStream *) context;
+	int64_t numread = 0;
+	while (numread < minlen && !stream->xzEnded)
+	{
+		if (stream->buf.in_pos == stream->buf.in_size)
+		{
+			stream->chunk = stream->take();
+			if (stream->chunk.isEmpty())
+			{
+				if (stream->hasFailed())
+				{
+					stream->error = "Download failed";
+				}
+				break;
+			}
+			stream->buf.in = (const uint8_t *) stream->chunk.constData();
+			stream->buf.in_pos = 0;
+			stream->buf.in_size = stream->chunk.size();
+		}
+		stream->buf.out = (uint8_t *) out + numread;
+		stream->buf.out_pos = 0;
+		stream->buf.out_size = maxlen - numread;
+
+		auto ret = xz_dec_run(stream->decoder, &stream->buf);
+		numread += stream->buf.out_pos;
+
+		switch (ret)
+		{
+		case XZ_OK:
+		// unsupported check. this is OK
+		case XZ_UNSUPPORTED_CHECK:
+			continue;
+
+		case XZ_STREAM_END:
+			stream->xzEnded = true;
+			break;
+
+		case XZ_MEM_ERROR:
+			stream->error = "Memory allocation failed";
+			return numread;
+
+		case XZ_MEMLIMIT_ERROR:
+			stream->error = "Memory usage limit reached";
+			return numread;
+
+		case XZ_FORMAT_ERROR:
+			stream->error = "Not a .xz file";
+			return numread;
+
+		case XZ_OPTIONS_ERROR:
+			stream->error = "Unsupported options in the .xz headers";
+			return numread;
+
+		case XZ_DATA_ERROR:
+		case XZ_BUF_ERROR:
+			stream->error = "File is corrupt";
+			return numread;
+
+		default:
+			stream->error = "Bug!";
+			return numread;
+		}
+	}
+	return numread;
+}
+
+// Runs on the unpacking thread pool: decompress, unpack and hash the jar.
+ForgeXzDownload::UnpackResult unpackStream(std::shared_ptr<ForgeXzStream> stream, QString targetPath)
+{
+	ForgeXzDownload::UnpackResult result;
+
+	// wait for the download to actually produce something before touching the target file
+	stream->chunk = stream->take();
+	if (stream->chunk.isEmpty())
+	{
+		result.error = "Nothing was downloaded";
+		return result;
+	}
+	stream->buf.in = (const uint8_t *) stream->chunk.constData();
+	stream->buf.in_pos = 0;
+	stream->buf.in_size = stream->chunk.size();
+
+	// the CRC tables are global, filling them while another worker reads them is a race
+	static std::once_flag crcTablesReady;
+	std::call_once(crcTablesReady, []()
+	{
+		xz_crc32_init();
+		xz_crc64_init();
+	});
+	stream->decoder = xz_dec_init(XZ_DYNALLOC, 1 << 26);
+	if (stream->decoder == nullptr)
+	{
+		result.error = "Cannot initialize xz decoder";
+		return result;
+	}
+
+	// the cached jar stays as it is until the new one is complete. Dropping the QSaveFile without a commit cleans up.
+	QSaveFile qfile_out(targetPath);
+	if(!qfile_out.open(QIODevice::WriteOnly))
+	{
+		xz_dec_end(stream->decoder);
+		result.error = "Error opening " + qfile_out.fileName();
+		return result;
+	}
+	int handle_out = qfile_out.handle();
+	int handle_out_dup = handle_out == -1 ? -1 : dup (handle_out);
+	FILE *file_out = handle_out_dup == -1 ? nullptr : fdopen (handle_out_dup, "wb");
+	if(!file_out)
+	{
+		xz_dec_end(stream->decoder);
+		result.error = "Error opening " + qfile_out.fileName();
+		return result;
+	}
+
+	try
+	{
+		// NOTE: this takes ownership of the output FILE pointer. That's why we duplicate it above.
+		unpack_200_stream(readDecompressed, stream.get(), file_out);
+	}
+	catch (std::runtime_error &err)
+	{
+		result.error = stream->error.isEmpty() ? QString(err.what()) : stream->error;
+	}
+	xz_dec_end(stream->decoder);
+	stream->decoder = nullptr;
+
+	if (result.error.isEmpty() && !stream->xzEnded)
+	{
+		result.error = stream->error.isEmpty() ? "Truncated download" : stream->error;
+	}
+	if (!result.error.isEmpty())
+	{
+		qfile_out.cancelWriting();
+		return result;
+	}
+	if (!qfile_out.commit())
+	{
+		result.error = "Cannot replace " + targetPath + ": " + qfile_out.errorString();
+		return result;
+	}
+
+	QFile jar_file(targetPath);
+	if (!jar_file.open(QIODevice::ReadOnly))
+	{
+		result.error = "Cannot read the unpacked jar";
+		return result;
+	}
+	QCryptographicHash hash(QCryptographicHash::Md5);
+	hash.addData(&jar_file);
+	result.md5 = hash.result().toHex();
+	result.success = true;
+	return result;
+}
+
+// Unpacking waits on the network most of the time, so it gets its own threads instead of blocking the global pool.
+QThreadPool &unpackPool()
+{
+	static QThreadPool pool;
+	// NetJob runs 6 downloads at a time
+	pool.setMaxThreadCount(6);
+	return pool;
+}
+}
 
 ForgeXzDownload::ForgeXzDownload(QString relative_path, MetaEntryPtr entry) : NetAction()
 {
 	m_entry = entry;
 	m_target_path = entry->getFullPath();
-	m_pack200_xz_file.setFileTemplate("./dl_temp.XXXXXX");
 	m_status = Job_NotStarted;
 	m_url_path = relative_path;
 	m_url = "http://files.minecraftforge.net/maven/" + m_url_path + ".pack.xz";
+	connect(&m_unpackWatcher, &QFutureWatcher<UnpackResult>::finished, this, &ForgeXzDownload::unpackFinished);
+}
+
+ForgeXzDownload::~ForgeXzDownload()
+{
+	// make sure the worker doesn't wait for data that will never come
+	if (m_stream)
+	{
+		m_stream->close(false);
+	}
 }
 
 void ForgeXzDownload::start()
@@ -56,6 +302,12 @@ void ForgeXzDownload::start()
 		return;
 	}
 
+	// set up the pipeline: network -> xz -> pack200 -> jar
+	m_downloadDone = false;
+	m_unpackDone = false;
+	m_stream = std::make_shared<ForgeXzStream>();
+	m_unpackWatcher.setFuture(QtConcurrent::run(&unpackPool(), unpackStream, m_stream, m_target_path));
+
 	qDebug() << "Downloading " << m_url.toString();
 	QNetworkRequest request(m_url);
 	request.setRawHeader(QString("If-None-Match").toLatin1(), m_entry->getETag().toLatin1());
@@ -100,274 +352,56 @@ void ForgeXzDownload::failAndTryNextMirror()
 
 void ForgeXzDownload::downloadFinished()
 {
-	// if the download succeeded
-	if (m_status != Job_Failed && m_status != Job_Aborted)
-	{
-		// nothing went wrong...
-		m_status = Job_Finished;
-		if (m_pack200_xz_file.isOpen())
-		{
-			// we actually downloaded something! process and isntall it
-			decompressAndInstall();
-			return;
-		}
-		else
-		{
-			// something bad happened -- on the local machine!
-			m_status = Job_Failed;
-			m_pack200_xz_file.remove();
-			m_reply.reset();
-			emit failed(m_index_within_job);
-			return;
-		}
-	}
-	else if(m_status == Job_Aborted)
-	{
-		m_pack200_xz_file.remove();
-		m_reply.reset();
-		emit failed(m_index_within_job);
-		emit aborted(m_index_within_job);
-		return;
-	}
-	// else the download failed
-	else
-	{
-		m_status = Job_Failed;
-		m_pack200_xz_file.close();
-		m_pack200_xz_file.remove();
-		m_reply.reset();
-		failAndTryNextMirror();
-		return;
-	}
+	m_downloadDone = true;
+	// let the worker know there's nothing more to come, and whether what it got is any good
+	m_stream->close(m_status != Job_Failed && m_status != Job_Aborted);
+	finishIfDone();
 }
 
 void ForgeXzDownload::downloadReadyRead()
 {
-
-	if (!m_pack200_xz_file.isOpen())
-	{
-		if (!m_pack200_xz_file.open())
-		{
-			/*
-			* Can't open the file... the job failed
-			*/
-			m_reply->abort();
-			emit failed(m_index_within_job);
-			return;
-		}
-	}
-	m_pack200_xz_file.write(m_reply->readAll());
+	m_stream->push(m_reply->readAll());
 }
 
-#include "xz.h"
-#include "unpack200.h"
-#include <stdexcept>
-#include <unistd.h>
-
-const size_t buffer_size = 8196;
-
-// NOTE: once this gets here, it can't be aborted anymore. we don't care.
-void ForgeXzDownload::decompressAndInstall()
+void ForgeXzDownload::unpackFinished()
 {
-	// rewind the downloaded temp file
-	m_pack200_xz_file.seek(0);
-	// de-xz'd file
-	QTemporaryFile pack200_file("./dl_temp.XXXXXX");
-	pack200_file.open();
-
-	bool xz_success = false;
-	// first, de-xz
+	m_unpackDone = true;
+	// the unpacking failed early, no point in downloading the rest
+	if (!m_downloadDone && m_reply && !m_unpackWatcher.result().success)
 	{
-		uint8_t in[buffer_size];
-		uint8_t out[buffer_size];
-		struct xz_buf b;
-		struct xz_dec *s;
-		enum xz_ret ret;
-		xz_crc32_init();
-		xz_crc64_init();
-		s = xz_dec_init(XZ_DYNALLOC, 1 << 26);
-		if (s == nullptr)
-		{
-			xz_dec_end(s);
-			failAndTryNextMirror();
-			return;
-		}
-		b.in = in;
-		b.in_pos = 0;
-		b.in_size = 0;
-		b.out = out;
-		b.out_pos = 0;
-		b.out_size = buffer_size;
-		while (!xz_success)
-		{
-			if (b.in_pos == b.in_size)
-			{
-				b.in_size = m_pack200_xz_file.read((char *)in, sizeof(in));
-				b.in_pos = 0;
-			}
-
-			ret = xz_dec_run(s, &b);
-
-			if (b.out_pos == sizeof(out))
-			{
-				auto wresult = pack200_file.write((char *)out, b.out_pos);
-				if (wresult < 0 || size_t(wresult) != b.out_pos)
-				{
-					// msg = "Write error\n";
-					xz_dec_end(s);
-					failAndTryNextMirror();
-					return;
-				}
-
-				b.out_pos = 0;
-			}
-
-			if (ret == XZ_OK)
-				continue;
-
-			if (ret == XZ_UNSUPPORTED_CHECK)
-			{
-				// unsupported check. this is OK, but we should log this
-				continue;
-			}
-
-			auto wresult = pack200_file.write((char *)out, b.out_pos);
-			if (wresult < 0 || size_t(wresult) != b.out_pos)
-			{
-				// write error
-				pack200_file.close();
-				xz_dec_end(s);
-				return;
-			}
-
-			switch (ret)
-			{
-			case XZ_STREAM_END:
-				xz_dec_end(s);
-				xz_success = true;
-				break;
-
-			case XZ_MEM_ERROR:
-				qCritical() << "Memory allocation failed\n";
-				xz_dec_end(s);
-				failAndTryNextMirror();
-				return;
-
-			case XZ_MEMLIMIT_ERROR:
-				qCritical() << "Memory usage limit reached\n";
-				xz_dec_end(s);
-				failAndTryNextMirror();
-				return;
-
-			case XZ_FORMAT_ERROR:
-				qCritical() << "Not a .xz file\n";
-				xz_dec_end(s);
-				failAndTryNextMirror();
-				return;
-
-			case XZ_OPTIONS_ERROR:
-				qCritical() << "Unsupported options in the .xz headers\n";
-				xz_dec_end(s);
-				failAndTryNextMirror();
-				return;
-
-			case XZ_DATA_ERROR:
-			case XZ_BUF_ERROR:
-				qCritical() << "File is corrupt\n";
-				xz_dec_end(s);
-				failAndTryNextMirror();
-				return;
-
-			default:
-				qCritical() << "Bug!\n";
-				xz_dec_end(s);
-				failAndTryNextMirror();
-				return;
-			}
-		}
-	}
-	m_pack200_xz_file.remove();
-
-	// revert pack200
-	pack200_file.seek(0);
-	int handle_in = pack200_file.handle();
-	// FIXME: dispose of file handles, pointers and the like. Ideally wrap in objects.
-	if(handle_in == -1)
-	{
-		qCritical() << "Error reopening " << pack200_file.fileName();
-		failAndTryNextMirror();
-		return;
-	}
-	int handle_in_dup = dup (handle_in);
-	if(handle_in_dup == -1)
-	{
-		qCritical() << "Error reopening " << pack200_file.fileName();
-		failAndTryNextMirror();
-		return;
-	}
-	FILE *file_in = fdopen (handle_in_dup, "rb");
-	if(!file_in)
-	{
-		qCritical() << "Error reopening " << pack200_file.fileName();
-		failAndTryNextMirror();
-		return;
-	}
-	QFile qfile_out(m_target_path);
-	if(!qfile_out.open(QIODevice::WriteOnly))
-	{
-		qCritical() << "Error opening " << qfile_out.fileName();
-		failAndTryNextMirror();
-		return;
-	}
-	int handle_out = qfile_out.handle();
-	if(handle_out == -1)
-	{
-		qCritical() << "Error opening " << qfile_out.fileName();
-		failAndTryNextMirror();
+		m_status = Job_Failed;
+		m_reply->abort();
 		return;
 	}
-	int handle_out_dup = dup (handle_out);
-	if(handle_out_dup == -1)
+	finishIfDone();
+}
+
+void ForgeXzDownload::finishIfDone()
+{
+	if (!m_downloadDone || !m_unpackDone)
 	{
-		qCritical() << "Error reopening " << qfile_out.fileName();
-		failAndTryNextMirror();
 		return;
 	}
-	FILE *file_out = fdopen (handle_out_dup, "wb");
-	if(!file_out)
+	auto result = m_unpackWatcher.result();
+	m_stream.reset();
+
+	if (m_abortRequested)
 	{
-		qCritical() << "Error opening " << qfile_out.fileName();
-		failAndTryNextMirror();
+		m_reply.reset();
+		emit failed(m_index_within_job);
+		emit aborted(m_index_within_job);
 		return;
 	}
-	try
+	if (m_status == Job_Failed || m_status == Job_Aborted || !result.success)
 	{
-		// NOTE: this takes ownership of both FILE pointers. That's why we duplicate them above.
-		unpack_200(file_in, file_out);
-	}
-	catch (std::runtime_error &err)
-	{
-		m_status = Job_Failed;
-		qCritical() << "Error unpacking " << pack200_file.fileName() << " : " << err.what();
-		QFile f(m_target_path);
-		if (f.exists())
-			f.remove();
+		qCritical() << "Error unpacking " << m_url.toString() << " : " << result.error;
+		m_reply.reset();
 		failAndTryNextMirror();
 		return;
 	}
-	pack200_file.remove();
-
-	QFile jar_file(m_target_path);
 
-	if (!jar_file.open(QIODevice::ReadOnly))
-	{
-		jar_file.remove();
-		failAndTryNextMirror();
-		return;
-	}
-	auto hash = QCryptographicHash::hash(jar_file.readAll(), QCryptographicHash::Md5);
-	m_entry->setMD5Sum(hash.toHex().constData());
-	jar_file.close();
+	m_status = Job_Finished;
+	m_entry->setMD5Sum(result.md5.constData());
 
 	QFileInfo output_file_info(m_target_path);
 	m_entry->setETag(m_reply->rawHeader("ETag").constData());
@@ -381,6 +415,7 @@ void ForgeXzDownload::decompressAndInstall()
 
 bool ForgeXzDownload::abort()
 {
+	m_abortRequested = true;
 	if(m_reply)
 		m_reply->abort();
 	m_status = Job_Aborted;
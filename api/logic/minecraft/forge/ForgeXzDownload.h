@@ -18,19 +18,32 @@
 #include "net/NetAction.h"
 #include "net/HttpMetaCache.h"
 #include <QFile>
-#include <QTemporaryFile>
+#include <QFutureWatcher>
 
 typedef std::shared_ptr<class ForgeXzDownload> ForgeXzDownloadPtr;
+struct ForgeXzStream;
 
+/**
+ * Downloads a .pack.xz library from the Forge maven and turns it into a jar.
+ *
+ * The downloaded data is streamed into a worker thread that decompresses and unpacks it while the download is still running.
+ */
 class ForgeXzDownload : public NetAction
 {
 	Q_OBJECT
+public:
+	/// result of the worker thread
+	struct UnpackResult
+	{
+		bool success = false;
+		QString error;
+		QByteArray md5;
+	};
+
 public:
 	MetaEntryPtr m_entry;
 	/// if saving to file, use the one specified in this string
 	QString m_target_path;
-	/// this is the output file, if any
-	QTemporaryFile m_pack200_xz_file;
 	/// path relative to the mirror base
 	QString m_url_path;
 
@@ -40,7 +53,7 @@ public:
 	{
 		return ForgeXzDownloadPtr(new ForgeXzDownload(relative_path, entry));
 	}
-	virtual ~ForgeXzDownload(){};
+	virtual ~ForgeXzDownload();
 	bool canAbort() override;
 
 protected
@@ -49,6 +62,7 @@ slots:
 	void downloadError(QNetworkReply::NetworkError error) override;
 	void downloadFinished() override;
 	void downloadReadyRead() override;
+	void unpackFinished();
 
 public
 slots:
@@ -56,6 +70,13 @@ slots:
 	bool abort() override;
 
 private:
-	void decompressAndInstall();
+	void finishIfDone();
 	void failAndTryNextMirror();
+
+private:
+	std::shared_ptr<ForgeXzStream> m_stream;
+	QFutureWatcher<UnpackResult> m_unpackWatcher;
+	bool m_downloadDone = false;
+	bool m_unpackDone = false;
+	bool m_abortRequested = false;
 };
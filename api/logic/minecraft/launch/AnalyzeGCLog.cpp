@@ -0,0 +1,61 @@
+/* Copyright 2013-2017 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "AnalyzeGCLog.h"
+#include "launch/LaunchTask.h"
+#include "java/GCLog.h"
+#include "FileSystem.h"
+
+#include <QFile>
+
+AnalyzeGCLog::AnalyzeGCLog(LaunchTask *parent) : LaunchStep(parent)
+{
+}
+
+void AnalyzeGCLog::executeTask()
+{
+	auto path = GCLog::currentLogPath(m_parent->instance()->instanceRoot());
+	// a log left behind by a session we didn't see end would be mistaken for this one
+	if(QFile::exists(path))
+	{
+		GCLog::archiveCurrentLog(m_parent->instance()->instanceRoot());
+	}
+	if(!FS::ensureFilePathExists(path))
+	{
+		emit logLine(tr("Couldn't create the folder for the GC log."), MessageLevel::Warning);
+	}
+	emitSucceeded();
+}
+
+void AnalyzeGCLog::finalize()
+{
+	auto summary = GCLog::archiveCurrentLog(m_parent->instance()->instanceRoot());
+	if(!summary.isValid())
+	{
+		return;
+	}
+	auto text = tr("Garbage collection: %1 collections (%2 full) in %3 s, average pause %4 ms, longest %5 ms.\n")
+		.arg(summary.collections)
+		.arg(summary.fullCollections)
+		.arg(summary.uptime, 0, 'f', 1)
+		.arg(summary.averagePauseMs(), 0, 'f', 1)
+		.arg(summary.maxPauseMs, 0, 'f', 1);
+	text += tr("Allocation rate %1 MB/s, peak live heap %2 MB of %3 MB. Suggested maximum memory allocation: %4 MB.\n")
+		.arg(summary.allocationRateMiBs(), 0, 'f', 1)
+		.arg(summary.peakLiveKiB / 1024)
+		.arg(summary.peakHeapKiB / 1024)
+		.arg(summary.suggestedMaxMemory());
+	emit logLine(text, MessageLevel::MultiMC);
+}
@@ -0,0 +1,38 @@
+/* Copyright 2013-2017 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "CreateLaunchPlan.h"
+#include "minecraft/MinecraftInstance.h"
+#include "launch/LaunchTask.h"
+
+CreateLaunchPlan::CreateLaunchPlan(LaunchTask* parent, AuthSessionPtr session): LaunchStep(parent), m_session(session)
+{
+}
+
+void CreateLaunchPlan::executeTask()
+{
+	auto instance = m_parent->instance();
+	std::shared_ptr<MinecraftInstance> minecraftInstance = std::dynamic_pointer_cast<MinecraftInstance>(instance);
+	auto plan = minecraftInstance->createLaunchPlan(m_session);
+	if(!plan)
+	{
+		auto reason = tr("The instance has no version profile to launch.");
+		emit logLine(reason, MessageLevel::Fatal);
+		emitFailed(reason);
+		return;
+	}
+	m_parent->setLaunchPlan(plan);
+	emitSucceeded();
+}
@@ -0,0 +1,34 @@
+/* Copyright 2013-2017 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <launch/LaunchStep.h>
+#include <minecraft/auth/AuthSession.h>
+
+// Works out the launch plan once the profile and its files are final. The steps after it use the plan.
+class CreateLaunchPlan: public LaunchStep
+{
+	Q_OBJECT
+public:
+	explicit CreateLaunchPlan(LaunchTask *parent, AuthSessionPtr session);
+	virtual void executeTask();
+	virtual bool canAbort() const
+	{
+		return false;
+	}
+private:
+	AuthSessionPtr m_session;
+};
@@ -30,11 +30,13 @@ void DirectJavaLaunch::executeTask()
 {
 	auto instance = m_parent->instance();
 	std::shared_ptr<MinecraftInstance> minecraftInstance = std::dynamic_pointer_cast<MinecraftInstance>(instance);
-	QStringList args = minecraftInstance->javaArguments();
+	auto plan = m_parent->launchPlan();
+	QStringList args = plan->javaArguments;
+	args.append(m_parent->extraJavaArguments());
 
-	args.append("-Djava.library.path=" + minecraftInstance->getNativePath());
+	args.append("-Djava.library.path=" + plan->nativePath);
 
-	auto classPathEntries = minecraftInstance->getClassPath();
+	auto classPathEntries = plan->classPath;
 	args.append("-cp");
 	QString classpath;
 #ifdef Q_OS_WIN32
@@ -43,20 +45,24 @@ void DirectJavaLaunch::executeTask()
 	classpath = classPathEntries.join(':');
 #endif
 	args.append(classpath);
-	args.append(minecraftInstance->getMainClass());
+	args.append(plan->mainClass);
 
 	QString allArgs = args.join(", ");
 	emit logLine("Java Arguments:\n[" + m_parent->censorPrivateInfo(allArgs) + "]\n\n", MessageLevel::MultiMC);
 
 	auto javaPath = FS::ResolveExecutable(instance->settings()->get("JavaPath").toString());
 
-	m_process.setProcessEnvironment(instance->createEnvironment());
+	m_process.setProcessEnvironment(plan->environment);
 
 	// make detachable - this will keep the process running even if the object is destroyed
 	m_process.setDetachable(true);
 
-	auto mcArgs = minecraftInstance->processMinecraftArgs(m_session);
-	args.append(mcArgs);
+	args.append(plan->minecraftArguments);
+
+	for(auto &warning: m_process.setLimits(minecraftInstance->processLimits(), instance->id()))
+	{
+		emit logLine(warning + "\n", MessageLevel::Warning);
+	}
 
 	QString wrapperCommandStr = instance->getWrapperCommand().trimmed();
 	if(!wrapperCommandStr.isEmpty())
@@ -70,13 +70,14 @@ void ExtractNatives::executeTask()
 {
 	auto instance = m_parent->instance();
 	std::shared_ptr<MinecraftInstance> minecraftInstance = std::dynamic_pointer_cast<MinecraftInstance>(instance);
-	auto toExtract = minecraftInstance->getNativeJars();
+	auto plan = m_parent->launchPlan();
+	auto toExtract = plan->nativeJars;
 	if(toExtract.isEmpty())
 	{
 		emitSucceeded();
 		return;
 	}
-	auto outputPath  = minecraftInstance->getNativePath();
+	auto outputPath  = plan->nativePath;
 	auto javaVersion = minecraftInstance->getJavaVersion();
 	bool jniHackEnabled = javaVersion.major() >= 8;
 	for(const auto &source: toExtract)
@@ -26,6 +26,7 @@ LauncherPartLaunch::LauncherPartLaunch(LaunchTask *parent) : LaunchStep(parent)
 {
 	connect(&m_process, &LoggedProcess::log, this, &LauncherPartLaunch::logLines);
 	connect(&m_process, &LoggedProcess::stateChanged, this, &LauncherPartLaunch::on_state);
+	connect(&m_process, &LoggedProcess::log, this, &LauncherPartLaunch::on_log);
 }
 
 #ifdef Q_OS_WIN
@@ -59,22 +60,52 @@ void LauncherPartLaunch::executeTask()
 	auto instance = m_parent->instance();
 	std::shared_ptr<MinecraftInstance> minecraftInstance = std::dynamic_pointer_cast<MinecraftInstance>(instance);
 
-	m_launchScript = minecraftInstance->createLaunchScript(m_session);
-	QStringList args = minecraftInstance->javaArguments();
+	auto plan = m_parent->launchPlan();
+	m_launchScript = minecraftInstance->createLaunchScript(*plan, m_session);
+	QStringList args = plan->javaArguments;
+	args.append(m_parent->extraJavaArguments());
 	QString allArgs = args.join(", ");
 	emit logLine("Java Arguments:\n[" + m_parent->censorPrivateInfo(allArgs) + "]\n\n", MessageLevel::MultiMC);
 
 	auto javaPath = FS::ResolveExecutable(instance->settings()->get("JavaPath").toString());
 
-	m_process.setProcessEnvironment(instance->createEnvironment());
+	m_process.setProcessEnvironment(plan->environment);
 
 	// make detachable - this will keep the process running even if the object is destroyed
 	m_process.setDetachable(true);
 
-	auto classPath = minecraftInstance->getClassPath();
+	auto classPath = plan->classPath;
 	classPath.prepend(FS::PathCombine(ENV.getJarsPath(), "NewLaunch.jar"));
 
-	auto natPath = minecraftInstance->getNativePath();
+	if(instance->settings()->get("UseClassDataSharing").toBool())
+	{
+		auto cdsFolder = FS::PathCombine(instance->instanceRoot(), "cds");
+		m_classDataSharing.reset(new ClassDataSharing(cdsFolder, javaPath, minecraftInstance->getJavaVersion(), classPath));
+		if(!m_classDataSharing->isSupported())
+		{
+			emit logLine(tr("Class data sharing needs Java 13 or newer, not using it.\n\n"), MessageLevel::Warning);
+			m_classDataSharing.reset();
+		}
+		else
+		{
+			if(m_classDataSharing->removeStaleArchives())
+			{
+				emit logLine(tr("The Java runtime or the libraries changed since the class data sharing archive was made.\n"), MessageLevel::MultiMC);
+			}
+			m_usingArchive = m_classDataSharing->hasArchive();
+			if(m_usingArchive)
+			{
+				emit logLine(tr("Using class data sharing archive %1\n\n").arg(m_classDataSharing->fingerprint()), MessageLevel::MultiMC);
+			}
+			else
+			{
+				emit logLine(tr("The class data sharing archive will be created when the game exits.\n\n"), MessageLevel::MultiMC);
+			}
+			args << m_classDataSharing->arguments();
+		}
+	}
+
+	auto natPath = plan->nativePath;
 #ifdef Q_OS_WIN
 	if (!fitsInLocal8bit(natPath))
 	{
@@ -110,6 +141,11 @@ void LauncherPartLaunch::executeTask()
 
 	qDebug() << args.join(' ');
 
+	for(auto &warning: m_process.setLimits(minecraftInstance->processLimits(), instance->id()))
+	{
+		emit logLine(warning + "\n", MessageLevel::Warning);
+	}
+
 	QString wrapperCommandStr = instance->getWrapperCommand().trimmed();
 	if(!wrapperCommandStr.isEmpty())
 	{
@@ -170,6 +206,7 @@ void LauncherPartLaunch::on_state(LoggedProcess::State state)
 			break;
 		}
 		case LoggedProcess::Running:
+			m_startupTimer.start();
 			emit logLine(tr("Minecraft process ID: %1\n\n").arg(m_process.processId()), MessageLevel::MultiMC);
 			m_parent->setPid(m_process.processId());
 			m_parent->instance()->setLastLaunch();
@@ -184,6 +221,25 @@ void LauncherPartLaunch::on_state(LoggedProcess::State state)
 	}
 }
 
+void LauncherPartLaunch::on_log(QStringList lines, MessageLevel::Enum)
+{
+	if(!m_classDataSharing || !m_startupTimer.isValid())
+	{
+		return;
+	}
+	// the sound engine is the last thing to start before the title screen shows up, in every version that matters
+	for(auto &line: lines)
+	{
+		if(line.contains("Sound engine started"))
+		{
+			auto report = m_classDataSharing->recordStartupTime(m_usingArchive, m_startupTimer.elapsed());
+			emit logLine(report + "\n", MessageLevel::MultiMC);
+			m_startupTimer.invalidate();
+			return;
+		}
+	}
+}
+
 void LauncherPartLaunch::setWorkingDirectory(const QString &wd)
 {
 	m_process.setWorkingDirectory(wd);
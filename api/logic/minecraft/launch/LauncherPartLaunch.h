@@ -18,6 +18,9 @@
 #include <launch/LaunchStep.h>
 #include <LoggedProcess.h>
 #include <minecraft/auth/AuthSession.h>
+#include <java/ClassDataSharing.h>
+#include <QElapsedTimer>
+#include <memory>
 
 class LauncherPartLaunch: public LaunchStep
 {
@@ -39,6 +42,7 @@ public:
 
 private slots:
 	void on_state(LoggedProcess::State state);
+	void on_log(QStringList lines, MessageLevel::Enum level);
 
 private:
 	LoggedProcess m_process;
@@ -46,4 +50,7 @@ private:
 	AuthSessionPtr m_session;
 	QString m_launchScript;
 	bool mayProceed = false;
+	std::unique_ptr<ClassDataSharing> m_classDataSharing;
+	bool m_usingArchive = false;
+	QElapsedTimer m_startupTimer;
 };
@@ -0,0 +1,149 @@
+/* Copyright 2013-2017 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "PrewarmClasspath.h"
+#include "minecraft/MinecraftInstance.h"
+#include "launch/LaunchTask.h"
+#include "ProcessLimits.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QSet>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrentRun>
+
+#if defined(Q_OS_UNIX) && !defined(Q_OS_MAC)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+// enough for any sane modpack classpath, without evicting everything else from memory on small machines
+const qint64 prewarmBudget = 512 * 1024 * 1024;
+
+bool prewarmFile(const QString &path)
+{
+#if defined(Q_OS_UNIX) && !defined(Q_OS_MAC)
+	// ask the kernel to read ahead, it does so asynchronously
+	int fd = ::open(QFile::encodeName(path).constData(), O_RDONLY | O_CLOEXEC);
+	if(fd < 0)
+	{
+		return false;
+	}
+	bool ok = posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED) == 0;
+	::close(fd);
+	return ok;
+#else
+	// no readahead hint here, just read the file and throw the data away
+	QFile file(path);
+	if(!file.open(QIODevice::ReadOnly))
+	{
+		return false;
+	}
+	static const int chunkSize = 256 * 1024;
+	QByteArray buffer(chunkSize, Qt::Uninitialized);
+	while(file.read(buffer.data(), chunkSize) > 0)
+	{
+	}
+	return true;
+#endif
+}
+
+// One thread is plenty for what is mostly readahead hints, and it stays out of the way of the global pool.
+QThreadPool &prewarmPool()
+{
+	static QThreadPool pool;
+	pool.setMaxThreadCount(1);
+	return pool;
+}
+}
+
+PrewarmClasspath::PrewarmClasspath(LaunchTask *parent) : LaunchStep(parent)
+{
+	m_cancel = std::make_shared<std::atomic<bool>>(false);
+}
+
+PrewarmClasspath::~PrewarmClasspath()
+{
+	m_cancel->store(true);
+}
+
+QStringList PrewarmClasspath::selectFiles(const QStringList &files, qint64 budget, qint64 *selectedBytes)
+{
+	QStringList selected;
+	QSet<QString> seen;
+	qint64 total = 0;
+	for(auto &file: files)
+	{
+		if(seen.contains(file))
+		{
+			continue;
+		}
+		seen.insert(file);
+		QFileInfo info(file);
+		if(!info.isFile())
+		{
+			continue;
+		}
+		// skip what doesn't fit, smaller files further down may still fit
+		if(total + info.size() > budget)
+		{
+			continue;
+		}
+		total += info.size();
+		selected.append(file);
+	}
+	if(selectedBytes)
+	{
+		*selectedBytes = total;
+	}
+	return selected;
+}
+
+void PrewarmClasspath::executeTask()
+{
+	auto instance = m_parent->instance();
+	std::shared_ptr<MinecraftInstance> minecraftInstance = std::dynamic_pointer_cast<MinecraftInstance>(instance);
+
+	// the main jar is part of the classpath. Files the update step still has to download are simply skipped.
+	// This runs before the updates, so it can't use the launch plan yet.
+	QStringList files, nativeJars;
+	minecraftInstance->getLibraryFiles(files, nativeJars);
+	files.append(nativeJars);
+	qint64 bytes = 0;
+	auto selected = selectFiles(files, prewarmBudget, &bytes);
+	qDebug() << "Prewarming" << selected.size() << "of" << files.size() << "launch files," << bytes / (1024 * 1024) << "MiB";
+
+	// fire and forget. The work only shares the cancel flag with the step, never the step itself.
+	auto cancel = m_cancel;
+	QtConcurrent::run(&prewarmPool(), [selected, cancel]()
+	{
+		// the game and the updates come first. Nothing else runs in this pool, so this isn't restored.
+		QThread::currentThread()->setPriority(QThread::LowPriority);
+		ProcessLimits::setThreadIOPriority(ProcessLimits::IOLow);
+		for(auto &file: selected)
+		{
+			if(cancel->load())
+			{
+				break;
+			}
+			prewarmFile(file);
+		}
+	});
+	emitSucceeded();
+}
@@ -0,0 +1,45 @@
+/* Copyright 2013-2017 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <launch/LaunchStep.h>
+#include <QStringList>
+#include <atomic>
+#include <memory>
+
+/**
+ * Starts pulling the classpath and native jars into the page cache while the rest of the launch
+ * (auth, updates) waits on the network. Never blocks the launch and never fails it.
+ */
+class PrewarmClasspath: public LaunchStep
+{
+	Q_OBJECT
+public:
+	explicit PrewarmClasspath(LaunchTask *parent);
+	virtual ~PrewarmClasspath();
+	virtual void executeTask();
+	virtual bool canAbort() const
+	{
+		return false;
+	}
+
+	/// pick files in order until the budget (in bytes) is used up. Missing files are skipped.
+	static QStringList selectFiles(const QStringList &files, qint64 budget, qint64 *selectedBytes = nullptr);
+
+private:
+	/// set when the launch goes away, the files not warmed yet are left alone
+	std::shared_ptr<std::atomic<bool>> m_cancel;
+};
@@ -0,0 +1,55 @@
+#include <QTest>
+#include <QTemporaryDir>
+#include "TestUtil.h"
+
+#include "minecraft/launch/PrewarmClasspath.h"
+#include "FileSystem.h"
+
+class PrewarmClasspathTest : public QObject
+{
+	Q_OBJECT
+private:
+	QString makeFile(const QString &root, const QString &name, int size)
+	{
+		auto path = FS::PathCombine(root, name);
+		FS::write(path, QByteArray(size, 'x'));
+		return path;
+	}
+
+private
+slots:
+	void test_selectFiles()
+	{
+		QTemporaryDir tempDir;
+		auto big = makeFile(tempDir.path(), "big.jar", 60);
+		auto medium = makeFile(tempDir.path(), "medium.jar", 30);
+		auto small = makeFile(tempDir.path(), "small.jar", 10);
+		auto tiny = makeFile(tempDir.path(), "tiny.jar", 5);
+		auto missing = FS::PathCombine(tempDir.path(), "missing.jar");
+
+		qint64 bytes = 0;
+		// in order, until the budget is used up. What doesn't fit is skipped, smaller files later on still get in.
+		auto selected = PrewarmClasspath::selectFiles({medium, big, small, tiny}, 50, &bytes);
+		QCOMPARE(selected, QStringList({medium, small, tiny}));
+		QCOMPARE(bytes, qint64(45));
+
+		// the order of the list decides, not the size
+		selected = PrewarmClasspath::selectFiles({big, medium, small}, 70, &bytes);
+		QCOMPARE(selected, QStringList({big, small}));
+		QCOMPARE(bytes, qint64(70));
+
+		// duplicates count once, missing files not at all
+		selected = PrewarmClasspath::selectFiles({small, missing, small, tiny, small}, 100, &bytes);
+		QCOMPARE(selected, QStringList({small, tiny}));
+		QCOMPARE(bytes, qint64(15));
+
+		// nothing fits
+		selected = PrewarmClasspath::selectFiles({big, medium}, 20, &bytes);
+		QVERIFY(selected.isEmpty());
+		QCOMPARE(bytes, qint64(0));
+	}
+};
+
+QTEST_GUILESS_MAIN(PrewarmClasspathTest)
+
+#include "PrewarmClasspath_test.moc"
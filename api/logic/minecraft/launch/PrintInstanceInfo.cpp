@@ -18,11 +18,22 @@
 
 #include "PrintInstanceInfo.h"
 #include <launch/LaunchTask.h>
+#include <minecraft/MinecraftInstance.h>
 
 void PrintInstanceInfo::executeTask()
 {
     auto instance = m_parent->instance();
-    auto lines = instance->verboseDescription(m_session);
+    auto minecraftInstance = std::dynamic_pointer_cast<MinecraftInstance>(instance);
+    auto plan = m_parent->launchPlan();
+    QStringList lines;
+    if (minecraftInstance && plan)
+    {
+        lines = minecraftInstance->verboseDescription(*plan);
+    }
+    else
+    {
+        lines = instance->verboseDescription(m_session);
+    }
     
 #ifdef Q_OS_LINUX
     std::ifstream cpuin("/proc/cpuinfo");
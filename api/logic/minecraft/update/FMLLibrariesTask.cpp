@@ -89,12 +89,17 @@ void FMLLibrariesTask::fmllibsFinished()
 	{
 		setStatus(tr("Copying FML libraries into the instance..."));
 		MinecraftInstance *inst = (MinecraftInstance *)m_inst;
-		auto metacache = ENV.metacache();
+		QStringList filenames;
+		for (auto &lib : fmlLibsToProcess)
+		{
+			filenames.append(lib.filename);
+		}
+		auto entries = ENV.metacache()->resolveEntries("fmllibs", filenames);
 		int index = 0;
 		for (auto &lib : fmlLibsToProcess)
 		{
 			progress(index, fmlLibsToProcess.size());
-			auto entry = metacache->resolveEntry("fmllibs", lib.filename);
+			auto entry = entries[index];
 			auto path = FS::PathCombine(inst->libDir(), lib.filename);
 			if (!FS::ensureFilePathExists(path))
 			{
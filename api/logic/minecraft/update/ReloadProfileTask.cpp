@@ -0,0 +1,20 @@
+#include "ReloadProfileTask.h"
+#include "minecraft/MinecraftInstance.h"
+
+ReloadProfileTask::ReloadProfileTask(MinecraftInstance * inst)
+	:Task()
+{
+	m_inst = inst;
+}
+
+void ReloadProfileTask::executeTask()
+{
+	// the metadata is up to date now, so this is the final profile
+	m_inst->reloadProfile();
+	if(m_inst->hasVersionBroken())
+	{
+		emitFailed(tr("Failed to load the version description files - check the instance for errors."));
+		return;
+	}
+	emitSucceeded();
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "tasks/Task.h"
+
+class MinecraftInstance;
+class ReloadProfileTask : public Task
+{
+	Q_OBJECT
+public:
+	ReloadProfileTask(MinecraftInstance * inst);
+	void executeTask() override;
+private:
+	MinecraftInstance *m_inst;
+};
@@ -10,7 +10,7 @@ class ChecksumValidator: public Validator
 {
 public: /* con/des */
 	ChecksumValidator(QCryptographicHash::Algorithm algorithm, QByteArray expected = QByteArray())
-		:m_checksum(algorithm), m_expected(expected)
+		:m_algorithm(algorithm), m_checksum(algorithm), m_expected(expected)
 	{
 	};
 	virtual ~ChecksumValidator() {};
@@ -48,8 +48,18 @@ public: /* methods */
 	{
 		m_expected = expected;
 	}
+	QString expectation() const override
+	{
+		if(m_expected.isEmpty())
+		{
+			// only computes the checksum, anything goes
+			return QLatin1String("");
+		}
+		return QString("%1:%2").arg(int(m_algorithm)).arg(QString::fromLatin1(m_expected.toHex()));
+	}
 
 private: /* data */
+	QCryptographicHash::Algorithm m_algorithm;
 	QByteArray data;
 	QCryptographicHash m_checksum;
 	QByteArray m_expected;
@@ -18,14 +18,31 @@
 #include <QFileInfo>
 #include <QDateTime>
 #include <QDebug>
+#include <QThread>
 #include "Env.h"
 #include <FileSystem.h>
+#include "LoggingCategories.h"
 #include "ChecksumValidator.h"
 #include "MetaCacheSink.h"
 #include "ByteArraySink.h"
 
 namespace Net {
 
+namespace {
+// a download may live on the network thread and has to be deleted there
+void deleteDownload(Download *download)
+{
+	if(download->thread() == QThread::currentThread())
+	{
+		delete download;
+	}
+	else
+	{
+		download->deleteLater();
+	}
+}
+}
+
 Download::Download():NetAction()
 {
 	m_status = Job_NotStarted;
@@ -40,7 +57,8 @@ Download::Ptr Download::makeCached(QUrl url, MetaEntryPtr entry, Options options
 	auto cachedNode = new MetaCacheSink(entry, md5Node);
 	dl->m_sink.reset(cachedNode);
 	dl->m_target_path = entry->getFullPath();
-	return std::shared_ptr<Download>(dl);
+	dl->m_sinkKind = "cached";
+	return std::shared_ptr<Download>(dl, deleteDownload);
 }
 
 Download::Ptr Download::makeByteArray(QUrl url, QByteArray *output, Options options)
@@ -49,7 +67,7 @@ Download::Ptr Download::makeByteArray(QUrl url, QByteArray *output, Options opti
 	dl->m_url = url;
 	dl->m_options = options;
 	dl->m_sink.reset(new ByteArraySink(output));
-	return std::shared_ptr<Download>(dl);
+	return std::shared_ptr<Download>(dl, deleteDownload);
 }
 
 Download::Ptr Download::makeFile(QUrl url, QString path, Options options)
@@ -58,7 +76,18 @@ Download::Ptr Download::makeFile(QUrl url, QString path, Options options)
 	dl->m_url = url;
 	dl->m_options = options;
 	dl->m_sink.reset(new FileSink(path));
-	return std::shared_ptr<Download>(dl);
+	return std::shared_ptr<Download>(dl, deleteDownload);
+}
+
+Download::Ptr Download::makeBatchedFile(QUrl url, QString path, std::shared_ptr<FileSinkBatch> batch, Options options)
+{
+	Download * dl = new Download();
+	dl->m_url = url;
+	dl->m_options = options;
+	dl->m_sink.reset(new FileSink(path, batch));
+	dl->m_target_path = path;
+	dl->m_sinkKind = "file";
+	return std::shared_ptr<Download>(dl, deleteDownload);
 }
 
 void Download::addValidator(Validator * v)
@@ -66,6 +95,25 @@ void Download::addValidator(Validator * v)
 	m_sink->addValidator(v);
 }
 
+QString Download::resultKey() const
+{
+	auto validation = m_sink->validationKey();
+	if(m_sinkKind.isEmpty() || validation.isNull())
+	{
+		return QString();
+	}
+	return m_sinkKind + '|' + validation;
+}
+
+void Download::addMirror(QUrl url)
+{
+	if(m_sources.isEmpty())
+	{
+		m_sources.append(m_url);
+	}
+	m_sources.append(url);
+}
+
 void Download::start()
 {
 	if(m_status == Job_Aborted)
@@ -80,10 +128,10 @@ void Download::start()
 	{
 		case Job_Finished:
 			emit succeeded(m_index_within_job);
-			qDebug() << "Download cache hit " << m_url.toString();
+			qCDebug(logNet) << "Download cache hit " << m_url.toString();
 			return;
 		case Job_InProgress:
-			qDebug() << "Downloading " << m_url.toString();
+			qCDebug(logNet) << "Downloading " << m_url.toString();
 			break;
 		case Job_Failed_Proceed: // this is meaningless in this context. We do need a sink.
 		case Job_NotStarted:
@@ -96,7 +144,8 @@ void Download::start()
 
 	request.setHeader(QNetworkRequest::UserAgentHeader, "MultiMC/5.0");
 
-	QNetworkReply *rep =  ENV.qnam().get(request);
+	auto &qnam = ENV.isNetworkThread() ? ENV.networkQnam() : ENV.qnam();
+	QNetworkReply *rep = qnam.get(request);
 
 	m_reply.reset(rep);
 	connect(rep, SIGNAL(downloadProgress(qint64, qint64)), SLOT(downloadProgress(qint64, qint64)));
@@ -168,27 +217,46 @@ bool Download::handleRedirect()
 	if (!redirectURL.isEmpty())
 	{
 		m_url = QUrl(redirect.toString());
-		qDebug() << "Following redirect to " << m_url.toString();
+		qCDebug(logNet) << "Following redirect to " << m_url.toString();
 		start();
 		return true;
 	}
 	return false;
 }
 
+bool Download::startNextMirror()
+{
+	if(m_currentSource + 1 >= m_sources.size())
+	{
+		// all sources failed. If the whole download gets retried, begin with the first one again.
+		if(m_sources.size())
+		{
+			m_currentSource = 0;
+			m_url = m_sources[0];
+		}
+		return false;
+	}
+	m_currentSource++;
+	m_url = m_sources[m_currentSource];
+	qCDebug(logNet) << "Trying next source for download:" << m_url.toString();
+	m_status = Job_NotStarted;
+	start();
+	return true;
+}
 
 void Download::downloadFinished()
 {
 	// handle HTTP redirection first
 	if(handleRedirect())
 	{
-		qDebug() << "Download redirected:" << m_url.toString();
+		qCDebug(logNet) << "Download redirected:" << m_url.toString();
 		return;
 	}
 
 	// if the download failed before this point ...
 	if (m_status == Job_Failed_Proceed)
 	{
-		qDebug() << "Download failed but we are allowed to proceed:" << m_url.toString();
+		qCDebug(logNet) << "Download failed but we are allowed to proceed:" << m_url.toString();
 		m_sink->abort();
 		m_reply.reset();
 		emit succeeded(m_index_within_job);
@@ -196,15 +264,19 @@ void Download::downloadFinished()
 	}
 	else if (m_status == Job_Failed)
 	{
-		qDebug() << "Download failed in previous step:" << m_url.toString();
+		qCWarning(logNet) << "Download failed in previous step:" << m_url.toString();
 		m_sink->abort();
 		m_reply.reset();
+		if(startNextMirror())
+		{
+			return;
+		}
 		emit failed(m_index_within_job);
 		return;
 	}
 	else if(m_status == Job_Aborted)
 	{
-		qDebug() << "Download aborted in previous step:" << m_url.toString();
+		qCWarning(logNet) << "Download aborted in previous step:" << m_url.toString();
 		m_sink->abort();
 		m_reply.reset();
 		emit aborted(m_index_within_job);
@@ -215,7 +287,7 @@ void Download::downloadFinished()
 	auto data = m_reply->readAll();
 	if(data.size())
 	{
-		qDebug() << "Writing extra" << data.size() << "bytes to" << m_target_path;
+		qCDebug(logNet) << "Writing extra" << data.size() << "bytes to" << m_target_path;
 		m_status = m_sink->write(data);
 	}
 
@@ -223,14 +295,18 @@ void Download::downloadFinished()
 	m_status = m_sink->finalize(*m_reply.get());
 	if (m_status != Job_Finished)
 	{
-		qDebug() << "Download failed to finalize:" << m_url.toString();
+		qCWarning(logNet) << "Download failed to finalize:" << m_url.toString();
 		m_sink->abort();
 		m_reply.reset();
+		if(startNextMirror())
+		{
+			return;
+		}
 		emit failed(m_index_within_job);
 		return;
 	}
 	m_reply.reset();
-	qDebug() << "Download succeeded:" << m_url.toString();
+	qCDebug(logNet) << "Download succeeded:" << m_url.toString();
 	emit succeeded(m_index_within_job);
 }
 
@@ -22,6 +22,8 @@
 
 #include "multimc_logic_export.h"
 namespace Net {
+class FileSinkBatch;
+
 class MULTIMC_LOGIC_EXPORT Download : public NetAction
 {
 	Q_OBJECT
@@ -31,7 +33,9 @@ public: /* types */
 	enum class Option
 	{
 		NoOptions = 0,
-		AcceptLocalFiles = 1
+		AcceptLocalFiles = 1,
+		/// keep the download on the thread that made it, for validators that touch objects living there
+		StayOnCallerThread = 2
 	};
 	Q_DECLARE_FLAGS(Options, Option)
 
@@ -42,18 +46,32 @@ public:
 	static Download::Ptr makeCached(QUrl url, MetaEntryPtr entry, Options options = Option::NoOptions);
 	static Download::Ptr makeByteArray(QUrl url, QByteArray *output, Options options = Option::NoOptions);
 	static Download::Ptr makeFile(QUrl url, QString path, Options options = Option::NoOptions);
+	/// for small content-addressed files with a checksum validator. See FileSinkBatch.
+	static Download::Ptr makeBatchedFile(QUrl url, QString path, std::shared_ptr<FileSinkBatch> batch, Options options = Option::NoOptions);
 
 public: /* methods */
 	QString getTargetFilepath()
 	{
 		return m_target_path;
 	}
+	Options options() const
+	{
+		return m_options;
+	}
+	/**
+	 * Two downloads with the same non-null key end up with the same file, checked the same way.
+	 * Null if that can't be told, for example when a validator does more than check the data.
+	 */
+	QString resultKey() const;
 	void addValidator(Validator * v);
+	/// add another URL to try, in order, when the download from the previous one fails
+	void addMirror(QUrl url);
 	bool abort() override;
 	bool canAbort() override;
 
 private: /* methods */
 	bool handleRedirect();
+	bool startNextMirror();
 
 protected slots:
 	void downloadProgress(qint64 bytesReceived, qint64 bytesTotal) override;
@@ -68,8 +86,12 @@ public slots:
 private: /* data */
 	// FIXME: remove this, it has no business being here.
 	QString m_target_path;
+	// what kind of sink writes to m_target_path
+	QString m_sinkKind;
 	std::unique_ptr<Sink> m_sink;
 	Options m_options;
+	QList<QUrl> m_sources;
+	int m_currentSource = 0;
 };
 }
 
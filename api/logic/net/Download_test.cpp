@@ -0,0 +1,63 @@
+#include <QTest>
+#include <QSignalSpy>
+#include "TestUtil.h"
+#include "TestHttpServer.h"
+
+#include "net/Download.h"
+
+class DownloadTest : public QObject
+{
+	Q_OBJECT
+private
+slots:
+	void test_mirrorFallback()
+	{
+		TestHttpServer server;
+		QVERIFY(server.listen(QHostAddress::LocalHost));
+		server.files["/second/file"] = "data from the second source";
+
+		QByteArray output;
+		auto dl = Net::Download::makeByteArray(server.url("/first/file"), &output);
+		dl->addMirror(server.url("/second/file"));
+		QSignalSpy succeededSpy(dl.get(), SIGNAL(succeeded(int)));
+		QSignalSpy failedSpy(dl.get(), SIGNAL(failed(int)));
+		dl->start();
+		QVERIFY(succeededSpy.wait(10000));
+		QCOMPARE(failedSpy.count(), 0);
+		QCOMPARE(server.requested, QStringList({"/first/file", "/second/file"}));
+		QCOMPARE(output, QByteArray("data from the second source"));
+	}
+
+	void test_mirrorsAllFail()
+	{
+		TestHttpServer server;
+		QVERIFY(server.listen(QHostAddress::LocalHost));
+
+		QByteArray output;
+		auto dl = Net::Download::makeByteArray(server.url("/first/file"), &output);
+		dl->addMirror(server.url("/second/file"));
+		dl->addMirror(server.url("/third/file"));
+		QSignalSpy succeededSpy(dl.get(), SIGNAL(succeeded(int)));
+		QSignalSpy failedSpy(dl.get(), SIGNAL(failed(int)));
+		dl->start();
+		QVERIFY(failedSpy.wait(10000));
+		// failed once, after the last source, not once per source
+		QTest::qWait(100);
+		QCOMPARE(failedSpy.count(), 1);
+		QCOMPARE(succeededSpy.count(), 0);
+		QCOMPARE(server.requested, QStringList({"/first/file", "/second/file", "/third/file"}));
+
+		// a retry goes through the sources from the start again
+		server.files["/second/file"] = "back up";
+		server.requested.clear();
+		dl->start();
+		QVERIFY(succeededSpy.wait(10000));
+		QCOMPARE(failedSpy.count(), 1);
+		QCOMPARE(server.requested, QStringList({"/first/file", "/second/file"}));
+		QCOMPARE(output, QByteArray("back up"));
+	}
+};
+
+QTEST_GUILESS_MAIN(DownloadTest)
+
+#include "Download_test.moc"
@@ -1,13 +1,150 @@
 #include "FileSink.h"
 #include <QFile>
 #include <QFileInfo>
+#include <QDir>
 #include "Env.h"
 #include "FileSystem.h"
+#include <QDebug>
+#include <QHash>
 
 namespace Net {
 
-FileSink::FileSink(QString filename)
-	:m_filename(filename)
+namespace {
+// batched downloads bigger than this go through a QSaveFile after all
+const int maxBufferedSize = 1024 * 1024;
+
+// batches with files that aren't durable yet, by marker
+QMutex markersMutex;
+QHash<QString, int> & liveMarkers()
+{
+	static QHash<QString, int> markers;
+	return markers;
+}
+}
+
+FileSinkBatch::FileSinkBatch(const QString &marker) : m_marker(marker)
+{
+}
+
+FileSinkBatch::~FileSinkBatch()
+{
+	// never committed, whatever was written stays suspect
+	release(false);
+}
+
+bool FileSinkBatch::ensureFolderExists(const QString &folder)
+{
+	QMutexLocker locker(&m_mutex);
+	if(m_knownFolders.contains(folder))
+	{
+		return true;
+	}
+	if(!QDir().mkpath(folder))
+	{
+		return false;
+	}
+	m_knownFolders.insert(folder);
+	return true;
+}
+
+bool FileSinkBatch::aboutToWrite(const QString &filename)
+{
+	QMutexLocker locker(&m_mutex);
+	m_written.append(filename);
+	if(m_marker.isEmpty() || m_holdsMarker)
+	{
+		return true;
+	}
+	QMutexLocker markersLocker(&markersMutex);
+	// an existing marker is older, and covers our files too
+	if(!QFile::exists(m_marker))
+	{
+		QFile marker(m_marker);
+		if(!FS::ensureFilePathExists(m_marker) || !marker.open(QIODevice::WriteOnly))
+		{
+			qCritical() << "Could not create" << m_marker;
+			return false;
+		}
+		marker.close();
+		if(!FS::syncToDisk(m_marker) || !FS::syncToDisk(QFileInfo(m_marker).absolutePath()))
+		{
+			qCritical() << "Could not flush" << m_marker;
+			return false;
+		}
+	}
+	liveMarkers()[m_marker]++;
+	m_holdsMarker = true;
+	return true;
+}
+
+void FileSinkBatch::release(bool synced)
+{
+	QMutexLocker locker(&m_mutex);
+	if(!m_holdsMarker)
+	{
+		return;
+	}
+	m_holdsMarker = false;
+	QMutexLocker markersLocker(&markersMutex);
+	auto &live = liveMarkers();
+	if(--live[m_marker] == 0)
+	{
+		live.remove(m_marker);
+		if(synced)
+		{
+			QFile::remove(m_marker);
+		}
+	}
+}
+
+QDateTime FileSinkBatch::unsyncedSince(const QString &marker)
+{
+	QFileInfo info(marker);
+	if(!info.exists())
+	{
+		return QDateTime();
+	}
+	return info.lastModified();
+}
+
+void FileSinkBatch::markSynced(const QString &marker)
+{
+	QMutexLocker markersLocker(&markersMutex);
+	if(!liveMarkers().contains(marker))
+	{
+		QFile::remove(marker);
+	}
+}
+
+bool FileSinkBatch::commit()
+{
+	QStringList written;
+	{
+		QMutexLocker locker(&m_mutex);
+		written.swap(m_written);
+	}
+	bool success = true;
+	// the files first, then the folders that got new entries for them
+	QSet<QString> folders;
+	for(auto &filename: written)
+	{
+		success &= FS::syncToDisk(filename);
+		folders.insert(QFileInfo(filename).absolutePath());
+	}
+	for(auto &folder: folders)
+	{
+		success &= FS::syncToDisk(folder);
+	}
+	if(!success)
+	{
+		qWarning() << "Failed to flush" << written.size() << "downloaded files to disk";
+	}
+	release(success);
+	return success;
+}
+
+FileSink::FileSink(QString filename, std::shared_ptr<FileSinkBatch> batch)
+	:m_filename(filename), m_batch(batch)
 {
 	// nil
 };
@@ -24,17 +161,20 @@ JobStatus FileSink::init(QNetworkRequest& request)
 	{
 		return result;
 	}
-	// create a new save file and open it for writing
-	if (!FS::ensureFilePathExists(m_filename))
+	wroteAnyData = false;
+	m_buffer.clear();
+	m_output_file.reset();
+	if(m_batch)
 	{
-		qCritical() << "Could not create folder for " + m_filename;
-		return Job_Failed;
+		if (!m_batch->ensureFolderExists(QFileInfo(m_filename).absolutePath()))
+		{
+			qCritical() << "Could not create folder for " + m_filename;
+			return Job_Failed;
+		}
 	}
-	wroteAnyData = false;
-	m_output_file.reset(new QSaveFile(m_filename));
-	if (!m_output_file->open(QIODevice::WriteOnly))
+	// create a new save file and open it for writing
+	else if (!FS::ensureFilePathExists(m_filename) || !openOutputFile())
 	{
-		qCritical() << "Could not open " + m_filename + " for writing";
 		return Job_Failed;
 	}
 
@@ -43,6 +183,18 @@ JobStatus FileSink::init(QNetworkRequest& request)
 	return Job_Failed;
 }
 
+bool FileSink::openOutputFile()
+{
+	m_output_file.reset(new QSaveFile(m_filename));
+	if (!m_output_file->open(QIODevice::WriteOnly))
+	{
+		qCritical() << "Could not open " + m_filename + " for writing";
+		m_output_file.reset();
+		return false;
+	}
+	return true;
+}
+
 JobStatus FileSink::initCache(QNetworkRequest &)
 {
 	return Job_InProgress;
@@ -50,11 +202,33 @@ JobStatus FileSink::initCache(QNetworkRequest &)
 
 JobStatus FileSink::write(QByteArray& data)
 {
-	if (!writeAllValidators(data) || m_output_file->write(data) != data.size())
+	bool written = writeAllValidators(data);
+	if(written)
+	{
+		if(m_output_file)
+		{
+			written = m_output_file->write(data) == data.size();
+		}
+		else
+		{
+			m_buffer.append(data);
+			// too big to keep in memory, continue the usual way
+			if(m_buffer.size() > maxBufferedSize)
+			{
+				written = openOutputFile() && m_output_file->write(m_buffer) == m_buffer.size();
+				m_buffer.clear();
+			}
+		}
+	}
+	if (!written)
 	{
 		qCritical() << "Failed writing into " + m_filename;
-		m_output_file->cancelWriting();
-		m_output_file.reset();
+		if(m_output_file)
+		{
+			m_output_file->cancelWriting();
+			m_output_file.reset();
+		}
+		m_buffer.clear();
 		wroteAnyData = false;
 		return Job_Failed;
 	}
@@ -64,7 +238,11 @@ JobStatus FileSink::write(QByteArray& data)
 
 JobStatus FileSink::abort()
 {
-	m_output_file->cancelWriting();
+	if(m_output_file)
+	{
+		m_output_file->cancelWriting();
+	}
+	m_buffer.clear();
 	failAllValidators();
 	return Job_Failed;
 }
@@ -89,11 +267,29 @@ JobStatus FileSink::finalize(QNetworkReply& reply)
 		if(!finalizeAllValidators(reply))
 			return Job_Failed;
 		// nothing went wrong...
-		if (!m_output_file->commit())
+		if (m_output_file)
 		{
-			qCritical() << "Failed to commit changes to " << m_filename;
-			m_output_file->cancelWriting();
-			return Job_Failed;
+			if ((m_batch && !m_batch->aboutToWrite(m_filename)) || !m_output_file->commit())
+			{
+				qCritical() << "Failed to commit changes to " << m_filename;
+				m_output_file->cancelWriting();
+				return Job_Failed;
+			}
+		}
+		else if (m_batch)
+		{
+			// the data is verified already, write it directly. The batch makes it durable later.
+			QFile output(m_filename);
+			if (!m_batch->aboutToWrite(m_filename) || !output.open(QIODevice::WriteOnly | QIODevice::Truncate)
+				|| output.write(m_buffer) != m_buffer.size())
+			{
+				qCritical() << "Failed to write " << m_filename;
+				output.remove();
+				m_buffer.clear();
+				return Job_Failed;
+			}
+			output.close();
+			m_buffer.clear();
 		}
 	}
 	// then get rid of the save file
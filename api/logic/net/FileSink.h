@@ -1,12 +1,55 @@
 #pragma once
 #include "Sink.h"
+#include <QDateTime>
 #include <QSaveFile>
+#include <QMutex>
+#include <QSet>
+#include <QStringList>
 
 namespace Net {
+/**
+ * Shared by the sinks of many small downloads into content-addressed files, like asset objects.
+ *
+ * Their checksums are verified, so they don't need the write-and-rename of QSaveFile:
+ * the files are written straight from memory, folders are only created once,
+ * and the data is flushed to disk by commit() at the end instead of while downloading.
+ *
+ * Until then, a crash can leave files with the right size and the wrong content. So while a batch has files that
+ * aren't durable yet, a marker file exists. Its time is when the oldest of those files was written, and anything
+ * written since has to be checked by content before it is trusted again.
+ */
+class MULTIMC_LOGIC_EXPORT FileSinkBatch
+{
+public:
+	explicit FileSinkBatch(const QString &marker = QString());
+	~FileSinkBatch();
+
+	bool ensureFolderExists(const QString &folder);
+	/// call before writing a file, so the marker is there before the file is
+	bool aboutToWrite(const QString &filename);
+	/// make everything written so far durable. Blocks until it is, so don't call it on the GUI thread.
+	bool commit();
+
+	/// files changed since then may not have made it to disk intact. Null if there are none.
+	static QDateTime unsyncedSince(const QString &marker);
+	/// the files written since unsyncedSince() were checked. Does nothing while a batch still writes.
+	static void markSynced(const QString &marker);
+
+private:
+	void release(bool synced);
+
+private:
+	QMutex m_mutex;
+	QString m_marker;
+	bool m_holdsMarker = false;
+	QSet<QString> m_knownFolders;
+	QStringList m_written;
+};
+
 class FileSink : public Sink
 {
 public: /* con/des */
-	FileSink(QString filename);
+	FileSink(QString filename, std::shared_ptr<FileSinkBatch> batch = nullptr);
 	virtual ~FileSink();
 
 public: /* methods */
@@ -20,9 +63,15 @@ protected: /* methods */
 	virtual JobStatus initCache(QNetworkRequest &);
 	virtual JobStatus finalizeCache(QNetworkReply &reply);
 
+private: /* methods */
+	bool openOutputFile();
+
 protected: /* data */
 	QString m_filename;
 	bool wroteAnyData = false;
 	std::unique_ptr<QSaveFile> m_output_file;
+	std::shared_ptr<FileSinkBatch> m_batch;
+	/// in batched mode, the data is kept here until it gets too big
+	QByteArray m_buffer;
 };
 }
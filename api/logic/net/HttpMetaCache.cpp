@@ -15,6 +15,7 @@
 
 #include "Env.h"
 #include "HttpMetaCache.h"
+#include "LoggingCategories.h"
 #include "FileSystem.h"
 
 #include <QFileInfo>
@@ -27,6 +28,10 @@
 #include <QJsonDocument>
 #include <QJsonArray>
 #include <QJsonObject>
+#include <QtConcurrentRun>
+#include <QtConcurrentMap>
+#include <functional>
+#include <QThread>
 
 QString MetaEntry::getFullPath()
 {
@@ -48,20 +53,34 @@ HttpMetaCache::~HttpMetaCache()
 	SaveNow();
 }
 
+HttpMetaCache::EntryMapPtr HttpMetaCache::shard(const QString &base)
+{
+	QReadLocker locker(&m_basesLock);
+	return m_entries.value(base);
+}
+
+void HttpMetaCache::disown(EntryMapPtr map, const QString &resource_path, MetaEntryPtr entry)
+{
+	QWriteLocker locker(&map->lock);
+	auto iter = map->entry_list.find(resource_path);
+	if(iter != map->entry_list.end() && *iter == entry)
+	{
+		map->entry_list.erase(iter);
+	}
+}
+
 MetaEntryPtr HttpMetaCache::getEntry(QString base, QString resource_path)
 {
+	waitForLoad();
 	// no base. no base path. can't store
-	if (!m_entries.contains(base))
+	auto map = shard(base);
+	if (!map)
 	{
 		// TODO: log problem
 		return MetaEntryPtr();
 	}
-	EntryMap &map = m_entries[base];
-	if (map.entry_list.contains(resource_path))
-	{
-		return map.entry_list[resource_path];
-	}
-	return MetaEntryPtr();
+	QReadLocker locker(&map->lock);
+	return map->entry_list.value(resource_path);
 }
 
 MetaEntryPtr HttpMetaCache::resolveEntry(QString base, QString resource_path, QString expected_etag)
@@ -73,69 +92,98 @@ MetaEntryPtr HttpMetaCache::resolveEntry(QString base, QString resource_path, QS
 		return staleEntry(base, resource_path);
 	}
 
-	auto &selected_base = m_entries[base];
-	QString real_path = FS::PathCombine(selected_base.base_path, resource_path);
+	auto selected_base = shard(base);
+	QString real_path = FS::PathCombine(selected_base->base_path, resource_path);
 	QFileInfo finfo(real_path);
 
 	// is the file really there? if not -> stale
 	if (!finfo.isFile() || !finfo.isReadable())
 	{
 		// if the file doesn't exist, we disown the entry
-		selected_base.entry_list.remove(resource_path);
+		disown(selected_base, resource_path, entry);
 		return staleEntry(base, resource_path);
 	}
 
-	if (!expected_etag.isEmpty() && expected_etag != entry->etag)
+	if (!expected_etag.isEmpty() && expected_etag != entry->getETag())
 	{
 		// if the etag doesn't match expected, we disown the entry
-		selected_base.entry_list.remove(resource_path);
+		disown(selected_base, resource_path, entry);
 		return staleEntry(base, resource_path);
 	}
 
-	// if the file changed, check md5sum
+	// if the file changed, check md5sum. No locks are held while hashing.
 	qint64 file_last_changed = finfo.lastModified().toUTC().toMSecsSinceEpoch();
-	if (file_last_changed != entry->local_changed_timestamp)
+	qint64 known_last_changed;
+	{
+		QMutexLocker locker(&entry->lock);
+		known_last_changed = entry->local_changed_timestamp;
+	}
+	if (file_last_changed != known_last_changed)
 	{
 		QFile input(real_path);
 		input.open(QIODevice::ReadOnly);
 		QString md5sum = QCryptographicHash::hash(input.readAll(), QCryptographicHash::Md5)
 							 .toHex()
 							 .constData();
-		if (entry->md5sum != md5sum)
+		if (entry->getMD5Sum() != md5sum)
 		{
-			selected_base.entry_list.remove(resource_path);
+			disown(selected_base, resource_path, entry);
 			return staleEntry(base, resource_path);
 		}
 		// md5sums matched... keep entry and save the new state to file
-		entry->local_changed_timestamp = file_last_changed;
+		entry->setLocalChangedTimestamp(file_last_changed);
 		SaveEventually();
 	}
 
 	// entry passed all the checks we cared about.
-	entry->basePath = getBasePath(base);
 	return entry;
 }
 
+QList<MetaEntryPtr> HttpMetaCache::resolveEntries(QString base, const QStringList &resource_paths)
+{
+	waitForLoad();
+	std::function<MetaEntryPtr(const QString &)> resolve = [this, base](const QString &resource_path)
+	{
+		return resolveEntry(base, resource_path);
+	};
+	if(resource_paths.size() < 2)
+	{
+		QList<MetaEntryPtr> out;
+		for(auto &resource_path: resource_paths)
+		{
+			out.append(resolve(resource_path));
+		}
+		return out;
+	}
+	return QtConcurrent::blockingMapped<QList<MetaEntryPtr>>(resource_paths, resolve);
+}
+
 bool HttpMetaCache::updateEntry(MetaEntryPtr stale_entry)
 {
-	if (!m_entries.contains(stale_entry->baseId))
+	waitForLoad();
+	auto map = shard(stale_entry->baseId);
+	if (!map)
 	{
-		qCritical() << "Cannot add entry with unknown base: "
+		qCCritical(logMetaCache) << "Cannot add entry with unknown base: "
 					 << stale_entry->baseId.toLocal8Bit();
 		return false;
 	}
 	if (stale_entry->stale)
 	{
-		qCritical() << "Cannot add stale entry: " << stale_entry->getFullPath().toLocal8Bit();
+		qCCritical(logMetaCache) << "Cannot add stale entry: " << stale_entry->getFullPath().toLocal8Bit();
 		return false;
 	}
-	m_entries[stale_entry->baseId].entry_list[stale_entry->relativePath] = stale_entry;
+	{
+		QWriteLocker locker(&map->lock);
+		map->entry_list[stale_entry->relativePath] = stale_entry;
+	}
 	SaveEventually();
 	return true;
 }
 
 bool HttpMetaCache::evictEntry(MetaEntryPtr entry)
 {
+	waitForLoad();
 	if(entry)
 	{
 		entry->stale = true;
@@ -145,6 +193,25 @@ bool HttpMetaCache::evictEntry(MetaEntryPtr entry)
 	return false;
 }
 
+int HttpMetaCache::evictEntries(const QList<QPair<QString, QString>> &entries)
+{
+	waitForLoad();
+	int evicted = 0;
+	for(auto &item: entries)
+	{
+		auto map = shard(item.first);
+		if(!map)
+			continue;
+		QWriteLocker locker(&map->lock);
+		evicted += map->entry_list.remove(item.second);
+	}
+	if(evicted)
+	{
+		SaveEventually();
+	}
+	return evicted;
+}
+
 MetaEntryPtr HttpMetaCache::staleEntry(QString base, QString resource_path)
 {
 	auto foo = new MetaEntry();
@@ -157,61 +224,86 @@ MetaEntryPtr HttpMetaCache::staleEntry(QString base, QString resource_path)
 
 void HttpMetaCache::addBase(QString base, QString base_root)
 {
+	QWriteLocker locker(&m_basesLock);
 	// TODO: report error
 	if (m_entries.contains(base))
 		return;
 	// TODO: check if the base path is valid
-	EntryMap foo;
-	foo.base_path = base_root;
+	auto foo = std::make_shared<EntryMap>();
+	foo->base_path = base_root;
 	m_entries[base] = foo;
 }
 
 QString HttpMetaCache::getBasePath(QString base)
 {
-	if (m_entries.contains(base))
+	auto map = shard(base);
+	if (map)
 	{
-		return m_entries[base].base_path;
+		return map->base_path;
 	}
 	return QString();
 }
 
 void HttpMetaCache::Load()
 {
-	if(m_index_file.isNull())
+	waitForLoad();
+	addLoadedEntries(readIndex(m_index_file));
+}
+
+void HttpMetaCache::LoadInBackground()
+{
+	waitForLoad();
+	QMutexLocker locker(&m_loadLock);
+	m_loading = QtConcurrent::run(&HttpMetaCache::readIndex, m_index_file);
+	m_loadPending = true;
+}
+
+void HttpMetaCache::waitForLoad()
+{
+	if(!m_loadPending)
+		return;
+	QMutexLocker locker(&m_loadLock);
+	// someone else might have finished it while we waited for the lock
+	if(!m_loadPending)
 		return;
+	addLoadedEntries(m_loading.result());
+	m_loadPending = false;
+}
 
-	QFile index(m_index_file);
+QList<MetaEntryPtr> HttpMetaCache::readIndex(QString indexFile)
+{
+	QList<MetaEntryPtr> out;
+	if(indexFile.isNull())
+		return out;
+
+	QFile index(indexFile);
 	if (!index.open(QIODevice::ReadOnly))
-		return;
+		return out;
 
 	QJsonDocument json = QJsonDocument::fromJson(index.readAll());
 	if (!json.isObject())
-		return;
+		return out;
 	auto root = json.object();
 	// check file version first
 	auto version_val = root.value("version");
 	if (!version_val.isString())
-		return;
+		return out;
 	if (version_val.toString() != "1")
-		return;
+		return out;
 
 	// read the entry array
 	auto entries_val = root.value("entries");
 	if (!entries_val.isArray())
-		return;
+		return out;
 	QJsonArray array = entries_val.toArray();
 	for (auto element : array)
 	{
 		if (!element.isObject())
-			return;
+			return out;
 		auto element_obj = element.toObject();
-		QString base = element_obj.value("base").toString();
-		if (!m_entries.contains(base))
-			continue;
-		auto &entrymap = m_entries[base];
 		auto foo = new MetaEntry();
-		foo->baseId = base;
-		QString path = foo->relativePath = element_obj.value("path").toString();
+		foo->baseId = element_obj.value("base").toString();
+		foo->relativePath = element_obj.value("path").toString();
 		foo->md5sum = element_obj.value("md5sum").toString();
 		foo->etag = element_obj.value("etag").toString();
 		foo->local_changed_timestamp = element_obj.value("last_changed_timestamp").toDouble();
@@ -219,12 +311,33 @@ void HttpMetaCache::Load()
 			element_obj.value("remote_changed_timestamp").toString();
 		// presumed innocent until closer examination
 		foo->stale = false;
-		entrymap.entry_list[path] = MetaEntryPtr(foo);
+		out.append(MetaEntryPtr(foo));
+	}
+	return out;
+}
+
+void HttpMetaCache::addLoadedEntries(const QList<MetaEntryPtr> &entries)
+{
+	for (auto entry : entries)
+	{
+		auto map = shard(entry->baseId);
+		if (!map)
+			continue;
+		// set before anyone else can see the entry
+		entry->basePath = map->base_path;
+		QWriteLocker locker(&map->lock);
+		map->entry_list[entry->relativePath] = entry;
 	}
 }
 
 void HttpMetaCache::SaveEventually()
 {
+	if(QThread::currentThread() != thread())
+	{
+		// the timer lives on the cache's thread
+		QMetaObject::invokeMethod(this, "SaveEventually", Qt::QueuedConnection);
+		return;
+	}
 	// reset the save timer
 	saveBatchingTimer.stop();
 	saveBatchingTimer.start(30000);
@@ -234,18 +347,26 @@ void HttpMetaCache::SaveNow()
 {
 	if(m_index_file.isNull())
 		return;
+	waitForLoad();
 	QJsonObject toplevel;
 	toplevel.insert("version", QJsonValue(QString("1")));
 	QJsonArray entriesArr;
-	for (auto group : m_entries)
+	QList<EntryMapPtr> maps;
+	{
+		QReadLocker locker(&m_basesLock);
+		maps = m_entries.values();
+	}
+	for (auto group : maps)
 	{
-		for (auto entry : group.entry_list)
+		QReadLocker locker(&group->lock);
+		for (auto entry : group->entry_list)
 		{
 			// do not save stale entries. they are dead.
 			if(entry->stale)
 			{
 				continue;
 			}
+			QMutexLocker entryLocker(&entry->lock);
 			QJsonObject entryObj;
 			entryObj.insert("base", QJsonValue(entry->baseId));
 			entryObj.insert("path", QJsonValue(entry->relativePath));
@@ -268,6 +389,6 @@ void HttpMetaCache::SaveNow()
 	}
 	catch (Exception & e)
 	{
-		qWarning() << e.what();
+		qCWarning(logMetaCache) << e.what();
 	}
 }
@@ -16,13 +16,24 @@
 #pragma once
 #include <QString>
 #include <QMap>
+#include <QPair>
+#include <QList>
+#include <QMutex>
+#include <QReadWriteLock>
+#include <QStringList>
 #include <qtimer.h>
+#include <atomic>
 #include <memory>
+#include <QFuture>
 
 #include "multimc_logic_export.h"
 
 class HttpMetaCache;
 
+/*
+ * Entries are shared between threads: downloads finish on the network thread and the cache can be asked from anywhere.
+ * The location of an entry never changes, the rest is guarded by the entry's lock.
+ */
 class MULTIMC_LOGIC_EXPORT MetaEntry
 {
 friend class HttpMetaCache;
@@ -40,45 +51,57 @@ public:
 	QString getFullPath();
 	QString getRemoteChangedTimestamp()
 	{
+		QMutexLocker locker(&lock);
 		return remote_changed_timestamp;
 	}
 	void setRemoteChangedTimestamp(QString remote_changed_timestamp)
 	{
+		QMutexLocker locker(&lock);
 		this->remote_changed_timestamp = remote_changed_timestamp;
 	}
 	void setLocalChangedTimestamp(qint64 timestamp)
 	{
+		QMutexLocker locker(&lock);
 		local_changed_timestamp = timestamp;
 	}
 	QString getETag()
 	{
+		QMutexLocker locker(&lock);
 		return etag;
 	}
 	void setETag(QString etag)
 	{
+		QMutexLocker locker(&lock);
 		this->etag = etag;
 	}
 	QString getMD5Sum()
 	{
+		QMutexLocker locker(&lock);
 		return md5sum;
 	}
 	void setMD5Sum(QString md5sum)
 	{
+		QMutexLocker locker(&lock);
 		this->md5sum = md5sum;
 	}
 protected:
 	QString baseId;
 	QString basePath;
 	QString relativePath;
+	QMutex lock;
 	QString md5sum;
 	QString etag;
 	qint64 local_changed_timestamp = 0;
 	QString remote_changed_timestamp; // QString for now, RFC 2822 encoded time
-	bool stale = true;
+	std::atomic<bool> stale {true};
 };
 
 typedef std::shared_ptr<MetaEntry> MetaEntryPtr;
 
+/*
+ * All the methods can be called from any thread. Each base is a separate shard with its own lock,
+ * and the files are checked without holding any.
+ */
 class MULTIMC_LOGIC_EXPORT HttpMetaCache : public QObject
 {
 	Q_OBJECT
@@ -95,31 +118,53 @@ public:
 	MetaEntryPtr resolveEntry(QString base, QString resource_path,
 							  QString expected_etag = QString());
 
+	// resolveEntry for many resources of a base. They are checked in parallel, the result is in the same order.
+	QList<MetaEntryPtr> resolveEntries(QString base, const QStringList &resource_paths);
+
 	// add a previously resolved stale entry
 	bool updateEntry(MetaEntryPtr stale_entry);
 
 	// evict selected entry from cache
 	bool evictEntry(MetaEntryPtr entry);
 
+	// forget the entries given by base and resource path, all at once
+	int evictEntries(const QList<QPair<QString, QString>> &entries);
+
 	void addBase(QString base, QString base_root);
 
-	// (re)start a timer that calls SaveNow later.
-	void SaveEventually();
 	void Load();
+	// like Load, but the index is read on a worker thread. Anything that needs the entries waits for it.
+	void LoadInBackground();
 	QString getBasePath(QString base);
 public
 slots:
+	// (re)start a timer that calls SaveNow later.
+	void SaveEventually();
 	void SaveNow();
 
 private:
-	// create a new stale entry, given the parameters
-	MetaEntryPtr staleEntry(QString base, QString resource_path);
 	struct EntryMap
 	{
 		QString base_path;
 		QMap<QString, MetaEntryPtr> entry_list;
+		QReadWriteLock lock;
 	};
-	QMap<QString, EntryMap> m_entries;
+	typedef std::shared_ptr<EntryMap> EntryMapPtr;
+
+	// create a new stale entry, given the parameters
+	MetaEntryPtr staleEntry(QString base, QString resource_path);
+	EntryMapPtr shard(const QString &base);
+	// forget the entry, unless it was replaced in the meantime
+	void disown(EntryMapPtr map, const QString &resource_path, MetaEntryPtr entry);
+	static QList<MetaEntryPtr> readIndex(QString indexFile);
+	void addLoadedEntries(const QList<MetaEntryPtr> &entries);
+	void waitForLoad();
+
+	QMap<QString, EntryMapPtr> m_entries;
+	QReadWriteLock m_basesLock;
 	QString m_index_file;
 	QTimer saveBatchingTimer;
+	QMutex m_loadLock;
+	QFuture<QList<MetaEntryPtr>> m_loading;
+	std::atomic<bool> m_loadPending {false};
 };
@@ -0,0 +1,87 @@
+#include <QTest>
+#include <QTemporaryDir>
+#include <QtConcurrentRun>
+#include "TestUtil.h"
+
+#include "net/HttpMetaCache.h"
+#include "FileSystem.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QFileInfo>
+
+class HttpMetaCacheTest : public QObject
+{
+	Q_OBJECT
+private:
+	// put a file into the cache, as if it was just downloaded
+	void addFile(HttpMetaCache &cache, const QString &root, const QString &path, const QByteArray &data)
+	{
+		auto fullPath = FS::PathCombine(root, path);
+		FS::ensureFilePathExists(fullPath);
+		FS::write(fullPath, data);
+		auto entry = cache.resolveEntry("test", path);
+		QVERIFY(entry->isStale());
+		entry->setMD5Sum(QCryptographicHash::hash(data, QCryptographicHash::Md5).toHex().constData());
+		entry->setLocalChangedTimestamp(QFileInfo(fullPath).lastModified().toUTC().toMSecsSinceEpoch());
+		entry->setStale(false);
+		QVERIFY(cache.updateEntry(entry));
+	}
+
+	// move the modification time away from what the cache knows
+	void touch(const QString &path)
+	{
+		QFile file(path);
+		QVERIFY(file.open(QIODevice::ReadWrite));
+		QVERIFY(file.setFileTime(QDateTime::currentDateTime().addDays(-1), QFileDevice::FileModificationTime));
+	}
+
+private
+slots:
+	void test_resolveEntries()
+	{
+		QTemporaryDir tempDir;
+		auto root = tempDir.path();
+		HttpMetaCache cache;
+		cache.addBase("test", root);
+
+		QStringList paths;
+		for(int i = 0; i < 200; i++)
+		{
+			auto path = QString("objects/%1").arg(i);
+			addFile(cache, root, path, QByteArray::number(i));
+			paths.append(path);
+		}
+		paths.append("objects/missing");
+
+		// changed contents make the entry stale, the same contents with a new timestamp don't
+		FS::write(FS::PathCombine(root, "objects/5"), "something else");
+		touch(FS::PathCombine(root, "objects/5"));
+		touch(FS::PathCombine(root, "objects/6"));
+
+		// resolve from several threads at once
+		auto other = QtConcurrent::run([&]()
+		{
+			return cache.resolveEntries("test", paths);
+		});
+		auto entries = cache.resolveEntries("test", paths);
+		auto otherEntries = other.result();
+
+		QCOMPARE(entries.size(), paths.size());
+		QCOMPARE(otherEntries.size(), paths.size());
+		for(int i = 0; i < paths.size(); i++)
+		{
+			bool shouldBeStale = paths[i] == "objects/5" || paths[i] == "objects/missing";
+			QCOMPARE(entries[i]->isStale(), shouldBeStale);
+			QCOMPARE(otherEntries[i]->isStale(), shouldBeStale);
+			QCOMPARE(entries[i]->getFullPath(), FS::PathCombine(root, paths[i]));
+		}
+		// the stale one was dropped from the cache, the touched one is still there
+		QVERIFY(!cache.getEntry("test", "objects/5"));
+		QVERIFY(cache.getEntry("test", "objects/6"));
+	}
+};
+
+QTEST_GUILESS_MAIN(HttpMetaCacheTest)
+
+#include "HttpMetaCache_test.moc"
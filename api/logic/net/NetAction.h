@@ -68,7 +68,7 @@ public:
 	{
 		return m_progress;
 	}
-	virtual bool abort()
+	Q_INVOKABLE virtual bool abort()
 	{
 		return false;
 	}
@@ -14,9 +14,109 @@
  */
 
 #include "NetJob.h"
+#include "LoggingCategories.h"
 #include "Download.h"
+#include "Env.h"
 
+#include <QCoreApplication>
 #include <QDebug>
+#include <QPointer>
+#include <QThread>
+#include <QTimer>
+
+namespace {
+struct SharedPart
+{
+	QPointer<NetJob> owner;
+	int index = -1;
+	// what the owner's download checks the file for, see Net::Download::resultKey
+	QString resultKey;
+	// the owner is gone, but its download is still being aborted on the network thread
+	bool orphaned = false;
+	QList<QPair<QPointer<NetJob>, int>> waiting;
+};
+
+// key is the target file path. Only touched from the main thread.
+QHash<QString, SharedPart> & sharedParts()
+{
+	static QHash<QString, SharedPart> parts;
+	return parts;
+}
+
+QString sharedPartKey(NetActionPtr action)
+{
+	auto download = std::dynamic_pointer_cast<Net::Download>(action);
+	if(!download)
+	{
+		return QString();
+	}
+	return download->getTargetFilepath();
+}
+
+/*
+ * Plain downloads do their network, hashing and disk work on the network thread.
+ * The job stays where it is and only gets their progress and completion signals.
+ */
+bool runOnNetworkThread(NetActionPtr action)
+{
+	auto download = std::dynamic_pointer_cast<Net::Download>(action);
+	if(!download || (download->options() & Net::Download::Option::StayOnCallerThread))
+	{
+		return false;
+	}
+	auto networkThread = ENV.networkThread();
+	if(download->thread() == networkThread)
+	{
+		return true;
+	}
+	// only objects that aren't doing anything can move
+	if(download->isRunning() || download->thread() != QThread::currentThread())
+	{
+		return false;
+	}
+	download->moveToThread(networkThread);
+	return true;
+}
+}
+
+NetJob::~NetJob()
+{
+	for(auto index: m_doing)
+	{
+		auto part = downloads[index];
+		part->disconnect(this);
+		if(part->thread() == QThread::currentThread() || !part->thread()->isRunning())
+		{
+			part->abort();
+			releaseSharedPart(index, false);
+			continue;
+		}
+		// Never block on the network thread, it may be waiting for us. The part lives on until its abort went through,
+		// and only then the jobs waiting for the file get to write it on their own.
+		auto key = sharedPartKey(part);
+		auto &parts = sharedParts();
+		auto iter = parts.find(key);
+		if(iter == parts.end() || iter->owner != this || iter->index != index)
+		{
+			key.clear();
+		}
+		else
+		{
+			iter->orphaned = true;
+		}
+		QTimer::singleShot(0, part.get(), [part, key]()
+		{
+			part->abort();
+			if(!key.isEmpty())
+			{
+				QTimer::singleShot(0, QCoreApplication::instance(), [key]()
+				{
+					finishSharedPart(key, false);
+				});
+			}
+		});
+	}
+}
 
 void NetJob::partSucceeded(int index)
 {
@@ -27,6 +127,7 @@ void NetJob::partSucceeded(int index)
 	m_doing.remove(index);
 	m_done.insert(index);
 	downloads[index].get()->disconnect(this);
+	releaseSharedPart(index, true);
 	startMoreParts();
 }
 
@@ -44,6 +145,7 @@ void NetJob::partFailed(int index)
 		m_todo.enqueue(index);
 	}
 	downloads[index].get()->disconnect(this);
+	releaseSharedPart(index, false);
 	startMoreParts();
 }
 
@@ -53,6 +155,89 @@ void NetJob::partAborted(int index)
 	m_doing.remove(index);
 	m_failed.insert(index);
 	downloads[index].get()->disconnect(this);
+	releaseSharedPart(index, false);
+	startMoreParts();
+}
+
+bool NetJob::waitForSharedPart(int index)
+{
+	auto key = sharedPartKey(downloads[index]);
+	if(key.isEmpty())
+	{
+		return false;
+	}
+	auto &parts = sharedParts();
+	auto iter = parts.find(key);
+	if(iter != parts.end() && (iter->owner || iter->orphaned))
+	{
+		qCDebug(logNet) << "Waiting for another job to download" << key;
+		iter->waiting.append(qMakePair(QPointer<NetJob>(this), index));
+		m_waiting.insert(index);
+		return true;
+	}
+	auto &part = parts[key];
+	part.owner = this;
+	part.index = index;
+	part.resultKey = std::static_pointer_cast<Net::Download>(downloads[index])->resultKey();
+	return false;
+}
+
+void NetJob::releaseSharedPart(int index, bool succeeded)
+{
+	auto key = sharedPartKey(downloads[index]);
+	if(key.isEmpty())
+	{
+		return;
+	}
+	auto &parts = sharedParts();
+	auto iter = parts.find(key);
+	if(iter == parts.end() || iter->owner != this || iter->index != index)
+	{
+		return;
+	}
+	finishSharedPart(key, succeeded);
+}
+
+void NetJob::finishSharedPart(const QString &key, bool succeeded)
+{
+	auto &parts = sharedParts();
+	auto iter = parts.find(key);
+	if(iter == parts.end())
+	{
+		return;
+	}
+	auto waiting = iter->waiting;
+	auto resultKey = iter->resultKey;
+	parts.erase(iter);
+	for(auto &waiter: waiting)
+	{
+		if(waiter.first)
+		{
+			waiter.first->sharedPartFinished(waiter.second, succeeded, resultKey);
+		}
+	}
+}
+
+void NetJob::sharedPartFinished(int index, bool succeeded, const QString &resultKey)
+{
+	if(!m_waiting.remove(index))
+	{
+		return;
+	}
+	// the file is only good for us if it was checked the way we would check it
+	auto ourKey = std::static_pointer_cast<Net::Download>(downloads[index])->resultKey();
+	if(succeeded && !ourKey.isNull() && ourKey == resultKey)
+	{
+		// the file is there now, the download would be a cache hit or a needless repeat
+		auto &slot = parts_progress[index];
+		partProgress(index, slot.total_progress, slot.total_progress);
+		m_done.insert(index);
+	}
+	else
+	{
+		// try on our own. Nobody else is writing the file now.
+		m_todo.prepend(index);
+	}
 	startMoreParts();
 }
 
@@ -109,7 +294,7 @@ void NetJob::startMoreParts()
 	// Check for final conditions if there's nothing in the queue.
 	if(!m_todo.size())
 	{
-		if(!m_doing.size())
+		if(!m_doing.size() && !m_waiting.size())
 		{
 			if(!m_failed.size())
 			{
@@ -132,6 +317,10 @@ void NetJob::startMoreParts()
 		if(!m_todo.size())
 			return;
 		int doThis = m_todo.dequeue();
+		if(waitForSharedPart(doThis))
+		{
+			continue;
+		}
 		m_doing.insert(doThis);
 		auto part = downloads[doThis];
 		// connect signals :D
@@ -140,7 +329,14 @@ void NetJob::startMoreParts()
 		connect(part.get(), SIGNAL(aborted(int)), SLOT(partAborted(int)));
 		connect(part.get(), SIGNAL(netActionProgress(int, qint64, qint64)),
 				SLOT(partProgress(int, qint64, qint64)));
-		part->start();
+		if(runOnNetworkThread(part))
+		{
+			QMetaObject::invokeMethod(part.get(), "start", Qt::QueuedConnection);
+		}
+		else
+		{
+			part->start();
+		}
 	}
 }
 
@@ -180,11 +376,28 @@ bool NetJob::abort()
 	// fail all waiting
 	m_failed.unite(m_todo.toSet());
 	m_todo.clear();
+	// stop waiting for others
+	if(m_waiting.size())
+	{
+		m_failed.unite(m_waiting);
+		m_waiting.clear();
+		m_aborted = true;
+		if(!m_doing.size())
+		{
+			QMetaObject::invokeMethod(this, "startMoreParts", Qt::QueuedConnection);
+		}
+	}
 	// abort active
 	auto toKill = m_doing.toList();
 	for(auto index: toKill)
 	{
 		auto part = downloads[index];
+		if(part->thread() != thread())
+		{
+			// downloads abort on their own thread, reporting back like any other failure
+			QMetaObject::invokeMethod(part.get(), "abort", Qt::QueuedConnection);
+			continue;
+		}
 		fullyAborted &= part->abort();
 	}
 	return fullyAborted;
@@ -34,7 +34,7 @@ public:
 	{
 		setObjectName(job_name);
 	}
-	virtual ~NetJob() {}
+	virtual ~NetJob();
 
 	bool addNetAction(NetActionPtr action);
 
@@ -73,6 +73,18 @@ private slots:
 	void partFailed(int index);
 	void partAborted(int index);
 
+private:
+	/*
+	 * Downloads into the same file are shared between all jobs.
+	 * Only one of them downloads the file at a time, the others wait for it to finish and reuse the result
+	 * if it was checked the same way they would check it. Otherwise they download it again on their own.
+	 */
+	bool waitForSharedPart(int index);
+	void releaseSharedPart(int index, bool succeeded);
+	/// drop the shared part of a file and tell the jobs waiting for it
+	static void finishSharedPart(const QString &key, bool succeeded);
+	void sharedPartFinished(int index, bool succeeded, const QString &resultKey);
+
 private:
 	struct part_info
 	{
@@ -84,6 +96,7 @@ private:
 	QList<part_info> parts_progress;
 	QQueue<int> m_todo;
 	QSet<int> m_doing;
+	QSet<int> m_waiting;
 	QSet<int> m_done;
 	QSet<int> m_failed;
 	qint64 m_current_progress = 0;
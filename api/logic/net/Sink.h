@@ -5,6 +5,8 @@
 #include "multimc_logic_export.h"
 #include "Validator.h"
 
+#include <QStringList>
+
 namespace Net {
 class MULTIMC_LOGIC_EXPORT Sink
 {
@@ -27,6 +29,26 @@ public: /* methods */
 		}
 	}
 
+	/// Everything the validators insist on, sorted. Null if any of them can't say.
+	QString validationKey() const
+	{
+		QStringList expectations;
+		for(auto & validator: validators)
+		{
+			auto expectation = validator->expectation();
+			if(expectation.isNull())
+			{
+				return QString();
+			}
+			if(!expectation.isEmpty())
+			{
+				expectations.append(expectation);
+			}
+		}
+		expectations.sort();
+		return expectations.join(',');
+	}
+
 protected: /* methods */
 	bool finalizeAllValidators(QNetworkReply & reply)
 	{
@@ -16,5 +16,10 @@ public: /* methods */
 	virtual bool write(QByteArray & data) = 0;
 	virtual bool abort() = 0;
 	virtual bool validate(QNetworkReply & reply) = 0;
+	/// What this validator insists on, for comparing downloads. Null if it can't be described.
+	virtual QString expectation() const
+	{
+		return QString();
+	}
 };
 }
\ No newline at end of file
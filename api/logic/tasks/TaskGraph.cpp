@@ -0,0 +1,259 @@
+#include "TaskGraph.h"
+
+#include <QDebug>
+
+TaskGraph::TaskGraph(QObject *parent) : Task(parent)
+{
+}
+
+int TaskGraph::addTask(std::shared_ptr<Task> task, const QList<int> &dependencies)
+{
+	Node node;
+	node.task = task;
+	for(auto dependency: dependencies)
+	{
+		if(dependency < 0 || dependency >= m_nodes.size())
+		{
+			qWarning() << "TaskGraph: Ignoring dependency on unknown task" << dependency;
+			continue;
+		}
+		node.dependencies.append(dependency);
+	}
+	m_indexes[task.get()] = m_nodes.size();
+	m_nodes.append(node);
+	return m_nodes.size() - 1;
+}
+
+void TaskGraph::executeTask()
+{
+	startReadyTasks();
+}
+
+void TaskGraph::startReadyTasks()
+{
+	// tasks can finish as soon as they are started. Don't start things from inside the loop below.
+	if(m_starting)
+	{
+		m_startAgain = true;
+		return;
+	}
+	m_starting = true;
+	do
+	{
+		m_startAgain = false;
+		if(m_aborted || !m_failReason.isNull())
+		{
+			break;
+		}
+		for(int i = 0; i < m_nodes.size(); i++)
+		{
+			// a task may have failed synchronously while being started
+			if(m_aborted || !m_failReason.isNull())
+			{
+				break;
+			}
+			if(m_nodes[i].state != State::Waiting)
+			{
+				continue;
+			}
+			bool ready = true;
+			for(auto dependency: m_nodes[i].dependencies)
+			{
+				auto &other = m_nodes[dependency];
+				if(other.state != State::Done || !other.succeeded)
+				{
+					ready = false;
+					break;
+				}
+			}
+			if(ready && !startTask(i))
+			{
+				m_startAgain = true;
+			}
+		}
+	} while (m_startAgain);
+	m_starting = false;
+	finishIfDone();
+}
+
+bool TaskGraph::startTask(int index)
+{
+	auto &node = m_nodes[index];
+	auto task = node.task;
+	// if the task is already finished by the time we look at it, skip it
+	if(task->isFinished())
+	{
+		qDebug() << "TaskGraph: Skipping finished subtask" << index << ":" << task.get();
+		node.state = State::Done;
+		node.succeeded = task->wasSuccessful();
+		node.current = node.total;
+		updateProgress();
+		if(!node.succeeded)
+		{
+			failWith(task->failReason());
+		}
+		return false;
+	}
+	node.state = State::Running;
+	m_runningCount++;
+	connect(task.get(), SIGNAL(succeeded()), this, SLOT(subTaskSucceeded()));
+	connect(task.get(), SIGNAL(failed(QString)), this, SLOT(subTaskFailed(QString)));
+	connect(task.get(), SIGNAL(status(QString)), this, SLOT(subTaskStatus(QString)));
+	connect(task.get(), SIGNAL(progress(qint64, qint64)), this, SLOT(subTaskProgress(qint64, qint64)));
+	// if the task is already running, do not start it again
+	if(!task->isRunning())
+	{
+		task->start();
+	}
+	return true;
+}
+
+void TaskGraph::taskDone(int index)
+{
+	auto &node = m_nodes[index];
+	disconnect(node.task.get(), 0, this, 0);
+	node.state = State::Done;
+	m_runningCount--;
+}
+
+void TaskGraph::subTaskSucceeded()
+{
+	int index = m_indexes.value(sender(), -1);
+	if(index == -1 || m_nodes[index].state != State::Running)
+	{
+		return;
+	}
+	auto &node = m_nodes[index];
+	node.succeeded = true;
+	node.current = node.total;
+	taskDone(index);
+	updateProgress();
+	startReadyTasks();
+}
+
+void TaskGraph::subTaskFailed(const QString &msg)
+{
+	int index = m_indexes.value(sender(), -1);
+	if(index == -1 || m_nodes[index].state != State::Running)
+	{
+		return;
+	}
+	taskDone(index);
+	failWith(msg);
+	finishIfDone();
+}
+
+void TaskGraph::failWith(const QString &msg)
+{
+	// the first failure decides. Stop everything else.
+	if(!m_failReason.isNull() || m_aborted)
+	{
+		return;
+	}
+	m_failReason = msg.isNull() ? tr("A subtask failed.") : msg;
+	for(auto &node: m_nodes)
+	{
+		if(node.state == State::Running && node.task->canAbort())
+		{
+			node.task->abort();
+		}
+	}
+}
+
+void TaskGraph::subTaskStatus(const QString &msg)
+{
+	setStatus(msg);
+}
+
+void TaskGraph::subTaskProgress(qint64 current, qint64 total)
+{
+	int index = m_indexes.value(sender(), -1);
+	if(index == -1)
+	{
+		return;
+	}
+	auto &node = m_nodes[index];
+	node.current = current;
+	node.total = total;
+	updateProgress();
+}
+
+void TaskGraph::updateProgress()
+{
+	if(m_nodes.isEmpty())
+	{
+		return;
+	}
+	qint64 current = 0;
+	for(auto &node: m_nodes)
+	{
+		if(node.state == State::Done)
+		{
+			current += 1000;
+		}
+		else if(node.total > 0)
+		{
+			current += qBound<qint64>(0, node.current * 1000 / node.total, 1000);
+		}
+	}
+	setProgress(current, m_nodes.size() * 1000);
+}
+
+void TaskGraph::finishIfDone()
+{
+	if(m_starting || m_runningCount > 0 || !isRunning())
+	{
+		return;
+	}
+	if(m_aborted)
+	{
+		emitFailed(tr("Aborted by user."));
+		return;
+	}
+	if(!m_failReason.isNull())
+	{
+		emitFailed(m_failReason);
+		return;
+	}
+	for(auto &node: m_nodes)
+	{
+		if(node.state != State::Done)
+		{
+			qCritical() << "TaskGraph: Nothing is running, but not all tasks are done!";
+			emitFailed(tr("Some tasks could not be started."));
+			return;
+		}
+	}
+	emitSucceeded();
+}
+
+bool TaskGraph::abort()
+{
+	if(m_aborted)
+	{
+		return true;
+	}
+	m_aborted = true;
+	bool fullyAborted = true;
+	for(auto &node: m_nodes)
+	{
+		if(node.state == State::Running)
+		{
+			if(node.task->canAbort())
+			{
+				fullyAborted &= node.task->abort();
+			}
+			else
+			{
+				fullyAborted = false;
+			}
+		}
+	}
+	finishIfDone();
+	return fullyAborted;
+}
+
+bool TaskGraph::canAbort() const
+{
+	return true;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "Task.h"
+
+#include <QList>
+#include <QHash>
+#include <memory>
+
+#include "multimc_logic_export.h"
+
+/**
+ * Runs tasks as soon as the tasks they depend on have succeeded.
+ *
+ * Tasks can only depend on tasks added before them, so the graph can't have cycles.
+ * Tasks that become ready at the same time are started in the order they were added.
+ * If a task fails, the running ones are aborted and nothing new is started.
+ */
+class MULTIMC_LOGIC_EXPORT TaskGraph : public Task
+{
+	Q_OBJECT
+public:
+	explicit TaskGraph(QObject *parent = 0);
+
+	/**
+	 * Add a task that starts once all the tasks in `dependencies` succeeded.
+	 * Returns a handle that other tasks can depend on.
+	 */
+	int addTask(std::shared_ptr<Task> task, const QList<int> &dependencies = QList<int>());
+
+	bool canAbort() const override;
+
+public slots:
+	bool abort() override;
+
+protected:
+	void executeTask() override;
+
+private
+slots:
+	void subTaskSucceeded();
+	void subTaskFailed(const QString &msg);
+	void subTaskStatus(const QString &msg);
+	void subTaskProgress(qint64 current, qint64 total);
+
+private:
+	void startReadyTasks();
+	bool startTask(int index);
+	void taskDone(int index);
+	void failWith(const QString &msg);
+	void updateProgress();
+	void finishIfDone();
+
+private:
+	enum class State
+	{
+		Waiting,
+		Running,
+		Done
+	};
+	struct Node
+	{
+		std::shared_ptr<Task> task;
+		QList<int> dependencies;
+		State state = State::Waiting;
+		bool succeeded = false;
+		qint64 current = 0;
+		qint64 total = 1;
+	};
+	QList<Node> m_nodes;
+	QHash<QObject *, int> m_indexes;
+	int m_runningCount = 0;
+	bool m_starting = false;
+	bool m_startAgain = false;
+	bool m_aborted = false;
+	QString m_failReason;
+};
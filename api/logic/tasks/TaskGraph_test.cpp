@@ -0,0 +1,140 @@
+#include <QTest>
+#include <QSignalSpy>
+
+#include "TestUtil.h"
+
+#include "tasks/TaskGraph.h"
+
+// finishes when told to, records when it was started
+class ManualTask : public Task
+{
+	Q_OBJECT
+public:
+	ManualTask(QStringList *log, const QString &name) : m_log(log), m_name(name)
+	{
+	}
+	bool canAbort() const override
+	{
+		return true;
+	}
+	void finish(bool success)
+	{
+		if(success)
+			emitSucceeded();
+		else
+			emitFailed(m_name);
+	}
+
+public slots:
+	bool abort() override
+	{
+		emitAborted();
+		return true;
+	}
+
+protected:
+	void executeTask() override
+	{
+		m_log->append(m_name);
+	}
+
+private:
+	QStringList *m_log;
+	QString m_name;
+};
+
+class TaskGraphTest : public QObject
+{
+	Q_OBJECT
+private
+slots:
+	void test_order()
+	{
+		QStringList log;
+		auto a = std::make_shared<ManualTask>(&log, "a");
+		auto b = std::make_shared<ManualTask>(&log, "b");
+		auto c = std::make_shared<ManualTask>(&log, "c");
+		TaskGraph graph;
+		int ia = graph.addTask(a);
+		int ib = graph.addTask(b);
+		graph.addTask(c, {ia, ib});
+		QSignalSpy succeeded(&graph, SIGNAL(succeeded()));
+
+		graph.start();
+		QCOMPARE(log, QStringList({"a", "b"}));
+		b->finish(true);
+		QCOMPARE(log, QStringList({"a", "b"}));
+		a->finish(true);
+		QCOMPARE(log, QStringList({"a", "b", "c"}));
+		QCOMPARE(succeeded.count(), 0);
+		c->finish(true);
+		QCOMPARE(succeeded.count(), 1);
+		QCOMPARE(graph.getProgress(), graph.getTotalProgress());
+	}
+
+	void test_failure()
+	{
+		QStringList log;
+		auto a = std::make_shared<ManualTask>(&log, "a");
+		auto b = std::make_shared<ManualTask>(&log, "b");
+		auto c = std::make_shared<ManualTask>(&log, "c");
+		TaskGraph graph;
+		int ia = graph.addTask(a);
+		graph.addTask(b);
+		graph.addTask(c, {ia});
+		QSignalSpy failed(&graph, SIGNAL(failed(QString)));
+
+		graph.start();
+		a->finish(false);
+		// b got aborted, c never started
+		QVERIFY(b->isFinished());
+		QCOMPARE(log, QStringList({"a", "b"}));
+		QCOMPARE(failed.count(), 1);
+		QCOMPARE(failed.first().first().toString(), QString("a"));
+	}
+
+	void test_finishedBefore()
+	{
+		QStringList log;
+		auto a = std::make_shared<ManualTask>(&log, "a");
+		auto b = std::make_shared<ManualTask>(&log, "b");
+		// a shared task that already failed somewhere else
+		a->start();
+		a->finish(false);
+		TaskGraph graph;
+		int ia = graph.addTask(a);
+		graph.addTask(b, {ia});
+		QSignalSpy failed(&graph, SIGNAL(failed(QString)));
+
+		graph.start();
+		QCOMPARE(log, QStringList({"a"}));
+		QCOMPARE(failed.count(), 1);
+		QCOMPARE(failed.first().first().toString(), QString("a"));
+	}
+
+	void test_abort()
+	{
+		QStringList log;
+		auto a = std::make_shared<ManualTask>(&log, "a");
+		TaskGraph graph;
+		graph.addTask(a);
+		QSignalSpy failed(&graph, SIGNAL(failed(QString)));
+
+		graph.start();
+		QVERIFY(graph.abort());
+		QVERIFY(a->isFinished());
+		QCOMPARE(failed.count(), 1);
+	}
+
+	void test_empty()
+	{
+		TaskGraph graph;
+		QSignalSpy succeeded(&graph, SIGNAL(succeeded()));
+		graph.start();
+		QCOMPARE(succeeded.count(), 1);
+	}
+};
+
+QTEST_GUILESS_MAIN(TaskGraphTest)
+
+#include "TaskGraph_test.moc"
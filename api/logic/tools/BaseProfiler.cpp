@@ -29,6 +29,11 @@ void BaseProfiler::abortProfilingImpl()
 	emit abortLaunch(tr("Profiler aborted"));
 }
 
+bool BaseProfilerFactory::prepareLaunch(std::shared_ptr<LaunchTask>, QString *)
+{
+	return true;
+}
+
 BaseProfiler *BaseProfilerFactory::createProfiler(InstancePtr instance, QObject *parent)
 {
 	return qobject_cast<BaseProfiler *>(createTool(instance, parent));
@@ -35,4 +35,13 @@ class MULTIMC_LOGIC_EXPORT BaseProfilerFactory : public BaseExternalToolFactory
 {
 public:
 	virtual BaseProfiler *createProfiler(InstancePtr instance, QObject *parent = 0);
+
+	/// Does the profiler attach to the running game? If not, the game doesn't wait for it.
+	virtual bool attachesToProcess() const
+	{
+		return true;
+	}
+
+	/// Set up the launch before it starts, for profilers that need JVM arguments.
+	virtual bool prepareLaunch(std::shared_ptr<LaunchTask> launch, QString *error);
 };
@@ -0,0 +1,95 @@
+#include "JFRProfiler.h"
+
+#include <QDateTime>
+#include <QDir>
+
+#include "settings/SettingsObject.h"
+#include "launch/LaunchTask.h"
+#include "BaseInstance.h"
+#include "FileSystem.h"
+
+class JFRProfiler : public BaseProfiler
+{
+	Q_OBJECT
+public:
+	JFRProfiler(SettingsObjectPtr settings, InstancePtr instance, QObject *parent = 0);
+
+protected:
+	void beginProfilingImpl(std::shared_ptr<LaunchTask> process);
+};
+
+JFRProfiler::JFRProfiler(SettingsObjectPtr settings, InstancePtr instance, QObject *parent)
+	: BaseProfiler(settings, instance, parent)
+{
+	m_profilerProcess = nullptr;
+}
+
+void JFRProfiler::beginProfilingImpl(std::shared_ptr<LaunchTask> process)
+{
+	// the recording started with the JVM, there is nothing left to do
+	emit readyToLaunch(tr("Recording to %1").arg(process->profilerOutput()));
+}
+
+void JFRProfilerFactory::registerSettings(SettingsObjectPtr settings)
+{
+	// nothing to configure
+	globalSettings = settings;
+}
+
+BaseExternalTool *JFRProfilerFactory::createTool(InstancePtr instance, QObject *parent)
+{
+	return new JFRProfiler(globalSettings, instance, parent);
+}
+
+bool JFRProfilerFactory::check(QString *)
+{
+	// support depends on the instance's java, see prepareLaunch()
+	return true;
+}
+
+bool JFRProfilerFactory::check(const QString &, QString *)
+{
+	return true;
+}
+
+QStringList JFRProfilerFactory::recordingArguments(JavaVersion version, const QString &path, QString *error)
+{
+	// OpenJDK has it since 11, and 8 got a backport in update 262
+	bool supported = version.major() >= 11 || (version.major() == 8 && version.security() >= 262);
+	if(!supported)
+	{
+		*error = QObject::tr("Java Flight Recorder needs Java 8 update 262, Java 11 or newer. This instance uses Java %1.").arg(version.toString());
+		return {};
+	}
+	// the option value is a comma separated list, there's no way to escape one in the file name
+	if(path.contains(','))
+	{
+		*error = QObject::tr("The path to the recording can't contain commas: %1").arg(path);
+		return {};
+	}
+	return {QString("-XX:StartFlightRecording=name=MultiMC,settings=profile,dumponexit=true,filename=%1").arg(path)};
+}
+
+bool JFRProfilerFactory::prepareLaunch(std::shared_ptr<LaunchTask> launch, QString *error)
+{
+	auto instance = launch->instance();
+	auto folder = FS::PathCombine(instance->instanceRoot(), "recordings");
+	auto name = QDateTime::currentDateTime().toString("yyyy-MM-dd_HH-mm-ss") + ".jfr";
+	auto path = QDir(folder).absoluteFilePath(name);
+	JavaVersion version(instance->settings()->get("JavaVersion").toString());
+	auto args = recordingArguments(version, path, error);
+	if(args.isEmpty())
+	{
+		return false;
+	}
+	if(!FS::ensureFolderPathExists(folder))
+	{
+		*error = QObject::tr("Couldn't create the folder for recordings: %1").arg(folder);
+		return false;
+	}
+	launch->setExtraJavaArguments(args);
+	launch->setProfilerOutput(path);
+	return true;
+}
+
+#include "JFRProfiler.moc"
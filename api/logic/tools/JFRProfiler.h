@@ -0,0 +1,28 @@
+#pragma once
+
+#include "BaseProfiler.h"
+#include "java/JavaVersion.h"
+
+#include "multimc_logic_export.h"
+
+/**
+ * Java Flight Recorder, built into the JVM. Nothing to install and nothing to attach:
+ * the recording is started with the game and written into the instance folder when it exits.
+ */
+class MULTIMC_LOGIC_EXPORT JFRProfilerFactory : public BaseProfilerFactory
+{
+public:
+	QString name() const override { return "Java Flight Recorder"; }
+	void registerSettings(SettingsObjectPtr settings) override;
+	BaseExternalTool *createTool(InstancePtr instance, QObject *parent = 0) override;
+	bool check(QString *error) override;
+	bool check(const QString &path, QString *error) override;
+	bool attachesToProcess() const override
+	{
+		return false;
+	}
+	bool prepareLaunch(std::shared_ptr<LaunchTask> launch, QString *error) override;
+
+	/// JVM arguments that record into the file at path, or an empty list and an error if the runtime can't do it
+	static QStringList recordingArguments(JavaVersion version, const QString &path, QString *error);
+};
@@ -0,0 +1,45 @@
+#include <QTest>
+#include "TestUtil.h"
+
+#include "tools/JFRProfiler.h"
+
+class JFRProfilerTest : public QObject
+{
+	Q_OBJECT
+private
+slots:
+	void test_Arguments_data()
+	{
+		QTest::addColumn<QString>("version");
+		QTest::addColumn<bool>("supported");
+		QTest::newRow("1.7.0_80") << "1.7.0_80" << false;
+		QTest::newRow("1.8.0_151") << "1.8.0_151" << false;
+		QTest::newRow("1.8.0_262") << "1.8.0_262" << true;
+		QTest::newRow("9.0.4") << "9.0.4" << false;
+		QTest::newRow("11.0.2") << "11.0.2" << true;
+		QTest::newRow("17") << "17" << true;
+	}
+	void test_Arguments()
+	{
+		QFETCH(QString, version);
+		QFETCH(bool, supported);
+		QString error;
+		auto args = JFRProfilerFactory::recordingArguments(JavaVersion(version), "/instance/recordings/a.jfr", &error);
+		QCOMPARE(!args.isEmpty(), supported);
+		QCOMPARE(error.isEmpty(), supported);
+		if(supported)
+		{
+			QCOMPARE(args, QStringList() << "-XX:StartFlightRecording=name=MultiMC,settings=profile,dumponexit=true,filename=/instance/recordings/a.jfr");
+		}
+	}
+	void test_Commas()
+	{
+		QString error;
+		QVERIFY(JFRProfilerFactory::recordingArguments(JavaVersion("11"), "/my,instance/a.jfr", &error).isEmpty());
+		QVERIFY(!error.isEmpty());
+	}
+};
+
+QTEST_GUILESS_MAIN(JFRProfilerTest)
+
+#include "JFRProfiler_test.moc"
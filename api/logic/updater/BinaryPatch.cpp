@@ -0,0 +1,120 @@
+#include "BinaryPatch.h"
+#include "GZip.h"
+
+#include <climits>
+#include <cstring>
+
+namespace GoUpdate
+{
+
+static qint64 readOffset(const char *buf)
+{
+	const uchar *data = reinterpret_cast<const uchar *>(buf);
+	qint64 value = data[7] & 0x7F;
+	for (int i = 6; i >= 0; i--)
+	{
+		value = value * 256 + data[i];
+	}
+	if (data[7] & 0x80)
+	{
+		value = -value;
+	}
+	return value;
+}
+
+bool applyBinaryPatch(const QByteArray &base, const QByteArray &patch, QByteArray &result, QString &error)
+{
+	static const int headerSize = 32;
+	if (patch.size() < headerSize || !patch.startsWith("BSDIFFGZ"))
+	{
+		error = "Not a binary patch.";
+		return false;
+	}
+	qint64 ctrlLength = readOffset(patch.constData() + 8);
+	qint64 diffLength = readOffset(patch.constData() + 16);
+	qint64 newSize = readOffset(patch.constData() + 24);
+	// check the lengths one at a time, their sum can overflow
+	qint64 available = patch.size() - headerSize;
+	if (ctrlLength < 0 || ctrlLength > available)
+	{
+		error = "Corrupted binary patch header.";
+		return false;
+	}
+	available -= ctrlLength;
+	if (diffLength < 0 || diffLength > available || newSize < 0 || newSize > INT_MAX)
+	{
+		error = "Corrupted binary patch header.";
+		return false;
+	}
+
+	QByteArray ctrl, diff, extra;
+	if (!GZip::unzip(patch.mid(headerSize, ctrlLength), ctrl) ||
+		!GZip::unzip(patch.mid(headerSize + ctrlLength, diffLength), diff) ||
+		!GZip::unzip(patch.mid(headerSize + ctrlLength + diffLength), extra))
+	{
+		error = "Cannot decompress binary patch.";
+		return false;
+	}
+
+	result.fill(0, int(newSize));
+	if (result.size() != newSize)
+	{
+		error = "Cannot allocate the patched file.";
+		return false;
+	}
+	const qint64 resultSize = result.size();
+	const qint64 oldSize = base.size();
+	qint64 oldPos = 0, newPos = 0, ctrlPos = 0, diffPos = 0, extraPos = 0;
+	while (newPos < resultSize)
+	{
+		if (ctrl.size() - ctrlPos < 24)
+		{
+			error = "Binary patch control block is truncated.";
+			return false;
+		}
+		qint64 diffCount = readOffset(ctrl.constData() + ctrlPos);
+		qint64 extraCount = readOffset(ctrl.constData() + ctrlPos + 8);
+		qint64 seek = readOffset(ctrl.constData() + ctrlPos + 16);
+		ctrlPos += 24;
+
+		// add the diff block to the old data
+		if (diffCount < 0 || diffCount > resultSize - newPos || diffCount > diff.size() - diffPos)
+		{
+			error = "Binary patch diff block is corrupted.";
+			return false;
+		}
+		char *out = result.data() + newPos;
+		const char *diffData = diff.constData() + diffPos;
+		for (qint64 i = 0; i < diffCount; i++)
+		{
+			out[i] = diffData[i];
+			if (oldPos + i >= 0 && oldPos + i < oldSize)
+			{
+				out[i] += base.at(oldPos + i);
+			}
+		}
+		newPos += diffCount;
+		oldPos += diffCount;
+		diffPos += diffCount;
+
+		// copy the extra block as is
+		if (extraCount < 0 || extraCount > resultSize - newPos || extraCount > extra.size() - extraPos)
+		{
+			error = "Binary patch extra block is corrupted.";
+			return false;
+		}
+		memcpy(result.data() + newPos, extra.constData() + extraPos, extraCount);
+		newPos += extraCount;
+		extraPos += extraCount;
+
+		// keep the old position within reach of the old data so it cannot overflow
+		if (seek < -(oldPos + resultSize) || seek > oldSize + resultSize - oldPos)
+		{
+			error = "Binary patch seek is out of range.";
+			return false;
+		}
+		oldPos += seek;
+	}
+	return true;
+}
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <QByteArray>
+#include <QString>
+
+#include "multimc_logic_export.h"
+
+namespace GoUpdate
+{
+/*!
+ * Applies a bsdiff style binary patch to the data in `base`.
+ *
+ * The patch layout follows bsdiff 4, but the three blocks are gzip compressed instead of bzip2:
+ *
+ *   0   8   "BSDIFFGZ"
+ *   8   8   length of the compressed control block
+ *   16  8   length of the compressed diff block
+ *   24  8   size of the new file
+ *   32  ... control block, diff block, extra block
+ *
+ * The control block is a list of (diff length, extra length, seek) triples.
+ * All integers use the bsdiff encoding: little endian magnitude, sign in the top bit.
+ *
+ * @return false if the patch is malformed or doesn't fit the base
+ */
+bool MULTIMC_LOGIC_EXPORT applyBinaryPatch(const QByteArray &base, const QByteArray &patch, QByteArray &result, QString &error);
+}
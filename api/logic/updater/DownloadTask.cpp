@@ -18,6 +18,7 @@
 #include "updater/UpdateChecker.h"
 #include "GoUpdate.h"
 #include "net/NetJob.h"
+#include "FileSystem.h"
 
 #include <QFile>
 #include <QTemporaryDir>
@@ -120,20 +121,85 @@ void DownloadTask::processDownloadedVersionInfo()
 	NetJobPtr netJob (new NetJob("Update Files"));
 
 	// fill netJob and operationList
-	if (!processFileLists(m_currentVersionFileList, m_newVersionFileList, m_status.rootPath, m_updateFilesDir.path(), netJob, m_operations))
+	auto manifestPath = FS::PathCombine(m_status.rootPath, "updater-manifest.json");
+	if (!processFileLists(m_currentVersionFileList, m_newVersionFileList, m_status.rootPath, m_updateFilesDir.path(), netJob, m_operations, manifestPath, &m_deltas))
 	{
 		emitFailed(tr("Failed to process update lists..."));
 		return;
 	}
 
-	// Now start the download.
 	QObject::connect(netJob.get(), &NetJob::succeeded, this, &DownloadTask::fileDownloadFinished);
 	QObject::connect(netJob.get(), &NetJob::progress, this, &DownloadTask::fileDownloadProgressChanged);
 	QObject::connect(netJob.get(), &NetJob::failed, this, &DownloadTask::fileDownloadFailed);
+	m_filesNetJob = netJob;
+
+	// If some files can be patched, get the patches first. Whatever fails to patch is downloaded in full later.
+	if (m_deltas.size())
+	{
+		NetJobPtr deltasJob (new NetJob("Update Patches"));
+		for (auto & delta: m_deltas)
+		{
+			auto download = makeDeltaDownload(delta);
+			m_deltaDownloads.append(download);
+			if (download)
+			{
+				deltasJob->addNetAction(download);
+			}
+		}
+		QObject::connect(deltasJob.get(), &NetJob::succeeded, this, &DownloadTask::deltaDownloadFinished);
+		QObject::connect(deltasJob.get(), &NetJob::progress, this, &DownloadTask::fileDownloadProgressChanged);
+		QObject::connect(deltasJob.get(), &NetJob::failed, this, &DownloadTask::deltaDownloadFinished);
+
+		setStatus(tr("Downloading %1 update patches.").arg(QString::number(deltasJob->size())));
+		qDebug() << "Begin downloading update patches to" << m_updateFilesDir.path();
+		m_deltasNetJob = deltasJob;
+		m_deltasNetJob->start();
+		return;
+	}
 
+	// Now start the download.
 	setStatus(tr("Downloading %1 update files.").arg(QString::number(netJob->size())));
 	qDebug() << "Begin downloading update files to" << m_updateFilesDir.path();
-	m_filesNetJob = netJob;
+	m_filesNetJob->start();
+}
+
+void DownloadTask::deltaDownloadFinished()
+{
+	setStatus(tr("Applying update patches..."));
+	for (int i = 0; i < m_deltas.size(); i++)
+	{
+		auto & delta = m_deltas[i];
+		auto download = m_deltaDownloads[i];
+		QString error;
+		if (!download || !download->wasSuccessful())
+		{
+			qWarning() << "Could not download patch for" << delta.entry.path;
+		}
+		else if (!applyDelta(delta, error))
+		{
+			qWarning() << "Could not patch" << delta.entry.path << ":" << error;
+		}
+		else
+		{
+			qDebug() << "Patched" << delta.entry.path;
+			QFile::remove(delta.patchPath);
+			continue;
+		}
+		// fall back to downloading the whole file
+		auto fullDownload = makeSourceListDownload(delta.entry.sources, delta.targetPath, delta.entry.md5);
+		if (!fullDownload)
+		{
+			emitFailed(tr("Failed to patch %1 and there is nowhere to download it from.").arg(delta.entry.path));
+			return;
+		}
+		m_filesNetJob->addNetAction(fullDownload);
+	}
+	m_deltas.clear();
+	m_deltaDownloads.clear();
+	m_deltasNetJob.reset();
+
+	setStatus(tr("Downloading %1 update files.").arg(QString::number(m_filesNetJob->size())));
+	qDebug() << "Begin downloading update files to" << m_updateFilesDir.path();
 	m_filesNetJob->start();
 }
 
@@ -70,6 +70,9 @@ protected:
 	Net::Download::Ptr m_newVersionFileListDownload;
 
 	NetJobPtr m_filesNetJob;
+	NetJobPtr m_deltasNetJob;
+	DeltaOperationList m_deltas;
+	QList<Net::Download::Ptr> m_deltaDownloads;
 
 	Status m_status;
 
@@ -89,6 +92,12 @@ protected slots:
 	void processDownloadedVersionInfo();
 	void vinfoDownloadFailed();
 
+	/*!
+	 * Called when the patches finished downloading, successful or not.
+	 * Applies them and adds full downloads for the files that couldn't be patched to the file job.
+	 */
+	void deltaDownloadFinished();
+
 	void fileDownloadFinished();
 	void fileDownloadFailed(QString reason);
 	void fileDownloadProgressChanged(qint64 current, qint64 total);
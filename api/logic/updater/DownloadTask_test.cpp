@@ -2,11 +2,14 @@
 #include <QSignalSpy>
 
 #include "TestUtil.h"
+#include "TestHttpServer.h"
 
 #include "updater/GoUpdate.h"
 #include "updater/DownloadTask.h"
 #include "updater/UpdateChecker.h"
+#include "updater/BinaryPatch.h"
 #include <FileSystem.h>
+#include <GZip.h>
 
 using namespace GoUpdate;
 
@@ -19,6 +22,40 @@ FileSourceList encodeBaseFile(const char *suffix)
 	return FileSourceList({item});
 }
 
+QByteArray encodeOffset(qint64 value)
+{
+	QByteArray out(8, 0);
+	quint64 magnitude = value < 0 ? -value : value;
+	for (int i = 0; i < 8; i++)
+	{
+		out[i] = char(magnitude & 0xFF);
+		magnitude >>= 8;
+	}
+	if (value < 0)
+	{
+		out[7] = out[7] | 0x80;
+	}
+	return out;
+}
+
+// makes a trivial patch: diff over the common length, the rest of the target is extra data
+QByteArray makePatch(const QByteArray &base, const QByteArray &target)
+{
+	int common = qMin(base.size(), target.size());
+	QByteArray ctrl = encodeOffset(common) + encodeOffset(target.size() - common) + encodeOffset(0);
+	QByteArray diff(common, 0);
+	for (int i = 0; i < common; i++)
+	{
+		diff[i] = target[i] - base[i];
+	}
+	QByteArray extra = target.mid(common);
+	QByteArray zCtrl, zDiff, zExtra;
+	GZip::zip(ctrl, zCtrl);
+	GZip::zip(diff, zDiff);
+	GZip::zip(extra, zExtra);
+	return QByteArray("BSDIFFGZ") + encodeOffset(zCtrl.size()) + encodeOffset(zDiff.size()) + encodeOffset(target.size()) + zCtrl + zDiff + zExtra;
+}
+
 Q_DECLARE_METATYPE(VersionFileList)
 Q_DECLARE_METATYPE(Operation)
 
@@ -186,6 +223,164 @@ slots:
 		QCOMPARE(operations, expectedOperations);
 	}
 
+	void test_processFileLists_manifest()
+	{
+		QTemporaryDir tempFolderObj;
+		QString tempFolder = tempFolderObj.path();
+		QString manifestPath = FS::PathCombine(tempFolder, "manifest.json");
+
+		VersionFileList newVersion = VersionFileList()
+			<< VersionFileEntry{
+				   "data/fileTwo", 644,
+				   FileSourceList() << FileSource("http", "http://host/path/fileTwo-2"),
+				   "38f94f54fa3eb72b0ea836538c10b043"};
+
+		// the file is up to date, so it gets recorded in the manifest
+		OperationList operations;
+		QVERIFY(processFileLists(VersionFileList(), newVersion, QDir::currentPath(), tempFolder, new NetJob("Dummy"), operations, manifestPath));
+		QCOMPARE(operations, OperationList());
+		QVERIFY(QFile::exists(manifestPath));
+
+		// the manifest is trusted for files that did not change since. Make it lie to prove it.
+		QByteArray manifest = FS::read(manifestPath);
+		manifest.replace("38f94f54fa3eb72b0ea836538c10b043", "00000000000000000000000000000000");
+		FS::write(manifestPath, manifest);
+		QVERIFY(processFileLists(VersionFileList(), newVersion, QDir::currentPath(), tempFolder, new NetJob("Dummy"), operations, manifestPath));
+		QCOMPARE(operations, OperationList() << Operation::CopyOp(FS::PathCombine(tempFolder, "data_fileTwo"), "data/fileTwo", 644));
+	}
+
+	void test_applyBinaryPatch()
+	{
+		QByteArray base = FS::read("data/fileOneA");
+		QByteArray target = FS::read("data/fileOneB");
+		QByteArray result;
+		QString error;
+		QVERIFY(applyBinaryPatch(base, makePatch(base, target), result, error));
+		QCOMPARE(result, target);
+
+		// garbage is refused
+		QVERIFY(!applyBinaryPatch(base, "BSDIFF40 but not really", result, error));
+		QVERIFY(!applyBinaryPatch(base, makePatch(base, target).left(40), result, error));
+	}
+
+	void test_processFileLists_delta()
+	{
+		QTemporaryDir tempFolderObj;
+		QString tempFolder = tempFolderObj.path();
+
+		// fileOneA is installed, the new version is fileOneB and there's a patch from A to B
+		VersionFileEntry entry{"data/fileOneA", 493,
+							   FileSourceList() << FileSource("http", "http://host/path/fileOne-2"),
+							   "42915a71277c9016668cce7b82c6b577"};
+		entry.deltas << FileDelta{"9eb84090956c484e32cb6c08455a667b",
+								  FileSourceList() << FileSource("http", "http://host/path/fileOne-1-2.patch")};
+		QString dlPath = FS::PathCombine(tempFolder, "data_fileOneA");
+
+		OperationList operations;
+		DeltaOperationList deltas;
+		NetJobPtr job(new NetJob("Dummy"));
+		QVERIFY(processFileLists(VersionFileList(), VersionFileList() << entry, QDir::currentPath(), tempFolder, job, operations, QString(), &deltas));
+		QCOMPARE(operations, OperationList() << Operation::CopyOp(dlPath, "data/fileOneA", 493));
+		QCOMPARE(job->size(), 0);
+		QCOMPARE(deltas.size(), 1);
+		QCOMPARE(deltas[0].targetPath, dlPath);
+
+		// pretend the patch got downloaded
+		FS::write(deltas[0].patchPath, makePatch(FS::read("data/fileOneA"), FS::read("data/fileOneB")));
+		QString error;
+		QVERIFY(applyDelta(deltas[0], error));
+		QCOMPARE(FS::read(dlPath), FS::read("data/fileOneB"));
+
+		// a patch that produces the wrong file is refused
+		FS::write(deltas[0].patchPath, makePatch(FS::read("data/fileOneA"), FS::read("data/fileTwo")));
+		QVERIFY(!applyDelta(deltas[0], error));
+	}
+
+	void test_DownloadTask_delta()
+	{
+		TestHttpServer server;
+		QVERIFY(server.listen(QHostAddress::LocalHost));
+
+		// both files are installed as fileOneA and become fileOneB
+		QTemporaryDir rootObj;
+		QString root = rootObj.path();
+		QByteArray fileA = FS::read("data/fileOneA");
+		QByteArray fileB = FS::read("data/fileOneB");
+		FS::write(FS::PathCombine(root, "fileOne"), fileA);
+		FS::write(FS::PathCombine(root, "fileTwo"), fileA);
+
+		// fileOne has a good patch, the patch for fileTwo produces the wrong file
+		server.files["/fileOne.patch"] = makePatch(fileA, fileB);
+		server.files["/fileTwo.patch"] = makePatch(fileA, FS::read("data/fileTwo"));
+		server.files["/fileOneB"] = fileB;
+		auto entry = [&](const QString &path)
+		{
+			return QString(R"({"Path": "%1", "Perms": 493, "MD5": "42915a71277c9016668cce7b82c6b577",
+				"Sources": [{"SourceType": "http", "Url": "%2"}],
+				"Deltas": [{"BaseMD5": "9eb84090956c484e32cb6c08455a667b",
+					"Sources": [{"SourceType": "http", "Url": "%3"}]}]})")
+				.arg(path, server.url("/" + path + "-full"), server.url("/" + path + ".patch"));
+		};
+		server.files["/fileOne-full"] = fileB;
+		server.files["/fileTwo-full"] = fileB;
+		server.files["/2.json"] = QString(R"({"ApiVersion": 0, "Id": 2, "Name": "1.0.2", "Files": [%1, %2]})")
+			.arg(entry("fileOne"), entry("fileTwo")).toUtf8();
+
+		Status status;
+		status.newVersionId = 2;
+		status.newRepoUrl = server.url("/");
+		status.rootPath = root;
+
+		QTemporaryDir updateObj;
+		DownloadTask task(status, FS::PathCombine(updateObj.path(), "update-XXXXXX"));
+		QSignalSpy succeededSpy(&task, SIGNAL(succeeded()));
+		task.start();
+		QVERIFY(succeededSpy.wait(10000));
+
+		// fileOne was patched, fileTwo was downloaded in full after its patch turned out wrong
+		QVERIFY(server.requested.contains("/fileOne.patch"));
+		QVERIFY(!server.requested.contains("/fileOne-full"));
+		QVERIFY(server.requested.contains("/fileTwo.patch"));
+		QVERIFY(server.requested.contains("/fileTwo-full"));
+		QCOMPARE(FS::read(FS::PathCombine(task.updateFilesDir(), "fileOne")), fileB);
+		QCOMPARE(FS::read(FS::PathCombine(task.updateFilesDir(), "fileTwo")), fileB);
+		QCOMPARE(task.operations().size(), 2);
+		QDir(task.updateFilesDir()).removeRecursively();
+	}
+
+	void test_applyBinaryPatch_corrupt()
+	{
+		QByteArray base = FS::read("data/fileOneA");
+		QByteArray target = FS::read("data/fileOneB");
+		QByteArray patch = makePatch(base, target);
+		QByteArray result;
+		QString error;
+
+		// lengths whose sum overflows
+		QByteArray overflow = patch;
+		overflow.replace(8, 8, encodeOffset(Q_INT64_C(0x7FFFFFFFFFFFFFF0)));
+		overflow.replace(16, 8, encodeOffset(Q_INT64_C(0x7FFFFFFFFFFFFFF0)));
+		QVERIFY(!applyBinaryPatch(base, overflow, result, error));
+
+		// a new size that does not fit in a QByteArray
+		QByteArray huge = patch;
+		huge.replace(24, 8, encodeOffset(Q_INT64_C(0x100000010)));
+		QVERIFY(!applyBinaryPatch(base, huge, result, error));
+
+		// negative lengths
+		QByteArray negative = patch;
+		negative.replace(16, 8, encodeOffset(-1));
+		QVERIFY(!applyBinaryPatch(base, negative, result, error));
+
+		// control data that writes past the end of the result
+		QByteArray zCtrl, zDiff, zExtra;
+		GZip::zip(encodeOffset(0) + encodeOffset(Q_INT64_C(0x7FFFFFFFFFFFFFF0)) + encodeOffset(0), zCtrl);
+		GZip::zip(QByteArray(), zDiff);
+		GZip::zip(QByteArray(16, 'x'), zExtra);
+		QByteArray pastEnd = QByteArray("BSDIFFGZ") + encodeOffset(zCtrl.size()) + encodeOffset(zDiff.size()) + encodeOffset(8) + zCtrl + zDiff + zExtra;
+		QVERIFY(!applyBinaryPatch(base, pastEnd, result, error));
+	}
+
 	void test_OSXPathFixup()
 	{
 		QString path, pathOrig;
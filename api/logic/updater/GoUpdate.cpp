@@ -2,14 +2,38 @@
 #include <QDebug>
 #include <QDomDocument>
 #include <QFile>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QtConcurrentMap>
 #include <FileSystem.h>
 
 #include "net/Download.h"
 #include "net/ChecksumValidator.h"
+#include "BinaryPatch.h"
 
 namespace GoUpdate
 {
 
+static FileSourceList parseSources(const QJsonArray &sourceArray)
+{
+	FileSourceList sources;
+	for (QJsonValue val : sourceArray)
+	{
+		QJsonObject sourceObj = val.toObject();
+
+		QString type = sourceObj.value("SourceType").toString();
+		if (type == "http")
+		{
+			sources.append(FileSource("http", sourceObj.value("Url").toString()));
+		}
+		else
+		{
+			qWarning() << "Unknown source type" << type << "ignored.";
+		}
+	}
+	return sources;
+}
+
 bool parseVersionInfo(const QByteArray &data, VersionFileList &list, QString &error)
 {
 	QJsonParseError jsonError;
@@ -44,20 +68,16 @@ bool parseVersionInfo(const QByteArray &data, VersionFileList &list, QString &er
 							  FileSourceList(), fileObj.value("MD5").toString(), };
 		qDebug() << "File" << file.path << "with perms" << file.mode;
 
-		QJsonArray sourceArray = fileObj.value("Sources").toArray();
-		for (QJsonValue val : sourceArray)
-		{
-			QJsonObject sourceObj = val.toObject();
+		file.sources = parseSources(fileObj.value("Sources").toArray());
 
-			QString type = sourceObj.value("SourceType").toString();
-			if (type == "http")
-			{
-				file.sources.append(FileSource("http", sourceObj.value("Url").toString()));
-			}
-			else
-			{
-				qWarning() << "Unknown source type" << type << "ignored.";
-			}
+		QJsonArray deltaArray = fileObj.value("Deltas").toArray();
+		for (QJsonValue val : deltaArray)
+		{
+			QJsonObject deltaObj = val.toObject();
+			FileDelta delta;
+			delta.baseMd5 = deltaObj.value("BaseMD5").toString();
+			delta.sources = parseSources(deltaObj.value("Sources").toArray());
+			file.deltas.append(delta);
 		}
 
 		qDebug() << "Loaded info for" << file.path;
@@ -68,6 +88,151 @@ bool parseVersionInfo(const QByteArray &data, VersionFileList &list, QString &er
 	return true;
 }
 
+namespace
+{
+/// Result of checking one installed file against the file list
+struct InstalledFile
+{
+	QString path;
+	QString expectedMd5;
+	bool exists = false;
+	bool usable = true;
+	QString problem;
+	qint64 size = 0;
+	qint64 lastModified = 0;
+	QString md5;
+};
+
+/// What we know about a file that was verified before
+struct ManifestEntry
+{
+	qint64 size = 0;
+	qint64 lastModified = 0;
+	QString md5;
+};
+typedef QHash<QString, ManifestEntry> Manifest;
+
+Manifest loadManifest(const QString &manifestPath)
+{
+	Manifest manifest;
+	if(manifestPath.isEmpty() || !QFile::exists(manifestPath))
+	{
+		return manifest;
+	}
+	try
+	{
+		auto doc = QJsonDocument::fromJson(FS::read(manifestPath));
+		auto root = doc.object();
+		if(root.value("version").toString() != "1")
+		{
+			return manifest;
+		}
+		for(auto fileValue: root.value("files").toArray())
+		{
+			auto fileObj = fileValue.toObject();
+			ManifestEntry entry;
+			entry.size = fileObj.value("size").toDouble();
+			entry.lastModified = fileObj.value("lastModified").toDouble();
+			entry.md5 = fileObj.value("md5").toString();
+			manifest.insert(fileObj.value("path").toString(), entry);
+		}
+	}
+	catch (Exception & e)
+	{
+		qWarning() << "Failed to read the update manifest:" << e.what();
+	}
+	return manifest;
+}
+
+void saveManifest(const QString &manifestPath, const Manifest &manifest)
+{
+	QJsonArray files;
+	for(auto iter = manifest.begin(); iter != manifest.end(); iter++)
+	{
+		QJsonObject fileObj;
+		fileObj.insert("path", iter.key());
+		fileObj.insert("size", double(iter->size));
+		fileObj.insert("lastModified", double(iter->lastModified));
+		fileObj.insert("md5", iter->md5);
+		files.append(fileObj);
+	}
+	QJsonObject root;
+	root.insert("version", QString("1"));
+	root.insert("files", files);
+	try
+	{
+		FS::write(manifestPath, QJsonDocument(root).toJson());
+	}
+	catch (Exception & e)
+	{
+		qWarning() << "Failed to write the update manifest:" << e.what();
+	}
+}
+
+QString hashFile(QFile &input)
+{
+	QCryptographicHash hash(QCryptographicHash::Md5);
+	char buffer[64 * 1024];
+	qint64 read;
+	while ((read = input.read(buffer, sizeof(buffer))) > 0)
+	{
+		hash.addData(buffer, read);
+	}
+	if (read < 0)
+	{
+		return QString();
+	}
+	return hash.result().toHex();
+}
+
+/// Check one installed file. This runs on the thread pool, so it must not touch anything shared.
+void checkInstalledFile(InstalledFile &file, const Manifest &manifest, const QString &relativePath)
+{
+	QFileInfo entryInfo(file.path);
+	if (!entryInfo.exists())
+	{
+		return;
+	}
+	file.exists = true;
+	if (!entryInfo.isReadable())
+	{
+		file.usable = false;
+		file.problem = "is not readable.";
+		return;
+	}
+	if (!entryInfo.isWritable())
+	{
+		file.usable = false;
+		file.problem = "is not writable.";
+		return;
+	}
+	file.size = entryInfo.size();
+	file.lastModified = entryInfo.lastModified().toUTC().toMSecsSinceEpoch();
+
+	// the file didn't change since we last verified it -> no need to read it again
+	auto known = manifest.constFind(relativePath);
+	if (known != manifest.constEnd() && known->size == file.size && known->lastModified == file.lastModified)
+	{
+		file.md5 = known->md5;
+		return;
+	}
+
+	QFile entryFile(file.path);
+	if (!entryFile.open(QFile::ReadOnly))
+	{
+		file.usable = false;
+		file.problem = "cannot be opened for reading.";
+		return;
+	}
+	file.md5 = hashFile(entryFile);
+	if (file.md5.isNull())
+	{
+		file.usable = false;
+		file.problem = "cannot be read.";
+	}
+}
+}
+
 bool processFileLists
 (
 	const VersionFileList &currentVersion,
@@ -75,7 +240,8 @@ bool processFileLists
 	const QString &rootPath,
 	const QString &tempPath,
 	NetJobPtr job,
-	OperationList &ops
+	OperationList &ops,
+	const QString &manifestPath
 )
 {
 	// First, if we've loaded the current version's file list, we need to iterate through it and
@@ -111,93 +277,163 @@ bool processFileLists
 	}
 
 	// Next, check each file in MultiMC's folder and see if we need to update them.
-	for (VersionFileEntry entry : newVersion)
+	// The files are hashed on the thread pool, the results are processed in order below.
+	auto manifest = loadManifest(manifestPath);
+	QVector<InstalledFile> installed(newVersion.size());
+	QVector<int> indexes(newVersion.size());
+	for (int i = 0; i < newVersion.size(); i++)
+	{
+		installed[i].path = FS::PathCombine(rootPath, newVersion[i].path);
+		installed[i].expectedMd5 = newVersion[i].md5;
+		indexes[i] = i;
+	}
+	QtConcurrent::blockingMap(indexes, [&](int index)
 	{
-		// TODO: Let's not MD5sum a ton of files on the GUI thread. We should probably find a
-		// way to do this in the background.
-		QString fileMD5;
-		QString realEntryPath = FS::PathCombine(rootPath, entry.path);
-		QFile entryFile(realEntryPath);
-		QFileInfo entryInfo(realEntryPath);
+		checkInstalledFile(installed[index], manifest, newVersion[index].path);
+	});
 
-		bool needs_upgrade = false;
-		if (!entryFile.exists())
+	Manifest verified;
+	for (int i = 0; i < newVersion.size(); i++)
+	{
+		const VersionFileEntry &entry = newVersion[i];
+		const InstalledFile &file = installed[i];
+		QString realEntryPath = file.path;
+
+		if (!file.usable)
 		{
-			needs_upgrade = true;
+			qCritical() << "File " << realEntryPath << file.problem;
+			ops.clear();
+			return false;
 		}
-		else
+
+		bool needs_upgrade = false;
+		if (!file.exists)
 		{
-			bool pass = true;
-			if (!entryInfo.isReadable())
-			{
-				qCritical() << "File " << realEntryPath << " is not readable.";
-				pass = false;
-			}
-			if (!entryInfo.isWritable())
-			{
-				qCritical() << "File " << realEntryPath << " is not writable.";
-				pass = false;
-			}
-			if (!entryFile.open(QFile::ReadOnly))
-			{
-				qCritical() << "File " << realEntryPath << " cannot be opened for reading.";
-				pass = false;
-			}
-			if (!pass)
-			{
-				ops.clear();
-				return false;
-			}
+			needs_upgrade = true;
 		}
-
-		if(!needs_upgrade)
+		else if (file.md5 != entry.md5)
 		{
-			QCryptographicHash hash(QCryptographicHash::Md5);
-			auto foo = entryFile.readAll();
-
-			hash.addData(foo);
-			fileMD5 = hash.result().toHex();
-			if ((fileMD5 != entry.md5))
-			{
-				qDebug() << "MD5Sum does not match!";
-				qDebug() << "Expected:'" << entry.md5 << "'";
-				qDebug() << "Got:     '" << fileMD5 << "'";
-				needs_upgrade = true;
-			}
+			qDebug() << "MD5Sum does not match!";
+			qDebug() << "Expected:'" << entry.md5 << "'";
+			qDebug() << "Got:     '" << file.md5 << "'";
+			needs_upgrade = true;
 		}
 
 		// skip file. it doesn't need an upgrade.
 		if (!needs_upgrade)
 		{
 			qDebug() << "File" << realEntryPath << " does not need updating.";
+			ManifestEntry known;
+			known.size = file.size;
+			known.lastModified = file.lastModified;
+			known.md5 = file.md5;
+			verified.insert(entry.path, known);
 			continue;
 		}
 
 		// yep. this file actually needs an upgrade. PROCEED.
 		qDebug() << "Found file" << realEntryPath << " that needs updating.";
 
-		// Go through the sources list and find one to use.
-		// TODO: Make a NetAction that takes a source list and tries each of them until one
-		// works. For now, we'll just use the first http one.
-		for (FileSource source : entry.sources)
+		// Download it to updatedir/<filepath>-<md5> where filepath is the file's
+		// path with slashes replaced by underscores.
+		QString dlPath = FS::PathCombine(tempPath, QString(entry.path).replace("/", "_"));
+
+		// If there's a delta for the installed file, we only need to download the patch.
+		if (deltas && file.exists)
 		{
-			if (source.type != "http")
+			bool haveDelta = false;
+			for (auto & delta: entry.deltas)
+			{
+				if (delta.baseMd5 != file.md5)
+					continue;
+				qDebug() << "Will patch" << entry.path << "instead of downloading it.";
+				deltas->append(DeltaOperation{entry, delta, realEntryPath, dlPath + ".patch", dlPath});
+				haveDelta = true;
+				break;
+			}
+			if (haveDelta)
+			{
+				ops.append(Operation::CopyOp(dlPath, entry.path, entry.mode));
 				continue;
+			}
+		}
 
-			qDebug() << "Will download" << entry.path << "from" << source.url;
+		// We need to download the file to the updatefiles folder and add a task
+		// to copy it to its install path.
+		auto download = makeSourceListDownload(entry.sources, dlPath, entry.md5);
+		if (!download)
+		{
+			qWarning() << "No usable source for" << entry.path;
+			continue;
+		}
+		job->addNetAction(download);
+		ops.append(Operation::CopyOp(dlPath, entry.path, entry.mode));
+	}
 
-			// Download it to updatedir/<filepath>-<md5> where filepath is the file's
-			// path with slashes replaced by underscores.
-			QString dlPath = FS::PathCombine(tempPath, QString(entry.path).replace("/", "_"));
+	if (!manifestPath.isEmpty())
+	{
+		saveManifest(manifestPath, verified);
+	}
+	return true;
+}
 
-			// We need to download the file to the updatefiles folder and add a task
-			// to copy it to its install path.
-			auto download = Net::Download::makeFile(source.url, dlPath);
-			auto rawMd5 = QByteArray::fromHex(entry.md5.toLatin1());
-			download->addValidator(new Net::ChecksumValidator(QCryptographicHash::Md5, rawMd5));
-			job->addNetAction(download);
-			ops.append(Operation::CopyOp(dlPath, entry.path, entry.mode));
+Net::Download::Ptr makeSourceListDownload(const FileSourceList &sources, const QString &path, const QString &md5)
+{
+	// Go through the sources list and collect the usable ones.
+	// The download tries them in order until one of them works.
+	Net::Download::Ptr download;
+	for (FileSource source : sources)
+	{
+		if (source.type != "http")
+			continue;
+
+		if (!download)
+		{
+			qDebug() << "Will download" << path << "from" << source.url;
+			download = Net::Download::makeFile(source.url, path);
 		}
+		else
+		{
+			qDebug() << "Will fall back to" << source.url << "for" << path;
+			download->addMirror(source.url);
+		}
+	}
+	if (download && !md5.isEmpty())
+	{
+		auto rawMd5 = QByteArray::fromHex(md5.toLatin1());
+		download->addValidator(new Net::ChecksumValidator(QCryptographicHash::Md5, rawMd5));
+	}
+	return download;
+}
+
+Net::Download::Ptr makeDeltaDownload(const DeltaOperation &delta)
+{
+	return makeSourceListDownload(delta.delta.sources, delta.patchPath);
+}
+
+bool applyDelta(const DeltaOperation &delta, QString &error)
+{
+	try
+	{
+		auto base = FS::read(delta.basePath);
+		auto patch = FS::read(delta.patchPath);
+		QByteArray result;
+		if (!applyBinaryPatch(base, patch, result, error))
+		{
+			return false;
+		}
+		QString resultMd5 = QCryptographicHash::hash(result, QCryptographicHash::Md5).toHex();
+		if (resultMd5 != delta.entry.md5)
+		{
+			error = QString("Patched %1 has the wrong MD5: %2 instead of %3").arg(delta.entry.path, resultMd5, delta.entry.md5);
+			return false;
+		}
+		FS::write(delta.targetPath, result);
+	}
+	catch (Exception & e)
+	{
+		error = e.cause();
+		return false;
 	}
 	return true;
 }
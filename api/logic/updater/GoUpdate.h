@@ -1,6 +1,7 @@
 #pragma once
 #include <QByteArray>
 #include <net/NetJob.h>
+#include <net/Download.h>
 
 #include "multimc_logic_export.h"
 
@@ -47,6 +48,23 @@ struct MULTIMC_LOGIC_EXPORT FileSource
 };
 typedef QList<FileSource> FileSourceList;
 
+/**
+ * Struct that describes an entry in a VersionFileEntry's `Deltas` list.
+ *
+ * A delta is a binary patch (see BinaryPatch.h) that turns the file with the MD5 `baseMd5` into the new file.
+ */
+struct MULTIMC_LOGIC_EXPORT FileDelta
+{
+	bool operator==(const FileDelta &d2) const
+	{
+		return baseMd5 == d2.baseMd5 && sources == d2.sources;
+	}
+
+	QString baseMd5;
+	FileSourceList sources;
+};
+typedef QList<FileDelta> FileDeltaList;
+
 /**
  * Structure that describes an entry in a GoUpdate version's `Files` list.
  */
@@ -56,13 +74,36 @@ struct MULTIMC_LOGIC_EXPORT VersionFileEntry
 	int mode;
 	FileSourceList sources;
 	QString md5;
+	FileDeltaList deltas;
 	bool operator==(const VersionFileEntry &v2) const
 	{
-		return path == v2.path && mode == v2.mode && sources == v2.sources && md5 == v2.md5;
+		return path == v2.path && mode == v2.mode && sources == v2.sources && md5 == v2.md5 && deltas == v2.deltas;
 	}
 };
 typedef QList<VersionFileEntry> VersionFileList;
 
+/**
+ * Structure that describes a file that can be updated by patching the installed file instead of downloading it.
+ */
+struct MULTIMC_LOGIC_EXPORT DeltaOperation
+{
+	//! The file being updated. Used to fall back to a full download.
+	VersionFileEntry entry;
+
+	//! The delta matching the installed file.
+	FileDelta delta;
+
+	//! The installed file the patch applies to.
+	QString basePath;
+
+	//! Where the patch gets downloaded to.
+	QString patchPath;
+
+	//! Where the patched file is written. This is the same place a full download would go.
+	QString targetPath;
+};
+typedef QList<DeltaOperation> DeltaOperationList;
+
 /**
  * Structure that describes an operation to perform when installing updates.
  */
@@ -112,6 +153,12 @@ bool MULTIMC_LOGIC_EXPORT parseVersionInfo(const QByteArray &data, VersionFileLi
 /*!
  * Takes a list of file entries for the current version's files and the new version's files
  * and populates the downloadList and operationList with information about how to download and install the update.
+ *
+ * Installed files are hashed in parallel on the global thread pool.
+ * If manifestPath is set, it points to a manifest of the files verified by the last run. Files whose size
+ * and modification time didn't change since then are not hashed again. The manifest is updated afterwards.
+ *
+ * If deltas is set, files with a delta for the installed version go there instead of being added to the job.
  */
 bool MULTIMC_LOGIC_EXPORT processFileLists
 (
@@ -120,9 +167,30 @@ bool MULTIMC_LOGIC_EXPORT processFileLists
 	const QString &rootPath,
 	const QString &tempPath,
 	NetJobPtr job,
-	OperationList &ops
+	OperationList &ops,
+	const QString &manifestPath = QString(),
+	DeltaOperationList *deltas = nullptr
 );
 
+/*!
+ * Creates a download of a file that tries the given sources in order until one of them works.
+ *
+ * @return the download or nullptr if there is no usable source
+ */
+Net::Download::Ptr MULTIMC_LOGIC_EXPORT makeSourceListDownload(const FileSourceList &sources, const QString &path, const QString &md5 = QString());
+
+/*!
+ * Downloads the patch of a delta operation.
+ */
+Net::Download::Ptr MULTIMC_LOGIC_EXPORT makeDeltaDownload(const DeltaOperation &delta);
+
+/*!
+ * Applies a downloaded delta and checks the result against the MD5 of the new file.
+ *
+ * @return false if the result cannot be used. A full download is needed then.
+ */
+bool MULTIMC_LOGIC_EXPORT applyDelta(const DeltaOperation &delta, QString &error);
+
 /*!
  * This fixes destination paths for OSX - removes 'MultiMC.app' prefix
  * The updater runs in MultiMC.app/Contents/MacOs by default
@@ -2,6 +2,9 @@
 #include "MultiMC.h"
 #include <BaseInstance.h>
 #include <icons/IconList.h>
+#include <minecraft/MinecraftInstance.h>
+#include <minecraft/ComponentList.h>
+#include <minecraft/ProfilePatch.h>
 
 InstanceProxyModel::InstanceProxyModel(QObject *parent) : GroupedProxyModel(parent)
 {
@@ -17,6 +20,124 @@ QVariant InstanceProxyModel::data(const QModelIndex & index, int role) const
 	return data;
 }
 
+void InstanceProxyModel::setSourceModel(QAbstractItemModel *model)
+{
+	if(sourceModel())
+	{
+		disconnect(sourceModel(), &QAbstractItemModel::rowsInserted, this, &InstanceProxyModel::indexRows);
+		disconnect(sourceModel(), &QAbstractItemModel::rowsAboutToBeRemoved, this, &InstanceProxyModel::unindexRows);
+		disconnect(sourceModel(), &QAbstractItemModel::dataChanged, this, &InstanceProxyModel::indexChangedRows);
+		disconnect(sourceModel(), &QAbstractItemModel::modelReset, this, &InstanceProxyModel::reindex);
+	}
+	// the index has to be updated before the base class filters the new or changed rows, so connect first
+	if(model)
+	{
+		connect(model, &QAbstractItemModel::rowsInserted, this, &InstanceProxyModel::indexRows);
+		connect(model, &QAbstractItemModel::rowsAboutToBeRemoved, this, &InstanceProxyModel::unindexRows);
+		connect(model, &QAbstractItemModel::dataChanged, this, &InstanceProxyModel::indexChangedRows);
+		connect(model, &QAbstractItemModel::modelReset, this, &InstanceProxyModel::reindex);
+	}
+	GroupedProxyModel::setSourceModel(model);
+	reindex();
+	if(m_searchIndex.isFiltering())
+	{
+		invalidateFilter();
+	}
+}
+
+void InstanceProxyModel::setFilterQuery(const QString &query)
+{
+	// only touch the view when the result is different. The groups get laid out again after this.
+	if(m_searchIndex.setQuery(query))
+	{
+		invalidateFilter();
+	}
+}
+
+QStringList InstanceProxyModel::searchFields(BaseInstance *instance)
+{
+	QStringList fields {instance->name(), instance->group(), instance->notes()};
+	auto minecraft = dynamic_cast<MinecraftInstance *>(instance);
+	if(minecraft)
+	{
+		fields.append(minecraft->getComponentVersion("net.minecraft"));
+		// the names of components are only known once the profile is loaded. Loading all of them would be slow.
+		auto components = minecraft->getComponentList();
+		if(components && components->rowCount())
+		{
+			for(int i = 0; i < components->rowCount(); i++)
+			{
+				auto patch = components->versionPatch(i);
+				fields.append(patch->getName() + ' ' + patch->getVersion());
+			}
+		}
+		else
+		{
+			auto forge = minecraft->getComponentVersion("net.minecraftforge");
+			if(!forge.isEmpty())
+			{
+				fields.append("Forge " + forge);
+			}
+			auto liteloader = minecraft->getComponentVersion("com.mumfrey.liteloader");
+			if(!liteloader.isEmpty())
+			{
+				fields.append("LiteLoader " + liteloader);
+			}
+		}
+	}
+	return fields;
+}
+
+void InstanceProxyModel::indexRows(const QModelIndex &parent, int first, int last)
+{
+	for(int i = first; i <= last; i++)
+	{
+		auto instance = static_cast<BaseInstance *>(sourceModel()->index(i, 0, parent).internalPointer());
+		if(instance)
+		{
+			m_searchIndex.insert(instance->id(), searchFields(instance));
+		}
+	}
+}
+
+void InstanceProxyModel::unindexRows(const QModelIndex &parent, int first, int last)
+{
+	for(int i = first; i <= last; i++)
+	{
+		auto instance = static_cast<BaseInstance *>(sourceModel()->index(i, 0, parent).internalPointer());
+		if(instance)
+		{
+			m_searchIndex.remove(instance->id());
+		}
+	}
+}
+
+void InstanceProxyModel::indexChangedRows(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+{
+	indexRows(topLeft.parent(), topLeft.row(), bottomRight.row());
+}
+
+void InstanceProxyModel::reindex()
+{
+	auto query = m_searchIndex.query();
+	m_searchIndex.clear();
+	if(sourceModel())
+	{
+		indexRows(QModelIndex(), 0, sourceModel()->rowCount() - 1);
+	}
+	m_searchIndex.setQuery(query);
+}
+
+bool InstanceProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
+{
+	if(!m_searchIndex.isFiltering())
+	{
+		return true;
+	}
+	auto instance = static_cast<BaseInstance *>(sourceModel()->index(sourceRow, 0, sourceParent).internalPointer());
+	return instance && m_searchIndex.matches(instance->id());
+}
+
 bool InstanceProxyModel::subSortLessThan(const QModelIndex &left,
 										 const QModelIndex &right) const
 {
@@ -27,6 +148,17 @@ bool InstanceProxyModel::subSortLessThan(const QModelIndex &left,
 	{
 		return pdataLeft->lastLaunch() > pdataRight->lastLaunch();
 	}
+	else if (sortMode == "Size")
+	{
+		// biggest first, not yet measured ones last
+		auto sizeLeft = pdataLeft->diskUsage().total;
+		auto sizeRight = pdataRight->diskUsage().total;
+		if (sizeLeft != sizeRight)
+		{
+			return sizeLeft > sizeRight;
+		}
+		return QString::localeAwareCompare(pdataLeft->name(), pdataRight->name()) < 0;
+	}
 	else
 	{
 		return QString::localeAwareCompare(pdataLeft->name(), pdataRight->name()) < 0;
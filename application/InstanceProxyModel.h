@@ -1,16 +1,38 @@
 #pragma once
 
 #include "groupview/GroupedProxyModel.h"
+#include <InstanceSearchIndex.h>
+
+class BaseInstance;
 
 /**
- * A proxy model that is responsible for sorting instances into groups
+ * A proxy model that is responsible for sorting instances into groups and filtering them by a search query
  */
 class InstanceProxyModel : public GroupedProxyModel
 {
+	Q_OBJECT
+
 public:
 	explicit InstanceProxyModel(QObject *parent = 0);
 	QVariant data(const QModelIndex & index, int role) const override;
+	void setSourceModel(QAbstractItemModel *sourceModel) override;
+
+	/// show only the instances matching the query. Empty query shows everything.
+	void setFilterQuery(const QString &query);
 
 protected:
 	virtual bool subSortLessThan(const QModelIndex &left, const QModelIndex &right) const override;
+	virtual bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
+
+private slots:
+	void indexRows(const QModelIndex &parent, int first, int last);
+	void unindexRows(const QModelIndex &parent, int first, int last);
+	void indexChangedRows(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+	void reindex();
+
+private:
+	static QStringList searchFields(BaseInstance *instance);
+
+private:
+	InstanceSearchIndex m_searchIndex;
 };
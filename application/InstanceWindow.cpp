@@ -31,7 +31,7 @@
 #include "icons/IconList.h"
 
 InstanceWindow::InstanceWindow(InstancePtr instance, QWidget *parent)
-	: QMainWindow(parent), m_instance(instance)
+	: QMainWindow(parent), m_instance(instance), m_instanceLock(instance)
 {
 	setAttribute(Qt::WA_DeleteOnClose);
 
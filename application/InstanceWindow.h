@@ -21,6 +21,7 @@
 #include <QSystemTrayIcon>
 #include "launch/LaunchTask.h"
 #include "pages/BasePageContainer.h"
+#include "Usable.h"
 
 class QPushButton;
 class PageContainer;
@@ -65,6 +66,8 @@ private:
 private:
 	std::shared_ptr<LaunchTask> m_proc;
 	InstancePtr m_instance;
+	// keeps the instance models loaded while the window is open
+	UseLock m_instanceLock;
 	bool m_doNotSave = false;
 	PageContainer *m_container = nullptr;
 	QPushButton *m_closeButton = nullptr;
@@ -206,6 +206,17 @@ void LaunchController::launchInstance()
 		return;
 	}
 
+	if (m_profiler)
+	{
+		QString error;
+		if (!m_profiler->prepareLaunch(m_launcher, &error))
+		{
+			QMessageBox::critical(m_parentWidget, tr("Error"), tr("Couldn't start profiler: %1").arg(error));
+			emitFailed("Profiler startup failed");
+			return;
+		}
+	}
+
 	auto console = qobject_cast<InstanceWindow *>(m_parentWidget);
 	auto showConsole = m_instance->settings()->get("ShowConsole").toBool();
 	if(!console && showConsole)
@@ -224,7 +235,8 @@ void LaunchController::launchInstance()
 
 void LaunchController::readyForLaunch()
 {
-	if (!m_profiler)
+	// profilers that don't attach were set up along with the launch
+	if (!m_profiler || !m_profiler->attachesToProcess())
 	{
 		m_launcher->proceed();
 		return;
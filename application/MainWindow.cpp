@@ -41,6 +41,7 @@
 #include <QtWidgets/QMessageBox>
 #include <QtWidgets/QInputDialog>
 #include <QtWidgets/QLabel>
+#include <QtWidgets/QLineEdit>
 #include <QtWidgets/QToolButton>
 #include <QtWidgets/QWidgetAction>
 #include <QtWidgets/QProgressDialog>
@@ -715,6 +716,25 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new MainWindow
 	spacer->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
 	ui->mainToolBar->addWidget(spacer);
 
+	// Instance search, filters the instance view as you type
+	{
+		searchBox = new QLineEdit(this);
+		searchBox->setPlaceholderText(tr("Search instances"));
+		searchBox->setToolTip(tr("Filter instances by name, group, notes, Minecraft version or components."));
+		searchBox->setClearButtonEnabled(true);
+		searchBox->setMaximumWidth(250);
+		searchBox->installEventFilter(this);
+		ui->mainToolBar->addWidget(searchBox);
+		connect(searchBox, &QLineEdit::textChanged, proxymodel, &InstanceProxyModel::setFilterQuery);
+
+		auto findShortcut = new QShortcut(QKeySequence::Find, this);
+		connect(findShortcut, &QShortcut::activated, [this]()
+		{
+			searchBox->setFocus();
+			searchBox->selectAll();
+		});
+	}
+
 	accountMenu = new QMenu(this);
 
 	repopulateAccountsMenu();
@@ -1100,6 +1120,27 @@ bool MainWindow::eventFilter(QObject *obj, QEvent *ev)
 			}
 		}
 	}
+	else if (obj == searchBox)
+	{
+		if (ev->type() == QEvent::KeyPress)
+		{
+			QKeyEvent *keyEvent = static_cast<QKeyEvent *>(ev);
+			switch (keyEvent->key())
+			{
+			case Qt::Key_Escape:
+				searchBox->clear();
+				view->setFocus();
+				return true;
+			case Qt::Key_Down:
+			case Qt::Key_Enter:
+			case Qt::Key_Return:
+				view->setFocus();
+				return true;
+			default:
+				break;
+			}
+		}
+	}
 	return QMainWindow::eventFilter(obj, ev);
 }
 
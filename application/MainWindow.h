@@ -33,6 +33,7 @@ class QToolButton;
 class InstanceProxyModel;
 class LabeledToolButton;
 class QLabel;
+class QLineEdit;
 class MinecraftLauncher;
 class BaseProfilerFactory;
 class GroupView;
@@ -193,6 +194,7 @@ private:
 	// these are managed by Qt's memory management model!
 	GroupView *view = nullptr;
 	InstanceProxyModel *proxymodel = nullptr;
+	QLineEdit *searchBox = nullptr;
 	QToolButton *newsLabel = nullptr;
 	QLabel *m_statusLeft = nullptr;
 	ServerStatus *m_statusRight = nullptr;
@@ -2,6 +2,8 @@
 #include "BuildConfig.h"
 #include "MainWindow.h"
 #include "InstanceWindow.h"
+#include "PrefetchController.h"
+#include <minecraft/CacheGCTask.h>
 #include "pages/BasePageProvider.h"
 #include "pages/global/MultiMCPage.h"
 #include "pages/global/MinecraftPage.h"
@@ -31,7 +33,12 @@
 #include <QLibraryInfo>
 #include <QStringList>
 #include <QDebug>
+#include <QLoggingCategory>
 #include <QStyleFactory>
+#include <QTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
 
 #include "dialogs/CustomMessageBox.h"
 #include "InstanceList.h"
@@ -40,6 +47,8 @@
 #include <minecraft/auth/MojangAccountList.h>
 #include "icons/IconList.h"
 #include "net/HttpMetaCache.h"
+#include "AsyncLogWriter.h"
+#include "DiskUsageScanner.h"
 #include "net/URLConstants.h"
 #include "Env.h"
 
@@ -48,6 +57,7 @@
 #include "updater/UpdateChecker.h"
 
 #include "tools/JProfiler.h"
+#include "tools/JFRProfiler.h"
 #include "tools/JVisualVM.h"
 #include "tools/MCEditTool.h"
 
@@ -87,21 +97,31 @@ using namespace Commandline;
 static void appDebugOutput(QtMsgType type, const QMessageLogContext &context, const QString &msg)
 {
 	const char *levels = "DWCFIS";
-	const QString format("%1 %2 %3\n");
 
-	qint64 msecstotal = MMC->timeSinceStart();
-	qint64 seconds = msecstotal / 1000;
-	qint64 msecs = msecstotal % 1000;
-	QString foo;
-	char buf[1025] = {0};
-	::snprintf(buf, 1024, "%5lld.%03lld", seconds, msecs);
-
-	QString out = format.arg(buf).arg(levels[type]).arg(msg);
+	// the writer thread does the formatting and writing
+	if(context.category && qstrcmp(context.category, "default") != 0)
+	{
+		MMC->logWriter->write(MMC->timeSinceStart(), levels[type], QString("%1: %2").arg(context.category, msg));
+	}
+	else
+	{
+		MMC->logWriter->write(MMC->timeSinceStart(), levels[type], msg);
+	}
+	if(type == QtFatalMsg)
+	{
+		// about to abort, get everything on disk first
+		MMC->logWriter->stop();
+	}
+}
 
-	MMC->logFile->write(out.toUtf8());
-	MMC->logFile->flush();
-	QTextStream(stderr) << out.toLocal8Bit();
-	fflush(stderr);
+static void applyLoggingRules(QString rules)
+{
+	// no rules put the categories back to their defaults. QT_LOGGING_RULES still applies on top.
+	QLoggingCategory::setFilterRules(rules.replace(';', '\n'));
+	if(!rules.isEmpty())
+	{
+		qDebug() << "Applied logging rules:" << rules.split('\n');
+	}
 }
 
 MultiMC::MultiMC(int &argc, char **argv) : QApplication(argc, argv)
@@ -137,6 +157,7 @@ MultiMC::MultiMC(int &argc, char **argv) : QApplication(argc, argv)
 	setApplicationVersion(BuildConfig.printableVersionString());
 
 	startTime = QDateTime::currentDateTime();
+	m_startupTimer.start();
 
 	// Don't quit on hiding the last window
 	this->setQuitOnLastWindowClosed(false);
@@ -166,6 +187,17 @@ MultiMC::MultiMC(int &argc, char **argv) : QApplication(argc, argv)
 		// --alive
 		parser.addSwitch("alive");
 		parser.addDocumentation("alive", "write a small '" + liveCheckFile + "' file after MultiMC starts");
+		// --startup-timing
+		parser.addSwitch("startup-timing");
+		parser.addDocumentation("startup-timing", "print how long the individual startup phases took once the main window is shown");
+		// --cache-gc
+		parser.addOption("cache-gc");
+		parser.addDocumentation("cache-gc", "find the library and asset files no instance uses anymore ('report'), "
+											"or delete them ('delete'), without showing any windows, print a JSON summary and exit");
+		// --prefetch
+		parser.addOption("prefetch");
+		parser.addDocumentation("prefetch", "download everything the specified instances need (comma separated IDs, or 'all') "
+											"without showing any windows, print a JSON summary and exit");
 
 		// parse the arguments
 		try
@@ -200,6 +232,19 @@ MultiMC::MultiMC(int &argc, char **argv) : QApplication(argc, argv)
 	}
 	m_instanceIdToLaunch = args["launch"].toString();
 	m_liveCheck = args["alive"].toBool();
+	m_startupTiming = args["startup-timing"].toBool();
+	QString prefetchParam = args["prefetch"].toString();
+	if(!prefetchParam.isEmpty())
+	{
+		m_instanceIdsToPrefetch = prefetchParam.split(',', QString::SkipEmptyParts);
+	}
+	m_cacheGCMode = args["cache-gc"].toString();
+	if(!m_cacheGCMode.isEmpty() && m_cacheGCMode != "report" && m_cacheGCMode != "delete")
+	{
+		std::cerr << "Invalid --cache-gc mode: " << m_cacheGCMode.toStdString() << ", use 'report' or 'delete'." << std::endl;
+		m_status = MultiMC::Failed;
+		return;
+	}
 
 	QString origcwdPath = QDir::currentPath();
 	QString binPath = applicationDirPath();
@@ -271,6 +316,12 @@ MultiMC::MultiMC(int &argc, char **argv) : QApplication(argc, argv)
 		connect(m_peerInstance, &LocalPeer::messageReceived, this, &MultiMC::messageReceived);
 		if(m_peerInstance->isClient())
 		{
+			if(isHeadless())
+			{
+				std::cerr << "MultiMC is already running with this data folder. Close it first." << std::endl;
+				m_status = MultiMC::Failed;
+				return;
+			}
 			if(m_instanceIdToLaunch.isEmpty())
 			{
 				m_peerInstance->sendMessage("activate", 2000);
@@ -299,9 +350,10 @@ MultiMC::MultiMC(int &argc, char **argv) : QApplication(argc, argv)
 		moveFile(logBase.arg(1), logBase.arg(2));
 		moveFile(logBase.arg(0), logBase.arg(1));
 
-		logFile = std::unique_ptr<QFile>(new QFile(logBase.arg(0)));
+		auto logFile = new QFile(logBase.arg(0));
 		if(!logFile->open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate))
 		{
+			delete logFile;
 			showFatalErrorMessage(
 				"MultiMC data folder is not writable!",
 				"MultiMC couldn't create a log file - the MultiMC data folder is not writable.\n"
@@ -315,6 +367,7 @@ MultiMC::MultiMC(int &argc, char **argv) : QApplication(argc, argv)
 			);
 			return;
 		}
+		logWriter.reset(new AsyncLogWriter(logFile, true));
 		qInstallMessageHandler(appDebugOutput);
 		qDebug() << "<> Log initialized.";
 	}
@@ -432,9 +485,15 @@ MultiMC::MultiMC(int &argc, char **argv) : QApplication(argc, argv)
 		// Editors
 		m_settings->registerSetting("JsonEditor", QString());
 
+		// How many instances not open in a window keep their mod lists, worlds and components loaded. -1 is no limit.
+		m_settings->registerSetting("InstanceModelBudget", 10);
+
 		// Language
 		m_settings->registerSetting("Language", QString());
 
+		// Logging rules for the categories of MultiMC's own log, like "multimc.net.debug=true;multimc.fs.debug=true"
+		m_settings->registerSetting("LoggingRules", QString());
+
 		// Console
 		m_settings->registerSetting("ShowConsole", false);
 		m_settings->registerSetting("AutoCloseConsole", false);
@@ -465,6 +524,8 @@ MultiMC::MultiMC(int &argc, char **argv) : QApplication(argc, argv)
 		m_settings->registerSetting("JavaVersion", "");
 		m_settings->registerSetting("LastHostname", "");
 		m_settings->registerSetting("JvmArgs", "");
+		m_settings->registerSetting("UseClassDataSharing", false);
+		m_settings->registerSetting("EnableGCLogging", false);
 
 		// Minecraft launch method
 		m_settings->registerSetting("MCLaunchMethod", "LauncherPart");
@@ -476,6 +537,11 @@ MultiMC::MultiMC(int &argc, char **argv) : QApplication(argc, argv)
 		m_settings->registerSetting({"PreLaunchCommand", "PreLaunchCmd"}, "");
 		m_settings->registerSetting({"PostExitCommand", "PostExitCmd"}, "");
 
+		// How many world backups to keep, see WorldBackupRetention
+		m_settings->registerSetting("WorldBackupKeepLast", 10);
+		m_settings->registerSetting("WorldBackupKeepDaily", 7);
+		m_settings->registerSetting("WorldBackupKeepWeekly", 4);
+
 		// The cat
 		m_settings->registerSetting("TheCat", false);
 
@@ -518,7 +584,18 @@ MultiMC::MultiMC(int &argc, char **argv) : QApplication(argc, argv)
 			m_globalSettingsProvider->addPage<AccountListPage>();
 			m_globalSettingsProvider->addPage<PasteEEPage>();
 		}
+		auto loggingRules = m_settings->getSetting("LoggingRules");
+		applyLoggingRules(loggingRules->get().toString());
+		connect(loggingRules.get(), &Setting::SettingChanged, [](const Setting &, QVariant value)
+		{
+			applyLoggingRules(value.toString());
+		});
+		connect(loggingRules.get(), &Setting::settingReset, [](const Setting &setting)
+		{
+			applyLoggingRules(setting.defValue().toString());
+		});
 		qDebug() << "<> Settings loaded.";
+		startupPhase("settings");
 	}
 
 	// load translations
@@ -528,6 +605,7 @@ MultiMC::MultiMC(int &argc, char **argv) : QApplication(argc, argv)
 		m_translations->selectLanguage(bcp47Name);
 		qDebug() << "Your language is" << bcp47Name;
 		qDebug() << "<> Translations loaded.";
+		startupPhase("translations");
 	}
 
 	// initialize the updater
@@ -536,6 +614,7 @@ MultiMC::MultiMC(int &argc, char **argv) : QApplication(argc, argv)
 		m_updateChecker.reset(new UpdateChecker(BuildConfig.CHANLIST_URL, BuildConfig.VERSION_CHANNEL, BuildConfig.VERSION_BUILD));
 		qDebug() << "<> Updater started.";
 	}
+	startupPhase("updater");
 
 	// Instance icons
 	{
@@ -553,6 +632,7 @@ MultiMC::MultiMC(int &argc, char **argv) : QApplication(argc, argv)
 		});
 		ENV.registerIconList(m_icons);
 		qDebug() << "<> Instance icons intialized.";
+		startupPhase("icons");
 	}
 
 	// Icon themes
@@ -577,6 +657,14 @@ MultiMC::MultiMC(int &argc, char **argv) : QApplication(argc, argv)
 		insertTheme(new BrightTheme());
 		insertTheme(new CustomTheme(darkTheme, "custom"));
 		qDebug() << "<> Widget themes initialized.";
+		startupPhase("themes");
+	}
+
+	// init the http meta cache - the index is read in the background while the instances load
+	{
+		ENV.initHttpMetaCache();
+		qDebug() << "<> Cache initialized.";
+		startupPhase("metacache");
 	}
 
 	// initialize and load all instances
@@ -596,7 +684,9 @@ MultiMC::MultiMC(int &argc, char **argv) : QApplication(argc, argv)
 		m_instances->addInstanceProvider(m_instanceFolder);
 		qDebug() << "Loading Instances...";
 		m_instances->loadList(true);
+		m_instances->setModelBudget(m_settings->get("InstanceModelBudget").toInt());
 		qDebug() << "<> Instances loaded.";
+		startupPhase("instances");
 	}
 
 	// and accounts
@@ -606,12 +696,7 @@ MultiMC::MultiMC(int &argc, char **argv) : QApplication(argc, argv)
 		m_accounts->setListFilePath("accounts.json", true);
 		m_accounts->loadList();
 		qDebug() << "<> Accounts loaded.";
-	}
-
-	// init the http meta cache
-	{
-		ENV.initHttpMetaCache();
-		qDebug() << "<> Cache initialized.";
+		startupPhase("accounts");
 	}
 
 	// init proxy settings
@@ -623,14 +708,32 @@ MultiMC::MultiMC(int &argc, char **argv) : QApplication(argc, argv)
 		QString pass = settings()->get("ProxyPass").toString();
 		ENV.updateProxySettings(proxyTypeStr, addr, port, user, pass);
 		qDebug() << "<> Proxy settings done.";
+		startupPhase("proxy");
+	}
+
+	// nothing else is needed for the headless modes
+	if(!m_instanceIdsToPrefetch.isEmpty())
+	{
+		performPrefetch();
+		return;
+	}
+	if(!m_cacheGCMode.isEmpty())
+	{
+		performCacheGC();
+		return;
 	}
 
-	// now we have network, download translation updates
-	m_translations->downloadIndex();
+	// measure the disk usage of instances in the background, once the startup rush is over
+	{
+		m_diskUsageScanner.reset(new DiskUsageScanner(m_instances.get(), FS::PathCombine("cache", "diskusage.json")));
+		m_diskUsageScanner->start(30 * 1000, 15 * 60 * 1000);
+		startupPhase("disk usage");
+	}
 
 	//FIXME: what to do with these?
 	m_profilers.insert("jprofiler", std::shared_ptr<BaseProfilerFactory>(new JProfilerFactory()));
 	m_profilers.insert("jvisualvm", std::shared_ptr<BaseProfilerFactory>(new JVisualVMFactory()));
+	m_profilers.insert("jfr", std::shared_ptr<BaseProfilerFactory>(new JFRProfilerFactory()));
 	for (auto profiler : m_profilers.values())
 	{
 		profiler->registerSettings(m_settings);
@@ -640,16 +743,16 @@ MultiMC::MultiMC(int &argc, char **argv) : QApplication(argc, argv)
 	{
 		m_mcedit.reset(new MCEditTool(m_settings));
 	}
+	startupPhase("tools");
 
 	connect(this, &MultiMC::aboutToQuit, [this](){
 		if(m_instances)
 		{
 			// m_instances->saveGroupList();
 		}
-		if(logFile)
+		if(logWriter)
 		{
-			logFile->flush();
-			logFile->close();
+			logWriter->stop();
 		}
 	});
 
@@ -658,6 +761,7 @@ MultiMC::MultiMC(int &argc, char **argv) : QApplication(argc, argv)
 		qDebug() << "<> Icon theme set.";
 		setApplicationTheme(settings()->get("ApplicationTheme").toString(), true);
 		qDebug() << "<> Application theme set.";
+		startupPhase("apply themes");
 	}
 
 	// Initialize analytics
@@ -698,9 +802,12 @@ MultiMC::MultiMC(int &argc, char **argv) : QApplication(argc, argv)
 		m_analytics->enable();
 		qDebug() << "<> Initialized analytics with tid" << BuildConfig.ANALYTICS_ID;
 	}();
+	startupPhase("analytics");
 
 	if(createSetupWizard())
 	{
+		// the language page wants the list of translations
+		m_translations->downloadIndex();
 		return;
 	}
 	performMainStartupAction();
@@ -774,12 +881,15 @@ bool MultiMC::createSetupWizard()
 void MultiMC::setupWizardFinished(int status)
 {
 	qDebug() << "Wizard result =" << status;
+	startupPhase("setup wizard");
 	performMainStartupAction();
 }
 
 void MultiMC::performMainStartupAction()
 {
 	m_status = MultiMC::Initialized;
+	// things the first window doesn't need happen after it's on screen
+	QTimer::singleShot(0, this, &MultiMC::performDeferredStartup);
 	if(!m_instanceIdToLaunch.isEmpty())
 	{
 		auto inst = instances()->getInstanceById(m_instanceIdToLaunch);
@@ -795,12 +905,114 @@ void MultiMC::performMainStartupAction()
 		// normal main window
 		showMainWindow(false);
 		qDebug() << "<> Main window shown.";
+		startupPhase("main window");
+	}
+}
+
+void MultiMC::performDeferredStartup()
+{
+	startupPhase("first paint");
+
+	// now we have network, download translation updates. The setup wizard already did if it was shown.
+	if(!m_setupWizard)
+	{
+		m_translations->downloadIndex();
+	}
+
+	if(m_startupTiming)
+	{
+		QString report = "Startup timing:\n";
+		qint64 total = 0;
+		for(auto &phase: m_startupPhases)
+		{
+			total += phase.second;
+			report += QString("  %1 %2 ms\n").arg(phase.first, -16).arg(phase.second, 6);
+		}
+		report += QString("  %1 %2 ms\n").arg("total", -16).arg(total, 6);
+		qDebug().noquote() << report;
+		std::cerr << qPrintable(report) << std::flush;
 	}
 }
 
+void MultiMC::startupPhase(const QString &name)
+{
+	m_startupPhases.append(qMakePair(name, m_startupTimer.restart()));
+}
+
+void MultiMC::performPrefetch()
+{
+	QList<InstancePtr> selected;
+	if(m_instanceIdsToPrefetch == QStringList({"all"}))
+	{
+		for(int i = 0; i < m_instances->count(); i++)
+		{
+			selected.append(m_instances->at(i));
+		}
+	}
+	else
+	{
+		for(auto &id: m_instanceIdsToPrefetch)
+		{
+			auto inst = m_instances->getInstanceById(id);
+			if(!inst)
+			{
+				std::cerr << "Instance not found: " << id.toStdString() << std::endl;
+				m_status = MultiMC::Failed;
+				return;
+			}
+			selected.append(inst);
+		}
+	}
+	qDebug() << "<> Prefetching" << selected.size() << "instances.";
+
+	m_prefetchController.reset(new PrefetchController());
+	m_prefetchController->setInstances(selected);
+	connect(m_prefetchController.get(), &Task::finished, [this]()
+	{
+		auto summary = QJsonDocument(m_prefetchController->summary()).toJson(QJsonDocument::Indented);
+		std::cout << summary.constData() << std::flush;
+		bool succeeded = m_prefetchController->wasSuccessful();
+		m_status = succeeded ? MultiMC::Succeeded : MultiMC::Failed;
+		exit(succeeded ? 0 : 1);
+	});
+	// exit() only works once the event loop is running
+	QMetaObject::invokeMethod(m_prefetchController.get(), "start", Qt::QueuedConnection);
+}
+
+void MultiMC::performCacheGC()
+{
+	m_cacheGCTask.reset(new CacheGCTask(m_instances, m_cacheGCMode == "delete"));
+	connect(m_cacheGCTask.get(), &Task::finished, [this]()
+	{
+		auto &result = m_cacheGCTask->result();
+		QJsonObject summary;
+		summary.insert("mode", m_cacheGCMode);
+		summary.insert("files", result.files);
+		summary.insert("bytes", result.bytes);
+		summary.insert("skipped", QJsonArray::fromStringList(m_cacheGCTask->skippedAreas()));
+		summary.insert("errors", QJsonArray::fromStringList(result.errors));
+		std::cout << QJsonDocument(summary).toJson(QJsonDocument::Indented).constData() << std::flush;
+		bool succeeded = m_cacheGCTask->wasSuccessful();
+		m_status = succeeded ? MultiMC::Succeeded : MultiMC::Failed;
+		exit(succeeded ? 0 : 1);
+	});
+	// exit() only works once the event loop is running
+	QMetaObject::invokeMethod(m_cacheGCTask.get(), "start", Qt::QueuedConnection);
+}
+
+bool MultiMC::isHeadless() const
+{
+	return !m_instanceIdsToPrefetch.isEmpty() || !m_cacheGCMode.isEmpty();
+}
+
 void MultiMC::showFatalErrorMessage(const QString& title, const QString& content)
 {
 	m_status = MultiMC::Failed;
+	if(isHeadless())
+	{
+		std::cerr << qPrintable(content) << std::endl;
+		return;
+	}
 	auto dialog = CustomMessageBox::selectable(nullptr, title, content, QMessageBox::Critical);
 	dialog->exec();
 }
@@ -6,18 +6,22 @@
 #include <QFlag>
 #include <QIcon>
 #include <QDateTime>
+#include <QElapsedTimer>
 #include <updater/GoUpdate.h>
 
 #include <BaseInstance.h>
 
 class LaunchController;
+class PrefetchController;
+class CacheGCTask;
 class LocalPeer;
 class InstanceWindow;
 class MainWindow;
 class SetupWizard;
 class FolderInstanceProvider;
 class GenericPageProvider;
-class QFile;
+class AsyncLogWriter;
+class DiskUsageScanner;
 class HttpMetaCache;
 class SettingsObject;
 class InstanceList;
@@ -164,6 +168,13 @@ private slots:
 private:
 	bool createSetupWizard();
 	void performMainStartupAction();
+	void performPrefetch();
+	void performCacheGC();
+	bool isHeadless() const;
+	void performDeferredStartup();
+
+	// remembers how long it took since the last phase, for the startup timing report
+	void startupPhase(const QString &name);
 
 	// sets the fatal error message and m_status to Failed.
 	void showFatalErrorMessage(const QString & title, const QString & content);
@@ -175,10 +186,14 @@ private:
 
 private:
 	QDateTime startTime;
+	QElapsedTimer m_startupTimer;
+	QList<QPair<QString, qint64>> m_startupPhases;
+	bool m_startupTiming = false;
 
 	std::shared_ptr<SettingsObject> m_settings;
 	std::shared_ptr<InstanceList> m_instances;
 	FolderInstanceProvider * m_instanceFolder = nullptr;
+	std::unique_ptr<DiskUsageScanner> m_diskUsageScanner;
 	std::shared_ptr<IconList> m_icons;
 	std::shared_ptr<UpdateChecker> m_updateChecker;
 	std::shared_ptr<MojangAccountList> m_accounts;
@@ -219,8 +234,15 @@ private:
 
 	GAnalytics * m_analytics = nullptr;
 	SetupWizard * m_setupWizard = nullptr;
+
+	// headless prefetch of instances, if requested on the command line
+	shared_qobject_ptr<PrefetchController> m_prefetchController;
+	// headless cache cleanup, if requested on the command line
+	shared_qobject_ptr<CacheGCTask> m_cacheGCTask;
+	QString m_cacheGCMode;
 public:
 	QString m_instanceIdToLaunch;
+	QStringList m_instanceIdsToPrefetch;
 	bool m_liveCheck = false;
-	std::unique_ptr<QFile> logFile;
+	std::unique_ptr<AsyncLogWriter> logWriter;
 };
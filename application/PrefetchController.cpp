@@ -0,0 +1,146 @@
+#include "PrefetchController.h"
+#include <QJsonArray>
+#include <QDebug>
+
+namespace {
+// every update task runs its own download jobs, so this doesn't have to be big
+const int maxConcurrentUpdates = 4;
+}
+
+PrefetchController::PrefetchController(QObject *parent) : Task(parent)
+{
+}
+
+void PrefetchController::executeTask()
+{
+	m_timer.start();
+	for(auto instance: m_instances)
+	{
+		Entry entry;
+		entry.instance = instance;
+		m_entries.append(entry);
+	}
+	startMore();
+}
+
+void PrefetchController::startMore()
+{
+	while(!m_aborted && m_running < maxConcurrentUpdates && m_next < m_entries.size())
+	{
+		auto &entry = m_entries[m_next++];
+		entry.timer.start();
+		entry.task = entry.instance->createUpdateTask();
+		if(!entry.task)
+		{
+			entry.status = "skipped";
+			qDebug() << "Nothing to prefetch for" << entry.instance->id();
+			continue;
+		}
+		qDebug() << "Prefetching" << entry.instance->id();
+		entry.status = "running";
+		m_running++;
+		connect(entry.task.get(), &Task::succeeded, this, &PrefetchController::updateSucceeded);
+		connect(entry.task.get(), &Task::failed, this, &PrefetchController::updateFailed);
+		entry.task->start();
+	}
+	setProgress(m_next - m_running, m_entries.size());
+	if(m_running)
+	{
+		return;
+	}
+	if(m_aborted)
+	{
+		emitFailed(tr("Aborted by user."));
+	}
+	else if(m_failed)
+	{
+		emitFailed(tr("Failed to prefetch %1 of %2 instances.").arg(m_failed).arg(m_entries.size()));
+	}
+	else
+	{
+		emitSucceeded();
+	}
+}
+
+void PrefetchController::updateSucceeded()
+{
+	updateFinished(sender(), true, QString());
+}
+
+void PrefetchController::updateFailed(QString reason)
+{
+	updateFinished(sender(), false, reason);
+}
+
+void PrefetchController::updateFinished(QObject *task, bool succeeded, const QString &reason)
+{
+	for(auto &entry: m_entries)
+	{
+		if(entry.task.get() != task || entry.status != "running")
+		{
+			continue;
+		}
+		entry.duration = entry.timer.elapsed();
+		entry.task->disconnect(this);
+		if(succeeded)
+		{
+			entry.status = "succeeded";
+			qDebug() << "Prefetched" << entry.instance->id() << "in" << entry.duration << "ms";
+		}
+		else
+		{
+			entry.status = "failed";
+			entry.error = reason;
+			m_failed++;
+			qWarning() << "Failed to prefetch" << entry.instance->id() << ":" << reason;
+		}
+		m_running--;
+		// don't start more from inside the signal handlers of the finished task
+		QMetaObject::invokeMethod(this, "startMore", Qt::QueuedConnection);
+		return;
+	}
+}
+
+bool PrefetchController::abort()
+{
+	m_aborted = true;
+	bool fullyAborted = true;
+	for(auto &entry: m_entries)
+	{
+		if(entry.status == "running" && entry.task->canAbort())
+		{
+			fullyAborted &= entry.task->abort();
+		}
+	}
+	return fullyAborted;
+}
+
+QJsonObject PrefetchController::summary() const
+{
+	QJsonArray instances;
+	int succeeded = 0;
+	for(auto &entry: m_entries)
+	{
+		QJsonObject obj;
+		obj.insert("id", entry.instance->id());
+		obj.insert("name", entry.instance->name());
+		obj.insert("status", entry.status);
+		if(!entry.error.isEmpty())
+		{
+			obj.insert("error", entry.error);
+		}
+		obj.insert("durationMs", entry.duration);
+		instances.append(obj);
+		if(entry.status == "succeeded")
+		{
+			succeeded++;
+		}
+	}
+	QJsonObject out;
+	out.insert("succeeded", succeeded);
+	out.insert("failed", m_failed);
+	out.insert("total", m_entries.size());
+	out.insert("durationMs", m_timer.elapsed());
+	out.insert("instances", instances);
+	return out;
+}
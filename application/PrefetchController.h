@@ -0,0 +1,63 @@
+#pragma once
+#include <QObject>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <BaseInstance.h>
+#include <tasks/Task.h>
+
+/**
+ * Runs the update tasks of many instances at once, without any UI.
+ * Used to download everything needed for the instances ahead of time.
+ */
+class PrefetchController: public Task
+{
+	Q_OBJECT
+public:
+	PrefetchController(QObject * parent = nullptr);
+	virtual ~PrefetchController(){};
+
+	void setInstances(const QList<InstancePtr> &instances)
+	{
+		m_instances = instances;
+	}
+
+	/// machine-readable description of what happened to each instance
+	QJsonObject summary() const;
+
+	bool canAbort() const override
+	{
+		return true;
+	}
+
+public slots:
+	bool abort() override;
+
+protected:
+	void executeTask() override;
+
+private slots:
+	void updateSucceeded();
+	void updateFailed(QString reason);
+	void startMore();
+
+private:
+	void updateFinished(QObject *task, bool succeeded, const QString &reason);
+
+private:
+	struct Entry
+	{
+		InstancePtr instance;
+		shared_qobject_ptr<Task> task;
+		QString status = "pending";
+		QString error;
+		QElapsedTimer timer;
+		qint64 duration = 0;
+	};
+	QList<InstancePtr> m_instances;
+	QList<Entry> m_entries;
+	int m_next = 0;
+	int m_running = 0;
+	int m_failed = 0;
+	bool m_aborted = false;
+	QElapsedTimer m_timer;
+};
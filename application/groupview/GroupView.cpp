@@ -109,31 +109,48 @@ void GroupView::updateGeometries()
 	geometryCache.clear();
 	int previousScroll = verticalScrollBar()->value();
 
-	QMap<LocaleString, VisualGroup *> cats;
-
+	// sort the items into groups in one pass over the model
+	QMap<LocaleString, QList<QModelIndex>> groupItems;
 	for (int i = 0; i < model()->rowCount(); ++i)
 	{
-		const QString groupName = model()->index(i, 0).data(GroupViewRoles::GroupRole).toString();
-		if (!cats.contains(groupName))
+		const QModelIndex index = model()->index(i, 0);
+		groupItems[index.data(GroupViewRoles::GroupRole).toString()].append(index);
+	}
+
+	// keep the groups that still have items, so filtering the model doesn't start from scratch
+	QHash<QString, VisualGroup *> oldGroups;
+	for (auto group : m_groups)
+	{
+		oldGroups.insert(group->text, group);
+	}
+	m_groups.clear();
+	for (auto iter = groupItems.cbegin(); iter != groupItems.cend(); iter++)
+	{
+		VisualGroup *cat = oldGroups.take(iter.key());
+		if (!cat)
 		{
-			VisualGroup *old = this->category(groupName);
-			if (old)
-			{
-				auto cat = new VisualGroup(old);
-				cats.insert(groupName, cat);
-				cat->update();
-			}
-			else
-			{
-				auto cat = new VisualGroup(groupName, this);
-				cats.insert(groupName, cat);
-				cat->update();
-			}
+			cat = new VisualGroup(iter.key(), this);
+			cat->collapsed = m_collapsedGroups.contains(cat->text);
 		}
+		cat->update(iter.value());
+		m_groups.append(cat);
 	}
-
-	qDeleteAll(m_groups);
-	m_groups = cats.values();
+	if (oldGroups.values().contains(m_pressedCategory))
+	{
+		m_pressedCategory = nullptr;
+	}
+	for (auto group : oldGroups)
+	{
+		if (group->collapsed)
+		{
+			m_collapsedGroups.insert(group->text);
+		}
+		else
+		{
+			m_collapsedGroups.remove(group->text);
+		}
+	}
+	qDeleteAll(oldGroups);
 
 	if (m_groups.isEmpty())
 	{
@@ -19,6 +19,7 @@
 #include <QLineEdit>
 #include <QScrollBar>
 #include <QCache>
+#include <QSet>
 #include "VisualGroup.h"
 
 struct GroupViewRoles
@@ -99,6 +100,8 @@ protected:
 private:
 	friend struct VisualGroup;
 	QList<VisualGroup *> m_groups;
+	// names of the collapsed groups that are currently hidden, so they come back collapsed
+	QSet<QString> m_collapsedGroups;
 
 	// geometry
 	int m_leftMargin = 5;
@@ -27,14 +27,8 @@ VisualGroup::VisualGroup(const QString &text, GroupView *view) : view(view), tex
 {
 }
 
-VisualGroup::VisualGroup(const VisualGroup *other)
-	: view(other->view), text(other->text), collapsed(other->collapsed)
+void VisualGroup::update(const QList<QModelIndex> &temp_items)
 {
-}
-
-void VisualGroup::update()
-{
-	auto temp_items = items();
 	auto itemsPerRow = view->itemsPerRow();
 
 	int numRows = qMax(1, qCeil((qreal)temp_items.size() / (qreal)itemsPerRow));
@@ -301,17 +295,3 @@ int VisualGroup::verticalPosition() const
 {
 	return m_verticalPosition;
 }
-
-QList<QModelIndex> VisualGroup::items() const
-{
-	QList<QModelIndex> indices;
-	for (int i = 0; i < view->model()->rowCount(); ++i)
-	{
-		const QModelIndex index = view->model()->index(i, 0);
-		if (index.data(GroupViewRoles::GroupRole).toString() == text)
-		{
-			indices.append(index);
-		}
-	}
-	return indices;
-}
@@ -43,7 +43,6 @@ struct VisualGroup
 {
 /* constructors */
 	VisualGroup(const QString &text, GroupView *view);
-	VisualGroup(const VisualGroup *other);
 
 /* data */
 	GroupView *view = nullptr;
@@ -54,8 +53,8 @@ struct VisualGroup
 	int m_verticalPosition = 0;
 
 /* logic */
-	/// update the internal list of items and flow them into the rows.
-	void update();
+	/// set the list of items and flow them into the rows.
+	void update(const QList<QModelIndex> &items);
 
 	/// draw the header at y-position.
 	void drawHeader(QPainter *painter, const QStyleOptionViewItem &option);
@@ -99,8 +98,6 @@ struct VisualGroup
 
 	/// shoot! BANG! what did we hit?
 	HitResults hitScan (const QPoint &pos) const;
-
-	QList<QModelIndex> items() const;
 };
 
 Q_DECLARE_OPERATORS_FOR_FLAGS(VisualGroup::HitResults)
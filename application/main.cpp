@@ -32,6 +32,20 @@ int main(int argc, char *argv[])
 	 QApplication::setAttribute(Qt::AA_EnableHighDpiScaling);
 #endif
 
+	// the headless modes don't need a display
+	for(int i = 1; i < argc; i++)
+	{
+		if(qstrcmp(argv[i], "--prefetch") == 0 || qstrncmp(argv[i], "--prefetch=", 11) == 0 ||
+			qstrcmp(argv[i], "--cache-gc") == 0 || qstrncmp(argv[i], "--cache-gc=", 11) == 0)
+		{
+			if(!qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+			{
+				qputenv("QT_QPA_PLATFORM", "offscreen");
+			}
+			break;
+		}
+	}
+
 	// initialize Qt
 	MultiMC app(argc, argv);
 
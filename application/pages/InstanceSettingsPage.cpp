@@ -10,6 +10,8 @@
 #include "MultiMC.h"
 
 #include <java/JavaInstallList.h>
+#include <java/GCLog.h>
+#include <ProcessLimits.h>
 #include <FileSystem.h>
 #include <sys.h>
 
@@ -20,6 +22,11 @@ InstanceSettingsPage::InstanceSettingsPage(BaseInstance *inst, QWidget *parent)
 	ui->setupUi(this);
 	auto sysMB = Sys::getSystemRam() / Sys::megabyte;
 	ui->maxMemSpinBox->setMaximum(sysMB);
+	ui->ioPriorityComboBox->addItem(tr("Default"), QString());
+	ui->ioPriorityComboBox->addItem(tr("High"), ProcessLimits::ioPriorityName(ProcessLimits::IOHigh));
+	ui->ioPriorityComboBox->addItem(tr("Normal"), ProcessLimits::ioPriorityName(ProcessLimits::IONormal));
+	ui->ioPriorityComboBox->addItem(tr("Low"), ProcessLimits::ioPriorityName(ProcessLimits::IOLow));
+	ui->ioPriorityComboBox->addItem(tr("Idle"), ProcessLimits::ioPriorityName(ProcessLimits::IOIdle));
 	loadSettings();
 }
 
@@ -120,10 +127,14 @@ void InstanceSettingsPage::applySettings()
 	{
 		m_settings->set("JvmArgs", ui->jvmArgsTextBox->toPlainText().replace("\n", " "));
 		JavaCommon::checkJVMArgs(m_settings->get("JvmArgs").toString(), this->parentWidget());
+		m_settings->set("UseClassDataSharing", ui->classDataSharingCheckBox->isChecked());
+		m_settings->set("EnableGCLogging", ui->gcLoggingCheckBox->isChecked());
 	}
 	else
 	{
 		m_settings->reset("JvmArgs");
+		m_settings->reset("UseClassDataSharing");
+		m_settings->reset("EnableGCLogging");
 	}
 
 	// old generic 'override both' is removed.
@@ -144,6 +155,21 @@ void InstanceSettingsPage::applySettings()
 		m_settings->reset("WrapperCommand");
 		m_settings->reset("PostExitCommand");
 	}
+
+	// Process resources
+	QList<int> cpus;
+	if(ProcessLimits::parseCpuList(ui->affinityTextBox->text(), cpus))
+	{
+		m_settings->set("CPUAffinity", ProcessLimits::formatCpuList(cpus));
+	}
+	else
+	{
+		QMessageBox::warning(this, tr("Invalid CPU affinity"), tr("The CPU affinity should be a list of CPUs like 0-3,6. It was not changed."));
+	}
+	m_settings->set("ProcessPriority", ui->prioritySpinBox->value());
+	m_settings->set("IOPriority", ui->ioPriorityComboBox->currentData().toString());
+	m_settings->set("MemoryLimit", ui->memoryLimitSpinBox->value());
+	m_settings->set("CPULimit", ui->cpuLimitSpinBox->value());
 }
 
 void InstanceSettingsPage::loadSettings()
@@ -176,6 +202,24 @@ void InstanceSettingsPage::loadSettings()
 	}
 	ui->permGenSpinBox->setValue(m_settings->get("PermGen").toInt());
 
+	// what the garbage collector saw in the last session, if it was logged
+	auto gcSummary = GCLog::lastSummary(m_instance->instanceRoot());
+	if(gcSummary.isValid())
+	{
+		ui->gcSummaryLabel->setText(
+			tr("Last logged session: %1 collections (%2 full), average pause %3 ms, longest %4 ms, "
+			   "allocating %5 MB/s, peak live heap %6 MB. Suggested maximum: %7 MB.")
+				.arg(gcSummary.collections)
+				.arg(gcSummary.fullCollections)
+				.arg(gcSummary.averagePauseMs(), 0, 'f', 1)
+				.arg(gcSummary.maxPauseMs, 0, 'f', 1)
+				.arg(gcSummary.allocationRateMiBs(), 0, 'f', 1)
+				.arg(gcSummary.peakLiveKiB / 1024)
+				.arg(gcSummary.suggestedMaxMemory()));
+	}
+	ui->gcSummaryLabel->setVisible(gcSummary.isValid());
+	ui->useSuggestedMemoryBtn->setVisible(gcSummary.isValid());
+
 	// Java Settings
 	bool overrideJava = m_settings->get("OverrideJava").toBool();
 	bool overrideLocation = m_settings->get("OverrideJavaLocation").toBool() || overrideJava;
@@ -186,12 +230,22 @@ void InstanceSettingsPage::loadSettings()
 
 	ui->javaArgumentsGroupBox->setChecked(overrideArgs);
 	ui->jvmArgsTextBox->setPlainText(m_settings->get("JvmArgs").toString());
+	ui->classDataSharingCheckBox->setChecked(m_settings->get("UseClassDataSharing").toBool());
+	ui->gcLoggingCheckBox->setChecked(m_settings->get("EnableGCLogging").toBool());
 
 	// Custom Commands
 	ui->customCommandsGroupBox->setChecked(m_settings->get("OverrideCommands").toBool());
 	ui->preLaunchCmdTextBox->setText(m_settings->get("PreLaunchCommand").toString());
 	ui->wrapperCmdTextBox->setText(m_settings->get("WrapperCommand").toString());
 	ui->postExitCmdTextBox->setText(m_settings->get("PostExitCommand").toString());
+
+	// Process resources
+	ui->affinityTextBox->setText(m_settings->get("CPUAffinity").toString());
+	ui->prioritySpinBox->setValue(m_settings->get("ProcessPriority").toInt());
+	auto ioIndex = ui->ioPriorityComboBox->findData(m_settings->get("IOPriority").toString());
+	ui->ioPriorityComboBox->setCurrentIndex(ioIndex == -1 ? 0 : ioIndex);
+	ui->memoryLimitSpinBox->setValue(m_settings->get("MemoryLimit").toInt());
+	ui->cpuLimitSpinBox->setValue(m_settings->get("CPULimit").toInt());
 }
 
 void InstanceSettingsPage::on_javaDetectBtn_clicked()
@@ -209,6 +263,22 @@ void InstanceSettingsPage::on_javaDetectBtn_clicked()
 	}
 }
 
+void InstanceSettingsPage::on_useSuggestedMemoryBtn_clicked()
+{
+	auto gcSummary = GCLog::lastSummary(m_instance->instanceRoot());
+	if(!gcSummary.isValid())
+	{
+		return;
+	}
+	int suggestion = gcSummary.suggestedMaxMemory();
+	ui->memoryGroupBox->setChecked(true);
+	ui->maxMemSpinBox->setValue(suggestion);
+	if(ui->minMemSpinBox->value() > suggestion)
+	{
+		ui->minMemSpinBox->setValue(suggestion);
+	}
+}
+
 void InstanceSettingsPage::on_javaBrowseBtn_clicked()
 {
 	QString raw_path = QFileDialog::getOpenFileName(this, tr("Find Java executable"));
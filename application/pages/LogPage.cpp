@@ -3,6 +3,7 @@
 
 #include "MultiMC.h"
 
+#include <QFileInfo>
 #include <QIcon>
 #include <QScrollBar>
 #include <QShortcut>
@@ -10,6 +11,7 @@
 #include "launch/LaunchTask.h"
 #include <settings/Setting.h>
 #include "GuiUtil.h"
+#include <DesktopServices.h>
 #include <ColorCache.h>
 
 class LogFormatProxyModel : public QIdentityProxyModel
@@ -144,6 +146,7 @@ LogPage::LogPage(InstancePtr instance, QWidget *parent)
 			on_InstanceLaunchTask_changed(launchTask);
 		}
 		connect(m_instance.get(), &BaseInstance::launchTaskChanged, this, &LogPage::on_InstanceLaunchTask_changed);
+		updateRecordingButton();
 	}
 
 	ui->text->setWordWrap(true);
@@ -164,17 +167,37 @@ LogPage::~LogPage()
 
 void LogPage::on_InstanceLaunchTask_changed(std::shared_ptr<LaunchTask> proc)
 {
+	if(m_process)
+	{
+		disconnect(m_process.get(), &LaunchTask::finished, this, &LogPage::updateRecordingButton);
+	}
 	m_process = proc;
 	if(m_process)
 	{
 		m_model = proc->getLogModel();
 		m_proxy->setSourceModel(m_model.get());
+		connect(m_process.get(), &LaunchTask::finished, this, &LogPage::updateRecordingButton);
 	}
 	else
 	{
 		m_proxy->setSourceModel(nullptr);
 		m_model.reset();
 	}
+	updateRecordingButton();
+}
+
+void LogPage::updateRecordingButton()
+{
+	// the recording only exists once the game exits
+	bool hasRecording = m_process && !m_process->profilerOutput().isEmpty() && QFile::exists(m_process->profilerOutput());
+	ui->btnRecording->setVisible(hasRecording);
+}
+
+void LogPage::on_btnRecording_clicked()
+{
+	if(!m_process)
+		return;
+	DesktopServices::openDirectory(QFileInfo(m_process->profilerOutput()).absolutePath());
 }
 
 bool LogPage::apply()
@@ -60,6 +60,7 @@ private slots:
 	void on_btnCopy_clicked();
 	void on_btnClear_clicked();
 	void on_btnBottom_clicked();
+	void on_btnRecording_clicked();
 
 	void on_trackLogCheckbox_clicked(bool checked);
 	void on_wrapCheckbox_clicked(bool checked);
@@ -70,6 +71,7 @@ private slots:
 	void findPreviousActivated();
 
 	void on_InstanceLaunchTask_changed(std::shared_ptr<LaunchTask> proc);
+	void updateRecordingButton();
 
 private:
 	Ui::LogPage *ui;
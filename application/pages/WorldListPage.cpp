@@ -16,6 +16,9 @@
 #include "WorldListPage.h"
 #include "ui_WorldListPage.h"
 #include "minecraft/WorldList.h"
+#include "minecraft/WorldBackupTask.h"
+#include "dialogs/ProgressDialog.h"
+#include "dialogs/CustomMessageBox.h"
 #include <DesktopServices.h>
 #include "dialogs/ModEditDialogCommon.h"
 #include <QEvent>
@@ -40,6 +43,7 @@ WorldListPage::WorldListPage(BaseInstance *inst, std::shared_ptr<WorldList> worl
 	ui->tabWidget->tabBar()->hide();
 	QSortFilterProxyModel * proxy = new QSortFilterProxyModel(this);
 	proxy->setSortCaseSensitivity(Qt::CaseInsensitive);
+	proxy->setSortRole(WorldList::SortRole);
 	proxy->setSourceModel(m_worlds.get());
 	ui->worldTreeView->setSortingEnabled(true);
 	ui->worldTreeView->setModel(proxy);
@@ -49,6 +53,14 @@ WorldListPage::WorldListPage(BaseInstance *inst, std::shared_ptr<WorldList> worl
 
 	head->setSectionResizeMode(0, QHeaderView::Stretch);
 	head->setSectionResizeMode(1, QHeaderView::ResizeToContents);
+	head->setSectionResizeMode(2, QHeaderView::ResizeToContents);
+
+	// world sizes come from the background disk usage scan of the instance
+	m_worlds->setWorldSizes(m_inst->diskUsage().worlds);
+	connect(m_inst, &BaseInstance::propertiesChanged, this, [this]()
+	{
+		m_worlds->setWorldSizes(m_inst->diskUsage().worlds);
+	});
 	connect(ui->worldTreeView->selectionModel(),
 			SIGNAL(currentChanged(const QModelIndex &, const QModelIndex &)), this,
 			SLOT(worldChanged(const QModelIndex &, const QModelIndex &)));
@@ -241,6 +253,9 @@ void WorldListPage::worldChanged(const QModelIndex &current, const QModelIndex &
 	ui->rmWorldBtn->setEnabled(enable);
 	ui->copyBtn->setEnabled(enable);
 	ui->renameBtn->setEnabled(enable);
+	ui->backupBtn->setEnabled(enable && !m_worlds->backupDir().isEmpty());
+	// worlds that were deleted can be restored too, so this doesn't need a selection
+	ui->restoreBtn->setEnabled(!m_worlds->backupDir().isEmpty());
 }
 
 void WorldListPage::on_addBtn_clicked()
@@ -328,3 +343,127 @@ void WorldListPage::on_refreshBtn_clicked()
 {
 	m_worlds->update();
 }
+
+void WorldListPage::on_backupBtn_clicked()
+{
+	QModelIndex index = getSelectedWorld();
+	if (!index.isValid())
+	{
+		return;
+	}
+
+	// the game keeps writing to a loaded world, a backup of it could be inconsistent
+	if (m_inst->isRunning())
+	{
+		QMessageBox::warning(this, tr("Back Up World"), tr("Worlds can only be backed up while the game is not running."));
+		return;
+	}
+
+	auto world = (World *) m_worlds->data(index, WorldList::ObjectRole).value<void *>();
+	auto settings = MMC->settings();
+	WorldBackupRetention retention;
+	retention.keepLast = settings->get("WorldBackupKeepLast").toInt();
+	retention.keepDaily = settings->get("WorldBackupKeepDaily").toInt();
+	retention.keepWeekly = settings->get("WorldBackupKeepWeekly").toInt();
+
+	WorldBackupTask task(m_worlds->backupDir(), world->container().absoluteFilePath(), world->folderName(), retention);
+	ProgressDialog dialog(this);
+	if (dialog.execWithTask(&task) != QDialog::Accepted)
+	{
+		CustomMessageBox::selectable(this, tr("Backup failed"), task.failReason(), QMessageBox::Warning)->exec();
+	}
+}
+
+void WorldListPage::on_restoreBtn_clicked()
+{
+	if (m_inst->isRunning())
+	{
+		QMessageBox::warning(this, tr("Restore World"), tr("Worlds can only be restored while the game is not running."));
+		return;
+	}
+
+	// the store knows the worlds, including the ones deleted since they were backed up
+	WorldBackupStore store(m_worlds->backupDir());
+	auto folders = store.worlds();
+	if (folders.isEmpty())
+	{
+		QMessageBox::information(this, tr("Restore World"), tr("There are no world backups yet."));
+		return;
+	}
+
+	QString selectedFolder;
+	QModelIndex index = getSelectedWorld();
+	if (index.isValid())
+	{
+		selectedFolder = ((World *) m_worlds->data(index, WorldList::ObjectRole).value<void *>())->folderName();
+	}
+	QMap<QString, QString> names;
+	for (auto &world : m_worlds->allWorlds())
+	{
+		names[world.folderName()] = world.name();
+	}
+	// names don't have to be unique, folder names do
+	QStringList labels;
+	for (auto &folder : folders)
+	{
+		if (!names.contains(folder))
+		{
+			labels.append(tr("%1 (deleted)").arg(folder));
+		}
+		else if (names[folder] != folder)
+		{
+			labels.append(QString("%1 (%2)").arg(names[folder], folder));
+		}
+		else
+		{
+			labels.append(folder);
+		}
+	}
+	int current = qMax(0, folders.indexOf(selectedFolder));
+	bool ok = false;
+	auto label = QInputDialog::getItem(this, tr("Restore World"), tr("Restore the world:"), labels, current, false, &ok);
+	if (!ok)
+	{
+		return;
+	}
+	auto folderName = folders[labels.indexOf(label)];
+	auto worldPath = m_worlds->dir().absoluteFilePath(folderName);
+
+	// the ids are the creation times, so the list doesn't have to read the snapshots
+	auto ids = store.snapshotIds(folderName);
+	QStringList times;
+	for (auto &id : ids)
+	{
+		times.append(WorldBackupStore::snapshotTime(id).toLocalTime().toString(Qt::DefaultLocaleLongDate));
+	}
+	auto time = QInputDialog::getItem(this, tr("Restore World"), tr("Restore %1 from the backup made on:").arg(label), times, 0, false, &ok);
+	if (!ok)
+	{
+		return;
+	}
+	auto id = ids[times.indexOf(time)];
+
+	// anything in the way gets replaced, even if it isn't listed as a world
+	if (QFileInfo::exists(worldPath))
+	{
+		auto result = QMessageBox::question(this, tr("Are you sure?"),
+			tr("This will replace the world with the backup from %1.\n"
+				"Everything that happened in the world since will be lost.\n"
+				"\n"
+				"Do you want to continue?").arg(time));
+		if (result != QMessageBox::Yes)
+		{
+			return;
+		}
+	}
+
+	m_worlds->stopWatching();
+	WorldRestoreTask task(m_worlds->backupDir(), folderName, id, worldPath);
+	ProgressDialog dialog(this);
+	if (dialog.execWithTask(&task) != QDialog::Accepted)
+	{
+		CustomMessageBox::selectable(this, tr("Restore failed"), task.failReason(), QMessageBox::Warning)->exec();
+	}
+	m_worlds->startWatching();
+	m_worlds->update();
+}
@@ -91,6 +91,8 @@ private slots:
 	void on_renameBtn_clicked();
 	void on_refreshBtn_clicked();
 	void on_viewFolderBtn_clicked();
+	void on_backupBtn_clicked();
+	void on_restoreBtn_clicked();
 	void worldChanged(const QModelIndex &current, const QModelIndex &previous);
 	void mceditState(LoggedProcess::State state);
 };
@@ -80,6 +80,8 @@ void JavaPage::applySettings()
 	s->set("JavaPath", ui->javaPathTextBox->text());
 	s->set("JvmArgs", ui->jvmArgsTextBox->text());
 	JavaCommon::checkJVMArgs(s->get("JvmArgs").toString(), this->parentWidget());
+	s->set("UseClassDataSharing", ui->classDataSharingCheckBox->isChecked());
+	s->set("EnableGCLogging", ui->gcLoggingCheckBox->isChecked());
 
 	// Custom Commands
 	s->set("PreLaunchCommand", ui->preLaunchCmdTextBox->text());
@@ -107,6 +109,8 @@ void JavaPage::loadSettings()
 	// Java Settings
 	ui->javaPathTextBox->setText(s->get("JavaPath").toString());
 	ui->jvmArgsTextBox->setText(s->get("JvmArgs").toString());
+	ui->classDataSharingCheckBox->setChecked(s->get("UseClassDataSharing").toBool());
+	ui->gcLoggingCheckBox->setChecked(s->get("EnableGCLogging").toBool());
 
 	// Custom Commands
 	ui->preLaunchCmdTextBox->setText(s->get("PreLaunchCommand").toString());
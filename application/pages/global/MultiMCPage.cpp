@@ -35,7 +35,9 @@ enum InstSortMode
 	// Sort alphabetically by name.
 	Sort_Name,
 	// Sort by which instance was launched most recently.
-	Sort_LastLaunch
+	Sort_LastLaunch,
+	// Sort by disk usage, biggest first.
+	Sort_Size
 };
 
 MultiMCPage::MultiMCPage(QWidget *parent) : QWidget(parent), ui(new Ui::MultiMCPage)
@@ -47,6 +49,7 @@ MultiMCPage::MultiMCPage(QWidget *parent) : QWidget(parent), ui(new Ui::MultiMCP
 
 	ui->sortingModeGroup->setId(ui->sortByNameBtn, Sort_Name);
 	ui->sortingModeGroup->setId(ui->sortLastLaunchedBtn, Sort_LastLaunch);
+	ui->sortingModeGroup->setId(ui->sortBySizeBtn, Sort_Size);
 
 	defaultFormat = new QTextCharFormat(ui->fontPreview->currentCharFormat());
 
@@ -316,6 +319,9 @@ void MultiMCPage::applySettings()
 	case Sort_LastLaunch:
 		s->set("InstSortMode", "LastLaunch");
 		break;
+	case Sort_Size:
+		s->set("InstSortMode", "Size");
+		break;
 	case Sort_Name:
 	default:
 		s->set("InstSortMode", "Name");
@@ -420,6 +426,10 @@ void MultiMCPage::loadSettings()
 	{
 		ui->sortLastLaunchedBtn->setChecked(true);
 	}
+	else if (sortMode == "Size")
+	{
+		ui->sortBySizeBtn->setChecked(true);
+	}
 	else
 	{
 		ui->sortByNameBtn->setChecked(true);
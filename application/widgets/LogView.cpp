@@ -1,30 +1,59 @@
 #include "LogView.h"
-#include <QTextBlock>
+#include <QApplication>
+#include <QClipboard>
+#include <QContextMenuEvent>
+#include <QKeyEvent>
+#include <QMenu>
+#include <QPainter>
 #include <QScrollBar>
+#include <QTextLayout>
+#include <QtMath>
 
-LogView::LogView(QWidget* parent) : QPlainTextEdit(parent)
+#include "launch/LogModel.h"
+
+namespace
+{
+// space between the text and the left edge, like in a text edit
+const int margin = 4;
+// layouts are only kept for rows that were visible recently, this is plenty for any screen
+const int maxCachedLayouts = 512;
+}
+
+LogView::LogView(QWidget* parent) : QAbstractScrollArea(parent)
 {
-	setWordWrapMode(QTextOption::WrapAtWordBoundaryOrAnywhere);
-	m_defaultFormat = new QTextCharFormat(currentCharFormat());
+	// look like a text edit, the log colors are adapted to these
+	setForegroundRole(QPalette::Text);
+	setBackgroundRole(QPalette::Base);
+	viewport()->setBackgroundRole(QPalette::Base);
+	viewport()->setAutoFillBackground(true);
+	viewport()->setCursor(Qt::IBeamCursor);
+	setFocusPolicy(Qt::StrongFocus);
+	setWordWrap(true);
 }
 
 LogView::~LogView()
 {
-	delete m_defaultFormat;
 }
 
 void LogView::setWordWrap(bool wrapping)
 {
+	m_wordWrap = wrapping;
 	if(wrapping)
 	{
 		setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-		setLineWrapMode(QPlainTextEdit::WidgetWidth);
 	}
 	else
 	{
 		setHorizontalScrollBarPolicy(Qt::ScrollBarAsNeeded);
-		setLineWrapMode(QPlainTextEdit::NoWrap);
+		m_maxRowWidth = 0;
+		if(m_model)
+		{
+			measureRows(0, m_model->rowCount() - 1);
+		}
 	}
+	invalidateLayouts();
+	updateScrollBars();
+	viewport()->update();
 }
 
 void LogView::setModel(QAbstractItemModel* model)
@@ -35,6 +64,7 @@ void LogView::setModel(QAbstractItemModel* model)
 		disconnect(m_model, &QAbstractItemModel::rowsInserted, this, &LogView::rowsInserted);
 		disconnect(m_model, &QAbstractItemModel::rowsAboutToBeInserted, this, &LogView::rowsAboutToBeInserted);
 		disconnect(m_model, &QAbstractItemModel::rowsRemoved, this, &LogView::rowsRemoved);
+		disconnect(m_model, &QAbstractItemModel::destroyed, this, &LogView::modelDestroyed);
 	}
 	m_model = model;
 	if(m_model)
@@ -63,13 +93,18 @@ void LogView::modelDestroyed(QObject* model)
 
 void LogView::repopulate()
 {
-	auto doc = document();
-	doc->clear();
-	if(!m_model)
+	m_formats.clear();
+	invalidateLayouts();
+	m_anchor = Position();
+	m_cursor = Position();
+	m_maxRowWidth = 0;
+	if(m_model && !m_wordWrap)
 	{
-		return;
+		measureRows(0, m_model->rowCount() - 1);
 	}
-	rowsInserted(QModelIndex(), 0, m_model->rowCount() - 1);
+	updateScrollBars();
+	verticalScrollBar()->setValue(0);
+	viewport()->update();
 }
 
 void LogView::rowsAboutToBeInserted(const QModelIndex& parent, int first, int last)
@@ -92,31 +127,16 @@ void LogView::rowsAboutToBeInserted(const QModelIndex& parent, int first, int la
 
 void LogView::rowsInserted(const QModelIndex& parent, int first, int last)
 {
-	for(int i = first; i <= last; i++)
+	if(parent.isValid())
 	{
-		auto idx = m_model->index(i, 0, parent);
-		auto text = m_model->data(idx, Qt::DisplayRole).toString();
-		QTextCharFormat format(*m_defaultFormat);
-		auto font = m_model->data(idx, Qt::FontRole);
-		if(font.isValid())
-		{
-			format.setFont(font.value<QFont>());
-		}
-		auto fg = m_model->data(idx, Qt::TextColorRole);
-		if(fg.isValid())
-		{
-			format.setForeground(fg.value<QColor>());
-		}
-		auto bg = m_model->data(idx, Qt::BackgroundRole);
-		if(bg.isValid())
-		{
-			format.setBackground(bg.value<QColor>());
-		}
-		auto workCursor = textCursor();
-		workCursor.movePosition(QTextCursor::End);
-		workCursor.insertText(text, format);
-		workCursor.insertBlock();
+		return;
 	}
+	if(!m_wordWrap)
+	{
+		measureRows(first, last);
+	}
+	updateScrollBars();
+	viewport()->update();
 	if(m_scroll && !m_scrolling)
 	{
 		m_scrolling = true;
@@ -126,10 +146,46 @@ void LogView::rowsInserted(const QModelIndex& parent, int first, int last)
 
 void LogView::rowsRemoved(const QModelIndex& parent, int first, int last)
 {
-	// TODO: some day... maybe
-	Q_UNUSED(parent)
-	Q_UNUSED(first)
-	Q_UNUSED(last)
+	if(parent.isValid())
+	{
+		return;
+	}
+	// everything after the removed rows moves up, the view and the selection go with it
+	int count = last - first + 1;
+	auto shift = [&](int row)
+	{
+		if(row > last)
+		{
+			return row - count;
+		}
+		if(row >= first)
+		{
+			return first;
+		}
+		return row;
+	};
+	if(m_anchor.isValid())
+	{
+		m_anchor = Position(shift(m_anchor.row), m_anchor.row >= first && m_anchor.row <= last ? 0 : m_anchor.column);
+	}
+	if(m_cursor.isValid())
+	{
+		m_cursor = Position(shift(m_cursor.row), m_cursor.row >= first && m_cursor.row <= last ? 0 : m_cursor.column);
+	}
+	QHash<int, std::shared_ptr<QTextLayout>> layouts;
+	for(auto iter = m_layouts.begin(); iter != m_layouts.end(); iter++)
+	{
+		if(iter.key() < first || iter.key() > last)
+		{
+			layouts.insert(shift(iter.key()), iter.value());
+		}
+	}
+	m_layouts.swap(layouts);
+
+	int top = shift(verticalScrollBar()->value());
+	updateScrollBars();
+	verticalScrollBar()->setValue(top);
+	viewport()->update();
 }
 
 void LogView::scrollToBottom()
@@ -138,7 +194,503 @@ void LogView::scrollToBottom()
 	verticalScrollBar()->setSliderPosition(verticalScrollBar()->maximum());
 }
 
+QString LogView::rowText(int row) const
+{
+	return m_model->data(m_model->index(row, 0), Qt::DisplayRole).toString();
+}
+
+LogView::Format LogView::format(int row) const
+{
+	auto index = m_model->index(row, 0);
+	// all rows of a level look the same, so only ask the model once
+	auto level = m_model->data(index, LogModel::LevelRole);
+	if(level.isValid())
+	{
+		auto iter = m_formats.constFind(level.toInt());
+		if(iter != m_formats.constEnd())
+		{
+			return *iter;
+		}
+	}
+	Format format;
+	format.font = font();
+	format.foreground = palette().color(QPalette::Text);
+	auto fontVariant = m_model->data(index, Qt::FontRole);
+	if(fontVariant.isValid())
+	{
+		format.font = fontVariant.value<QFont>();
+	}
+	auto fg = m_model->data(index, Qt::TextColorRole);
+	if(fg.isValid())
+	{
+		format.foreground = fg.value<QColor>();
+	}
+	auto bg = m_model->data(index, Qt::BackgroundRole);
+	if(bg.isValid())
+	{
+		format.background = bg.value<QColor>();
+	}
+	if(level.isValid())
+	{
+		m_formats.insert(level.toInt(), format);
+	}
+	return format;
+}
+
+QTextLayout * LogView::layout(int row) const
+{
+	auto iter = m_layouts.constFind(row);
+	if(iter != m_layouts.constEnd())
+	{
+		return iter->get();
+	}
+	if(m_layouts.size() >= maxCachedLayouts)
+	{
+		m_layouts.clear();
+	}
+	auto rowFormat = format(row);
+	auto layout = std::make_shared<QTextLayout>(rowText(row), rowFormat.font);
+	QTextOption option;
+	option.setWrapMode(m_wordWrap ? QTextOption::WrapAtWordBoundaryOrAnywhere : QTextOption::NoWrap);
+	layout->setTextOption(option);
+	layout->setCacheEnabled(true);
+	qreal width = qMax(1, viewport()->width() - 2 * margin);
+	qreal height = 0;
+	layout->beginLayout();
+	while(true)
+	{
+		QTextLine line = layout->createLine();
+		if(!line.isValid())
+		{
+			break;
+		}
+		line.setLineWidth(width);
+		line.setPosition(QPointF(0, height));
+		height += line.height();
+	}
+	layout->endLayout();
+	m_layouts.insert(row, layout);
+	return layout.get();
+}
+
+int LogView::rowHeight(int row) const
+{
+	return qMax(1, qCeil(layout(row)->boundingRect().height()));
+}
+
+void LogView::measureRows(int first, int last)
+{
+	for(int row = first; row <= last; row++)
+	{
+		QFontMetrics metrics(format(row).font);
+		m_maxRowWidth = qMax(m_maxRowWidth, metrics.boundingRect(rowText(row)).width());
+	}
+}
+
+void LogView::invalidateLayouts()
+{
+	m_layouts.clear();
+}
+
+void LogView::updateScrollBars()
+{
+	int rows = m_model ? m_model->rowCount() : 0;
+	int available = viewport()->height();
+
+	// the vertical bar goes by rows, up to the first row of the last full page
+	int lastTop = rows;
+	int used = 0;
+	while(lastTop > 0)
+	{
+		int height = rowHeight(lastTop - 1);
+		if(used + height > available && lastTop < rows)
+		{
+			break;
+		}
+		used += height;
+		lastTop--;
+	}
+	auto vertical = verticalScrollBar();
+	vertical->setSingleStep(1);
+	vertical->setPageStep(qMax(1, rows - lastTop));
+	vertical->setRange(0, lastTop);
+
+	auto horizontal = horizontalScrollBar();
+	if(m_wordWrap)
+	{
+		horizontal->setRange(0, 0);
+	}
+	else
+	{
+		horizontal->setSingleStep(20);
+		horizontal->setPageStep(viewport()->width());
+		horizontal->setRange(0, qMax(0, m_maxRowWidth + 2 * margin - viewport()->width()));
+	}
+}
+
+void LogView::ensureVisible(const Position &position)
+{
+	if(!position.isValid())
+	{
+		return;
+	}
+	auto vertical = verticalScrollBar();
+	int available = viewport()->height();
+	int top = vertical->value();
+	bool visible = false;
+	if(position.row >= top)
+	{
+		int y = 0;
+		for(int row = top; row <= position.row && y < available; row++)
+		{
+			y += rowHeight(row);
+		}
+		visible = y <= available;
+	}
+	if(!visible)
+	{
+		// put the row in the middle, as far as possible
+		int newTop = position.row;
+		int used = rowHeight(newTop);
+		while(newTop > 0 && used + rowHeight(newTop - 1) <= available / 2)
+		{
+			newTop--;
+			used += rowHeight(newTop);
+		}
+		vertical->setValue(newTop);
+	}
+
+	if(!m_wordWrap)
+	{
+		auto horizontal = horizontalScrollBar();
+		auto line = layout(position.row)->lineForTextPosition(position.column);
+		if(line.isValid())
+		{
+			int x = qRound(line.cursorToX(position.column));
+			int width = viewport()->width() - 2 * margin;
+			if(x < horizontal->value() || x > horizontal->value() + width)
+			{
+				horizontal->setValue(x - width / 2);
+			}
+		}
+	}
+}
+
+LogView::Position LogView::positionAt(const QPoint &point) const
+{
+	if(!m_model || m_model->rowCount() == 0)
+	{
+		return Position();
+	}
+	int rows = m_model->rowCount();
+	int row = verticalScrollBar()->value();
+	int y = 0;
+	while(row < rows - 1)
+	{
+		int height = rowHeight(row);
+		if(point.y() < y + height)
+		{
+			break;
+		}
+		y += height;
+		row++;
+	}
+	auto rowLayout = layout(row);
+	qreal x = point.x() - margin + horizontalScrollBar()->value();
+	for(int i = 0; i < rowLayout->lineCount(); i++)
+	{
+		auto line = rowLayout->lineAt(i);
+		if(point.y() - y < line.y() + line.height() || i == rowLayout->lineCount() - 1)
+		{
+			return Position(row, line.xToCursor(x));
+		}
+	}
+	return Position(row, 0);
+}
+
+bool LogView::hasSelection() const
+{
+	return m_anchor.isValid() && m_cursor.isValid() && !(m_anchor == m_cursor);
+}
+
+QString LogView::selectedText() const
+{
+	if(!m_model || !hasSelection())
+	{
+		return QString();
+	}
+	auto start = qMin(m_anchor, m_cursor);
+	auto end = qMax(m_anchor, m_cursor);
+	QStringList lines;
+	for(int row = start.row; row <= end.row && row < m_model->rowCount(); row++)
+	{
+		auto text = rowText(row);
+		int from = row == start.row ? start.column : 0;
+		int to = row == end.row ? end.column : text.size();
+		lines.append(text.mid(from, to - from));
+	}
+	return lines.join('\n');
+}
+
+void LogView::copy()
+{
+	if(hasSelection())
+	{
+		QApplication::clipboard()->setText(selectedText());
+	}
+}
+
+void LogView::selectAll()
+{
+	if(!m_model || m_model->rowCount() == 0)
+	{
+		return;
+	}
+	int last = m_model->rowCount() - 1;
+	m_anchor = Position(0, 0);
+	m_cursor = Position(last, rowText(last).size());
+	viewport()->update();
+}
+
 void LogView::findNext(const QString& what, bool reverse)
 {
-	find(what, reverse ? QTextDocument::FindFlag::FindBackward : QTextDocument::FindFlag(0));
+	if(!m_model || what.isEmpty() || m_model->rowCount() == 0)
+	{
+		return;
+	}
+	int rows = m_model->rowCount();
+
+	// continue from the current match, or from the top of the view
+	Position start(verticalScrollBar()->value(), 0);
+	if(hasSelection())
+	{
+		start = reverse ? qMin(m_anchor, m_cursor) : qMax(m_anchor, m_cursor);
+	}
+	else if(m_cursor.isValid())
+	{
+		start = m_cursor;
+	}
+
+	int row = start.row;
+	// -1 means the whole row
+	int from = start.column;
+	for(int i = 0; i <= rows; i++)
+	{
+		auto text = rowText(row);
+		int found = -1;
+		if(!reverse)
+		{
+			found = text.indexOf(what, qMax(from, 0), Qt::CaseInsensitive);
+		}
+		else if(from != 0)
+		{
+			found = text.lastIndexOf(what, from < 0 ? -1 : from - 1, Qt::CaseInsensitive);
+		}
+		if(found >= 0)
+		{
+			m_anchor = Position(row, found);
+			m_cursor = Position(row, found + what.size());
+			ensureVisible(m_anchor);
+			viewport()->update();
+			return;
+		}
+		row = reverse ? (row + rows - 1) % rows : (row + 1) % rows;
+		from = -1;
+	}
+}
+
+void LogView::paintEvent(QPaintEvent *event)
+{
+	Q_UNUSED(event)
+	QPainter painter(viewport());
+	if(!m_model)
+	{
+		return;
+	}
+	int rows = m_model->rowCount();
+	int width = viewport()->width();
+	int available = viewport()->height();
+	int x = margin - horizontalScrollBar()->value();
+	bool selection = hasSelection();
+	auto start = qMin(m_anchor, m_cursor);
+	auto end = qMax(m_anchor, m_cursor);
+
+	int y = 0;
+	for(int row = verticalScrollBar()->value(); row < rows && y < available; row++)
+	{
+		auto rowFormat = format(row);
+		auto rowLayout = layout(row);
+		int height = qMax(1, qCeil(rowLayout->boundingRect().height()));
+		if(rowFormat.background.isValid())
+		{
+			painter.fillRect(0, y, width, height, rowFormat.background);
+		}
+		QVector<QTextLayout::FormatRange> selections;
+		if(selection && row >= start.row && row <= end.row)
+		{
+			int from = row == start.row ? start.column : 0;
+			int to = row == end.row ? end.column : rowLayout->text().size();
+			if(to > from)
+			{
+				QTextLayout::FormatRange range;
+				range.start = from;
+				range.length = to - from;
+				range.format.setBackground(palette().highlight());
+				range.format.setForeground(palette().highlightedText());
+				selections.append(range);
+			}
+		}
+		painter.setPen(rowFormat.foreground);
+		rowLayout->draw(&painter, QPointF(x, y), selections);
+		y += height;
+	}
+}
+
+void LogView::resizeEvent(QResizeEvent *event)
+{
+	auto vertical = verticalScrollBar();
+	bool atBottom = vertical->value() == vertical->maximum();
+	QAbstractScrollArea::resizeEvent(event);
+	if(m_wordWrap)
+	{
+		invalidateLayouts();
+	}
+	updateScrollBars();
+	if(atBottom)
+	{
+		vertical->setValue(vertical->maximum());
+	}
+}
+
+void LogView::changeEvent(QEvent *event)
+{
+	switch(event->type())
+	{
+		case QEvent::FontChange:
+		case QEvent::PaletteChange:
+		case QEvent::StyleChange:
+		{
+			m_formats.clear();
+			invalidateLayouts();
+			if(m_model && !m_wordWrap)
+			{
+				m_maxRowWidth = 0;
+				measureRows(0, m_model->rowCount() - 1);
+			}
+			updateScrollBars();
+			break;
+		}
+		default:
+			break;
+	}
+	QAbstractScrollArea::changeEvent(event);
+}
+
+void LogView::scrollContentsBy(int dx, int dy)
+{
+	Q_UNUSED(dx)
+	Q_UNUSED(dy)
+	viewport()->update();
+}
+
+void LogView::keyPressEvent(QKeyEvent *event)
+{
+	if(event->matches(QKeySequence::Copy))
+	{
+		copy();
+	}
+	else if(event->matches(QKeySequence::SelectAll))
+	{
+		selectAll();
+	}
+	else if(event->matches(QKeySequence::MoveToStartOfDocument))
+	{
+		verticalScrollBar()->setValue(0);
+	}
+	else if(event->matches(QKeySequence::MoveToEndOfDocument))
+	{
+		scrollToBottom();
+	}
+	else
+	{
+		QAbstractScrollArea::keyPressEvent(event);
+	}
+}
+
+void LogView::mousePressEvent(QMouseEvent *event)
+{
+	if(event->button() != Qt::LeftButton)
+	{
+		QAbstractScrollArea::mousePressEvent(event);
+		return;
+	}
+	m_anchor = positionAt(event->pos());
+	m_cursor = m_anchor;
+	m_selecting = true;
+	viewport()->update();
+}
+
+void LogView::mouseMoveEvent(QMouseEvent *event)
+{
+	if(!m_selecting || !(event->buttons() & Qt::LeftButton))
+	{
+		QAbstractScrollArea::mouseMoveEvent(event);
+		return;
+	}
+	auto point = event->pos();
+	// dragging past the edges scrolls
+	if(point.y() < 0)
+	{
+		verticalScrollBar()->triggerAction(QAbstractSlider::SliderSingleStepSub);
+	}
+	else if(point.y() >= viewport()->height())
+	{
+		verticalScrollBar()->triggerAction(QAbstractSlider::SliderSingleStepAdd);
+	}
+	point.setY(qBound(0, point.y(), viewport()->height() - 1));
+	m_cursor = positionAt(point);
+	viewport()->update();
+}
+
+void LogView::mouseReleaseEvent(QMouseEvent *event)
+{
+	if(event->button() != Qt::LeftButton)
+	{
+		QAbstractScrollArea::mouseReleaseEvent(event);
+		return;
+	}
+	m_selecting = false;
+	auto clipboard = QApplication::clipboard();
+	if(hasSelection() && clipboard->supportsSelection())
+	{
+		clipboard->setText(selectedText(), QClipboard::Selection);
+	}
+}
+
+void LogView::mouseDoubleClickEvent(QMouseEvent *event)
+{
+	if(event->button() != Qt::LeftButton)
+	{
+		QAbstractScrollArea::mouseDoubleClickEvent(event);
+		return;
+	}
+	// the whole line
+	auto position = positionAt(event->pos());
+	if(position.isValid())
+	{
+		m_anchor = Position(position.row, 0);
+		m_cursor = Position(position.row, rowText(position.row).size());
+		viewport()->update();
+	}
+}
+
+void LogView::contextMenuEvent(QContextMenuEvent *event)
+{
+	QMenu menu(this);
+	auto copyAction = menu.addAction(tr("&Copy"), this, SLOT(copy()));
+	copyAction->setShortcut(QKeySequence::Copy);
+	copyAction->setEnabled(hasSelection());
+	auto selectAllAction = menu.addAction(tr("Select &All"), this, SLOT(selectAll()));
+	selectAllAction->setShortcut(QKeySequence::SelectAll);
+	menu.exec(event->globalPos());
 }
@@ -1,10 +1,23 @@
 #pragma once
-#include <QPlainTextEdit>
-#include <QAbstractItemView>
+#include <QAbstractScrollArea>
+#include <QColor>
+#include <QFont>
+#include <QHash>
+#include <memory>
 
 class QAbstractItemModel;
+class QTextLayout;
 
-class LogView: public QPlainTextEdit
+/**
+ * Shows the lines of a log model, like the one of LaunchTask.
+ *
+ * Only the visible rows are laid out and painted, straight from the model, so the log isn't kept twice and the view
+ * follows the model when it drops old lines. The vertical scroll bar moves by rows.
+ *
+ * Rows are formatted with the font, text color and background roles of the model. These are looked up once for each
+ * message level, if the model has a LogModel::LevelRole.
+ */
+class LogView: public QAbstractScrollArea
 {
 	Q_OBJECT
 public:
@@ -14,23 +27,89 @@ public:
 	virtual void setModel(QAbstractItemModel *model);
 	QAbstractItemModel *model() const;
 
+	QString selectedText() const;
+
 public slots:
 	void setWordWrap(bool wrapping);
 	void findNext(const QString & what, bool reverse);
 	void scrollToBottom();
+	void copy();
+	void selectAll();
 
 protected slots:
 	void repopulate();
 	// note: this supports only appending
 	void rowsInserted(const QModelIndex &parent, int first, int last);
 	void rowsAboutToBeInserted(const QModelIndex &parent, int first, int last);
-	// note: this supports only removing from front
 	void rowsRemoved(const QModelIndex &parent, int first, int last);
 	void modelDestroyed(QObject * model);
 
 protected:
+	void paintEvent(QPaintEvent *event) override;
+	void resizeEvent(QResizeEvent *event) override;
+	void changeEvent(QEvent *event) override;
+	void scrollContentsBy(int dx, int dy) override;
+	void keyPressEvent(QKeyEvent *event) override;
+	void mousePressEvent(QMouseEvent *event) override;
+	void mouseMoveEvent(QMouseEvent *event) override;
+	void mouseReleaseEvent(QMouseEvent *event) override;
+	void mouseDoubleClickEvent(QMouseEvent *event) override;
+	void contextMenuEvent(QContextMenuEvent *event) override;
+
+private:
+	/// a place in the text: row of the model and character in it
+	struct Position
+	{
+		Position() {}
+		Position(int row, int column) : row(row), column(column) {}
+		int row = -1;
+		int column = 0;
+		bool isValid() const
+		{
+			return row >= 0;
+		}
+		bool operator<(const Position &other) const
+		{
+			return row < other.row || (row == other.row && column < other.column);
+		}
+		bool operator==(const Position &other) const
+		{
+			return row == other.row && column == other.column;
+		}
+	};
+	struct Format
+	{
+		QFont font;
+		QColor foreground;
+		QColor background;
+	};
+
+	QString rowText(int row) const;
+	Format format(int row) const;
+	QTextLayout *layout(int row) const;
+	int rowHeight(int row) const;
+	void measureRows(int first, int last);
+	void invalidateLayouts();
+	void updateScrollBars();
+	void ensureVisible(const Position &position);
+	Position positionAt(const QPoint &point) const;
+	bool hasSelection() const;
+
+private:
 	QAbstractItemModel *m_model = nullptr;
-	QTextCharFormat *m_defaultFormat = nullptr;
+	bool m_wordWrap = true;
 	bool m_scroll = false;
 	bool m_scrolling = false;
+
+	/// formats by message level
+	mutable QHash<int, Format> m_formats;
+	/// layouts of the rows that were visible recently, by row
+	mutable QHash<int, std::shared_ptr<QTextLayout>> m_layouts;
+	/// width of the widest row, for the horizontal scroll bar when not wrapping
+	int m_maxRowWidth = 0;
+
+	/// the selection goes from the anchor to the cursor
+	Position m_anchor;
+	Position m_cursor;
+	bool m_selecting = false;
 };
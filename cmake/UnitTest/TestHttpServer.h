@@ -0,0 +1,51 @@
+#pragma once
+
+#include <QMap>
+#include <QStringList>
+#include <QTcpServer>
+#include <QTcpSocket>
+
+/// A minimal HTTP server that serves fixed bodies by path and remembers what was asked for
+class TestHttpServer : public QTcpServer
+{
+public:
+	TestHttpServer()
+	{
+		connect(this, &QTcpServer::newConnection, [this]()
+		{
+			while (auto socket = nextPendingConnection())
+			{
+				connect(socket, &QTcpSocket::readyRead, [this, socket]()
+				{
+					if (!socket->canReadLine())
+					{
+						return;
+					}
+					// GET /path HTTP/1.1
+					auto path = QString::fromLatin1(socket->readLine()).section(' ', 1, 1);
+					requested.append(path);
+					QByteArray response;
+					if (files.contains(path))
+					{
+						auto body = files.value(path);
+						response = "HTTP/1.1 200 OK\r\nContent-Length: " + QByteArray::number(body.size()) +
+								   "\r\nConnection: close\r\n\r\n" + body;
+					}
+					else
+					{
+						response = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+					}
+					socket->write(response);
+					socket->disconnectFromHost();
+				});
+				connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+			}
+		});
+	}
+	QString url(const QString &path)
+	{
+		return QString("http://127.0.0.1:%1%2").arg(serverPort()).arg(path);
+	}
+	QMap<QString, QByteArray> files;
+	QStringList requested;
+};
@@ -0,0 +1,124 @@
+/*
+ * Benchmark for the pack200 unpacker. Public domain, like anti200.
+ */
+
+#include <stdexcept>
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include "unpack200.h"
+
+static bool readWholeFile(const char *path, std::vector<char> &data)
+{
+	FILE *input = fopen(path, "rb");
+	if (!input)
+	{
+		return false;
+	}
+	char buffer[1 << 16];
+	size_t numread;
+	while ((numread = fread(buffer, 1, sizeof(buffer), input)) > 0)
+	{
+		data.insert(data.end(), buffer, buffer + numread);
+	}
+	fclose(input);
+	return true;
+}
+
+// Unpack the file once, return the time it took in milliseconds or a negative value on error
+static double runOnce(const char *path, const std::vector<char> &data, bool fromMemory)
+{
+	// the unpacker takes ownership of the output
+	FILE *output = tmpfile();
+	if (!output)
+	{
+		std::cerr << "Can't create output file" << std::endl;
+		return -1;
+	}
+	FILE *input = nullptr;
+	if (!fromMemory)
+	{
+		input = fopen(path, "rb");
+		if (!input)
+		{
+			fclose(output);
+			std::cerr << "Can't open input file " << path << std::endl;
+			return -1;
+		}
+	}
+	auto start = std::chrono::steady_clock::now();
+	try
+	{
+		if (fromMemory)
+		{
+			unpack_200_memory(data.data(), data.size(), output);
+		}
+		else
+		{
+			unpack_200(input, output);
+		}
+	}
+	catch (std::runtime_error &e)
+	{
+		std::cerr << "Bad things happened: " << e.what() << std::endl;
+		if (input)
+		{
+			fclose(input);
+		}
+		return -1;
+	}
+	auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+int main(int argc, char **argv)
+{
+	int iterations = 10;
+	int first = 1;
+	if (argc > 2 && strcmp(argv[1], "-n") == 0)
+	{
+		iterations = atoi(argv[2]);
+		first = 3;
+	}
+	if (first >= argc || iterations <= 0)
+	{
+		std::cerr << "pack200 unpacker benchmark!" << std::endl << "Run like this:" << std::endl
+				  << "  " << argv[0] << " [-n iterations] input.pack [input2.pack ...]" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	for (int i = first; i < argc; i++)
+	{
+		std::vector<char> data;
+		if (!readWholeFile(argv[i], data))
+		{
+			std::cerr << "Can't read input file " << argv[i] << std::endl;
+			return EXIT_FAILURE;
+		}
+		for (int mode = 0; mode < 2; mode++)
+		{
+			bool fromMemory = mode == 1;
+			double best = -1, total = 0;
+			for (int run = 0; run < iterations; run++)
+			{
+				double ms = runOnce(argv[i], data, fromMemory);
+				if (ms < 0)
+				{
+					return EXIT_FAILURE;
+				}
+				total += ms;
+				if (best < 0 || ms < best)
+				{
+					best = ms;
+				}
+			}
+			double mbPerSecond = (data.size() / (1024.0 * 1024.0)) / (best / 1000.0);
+			std::cout << argv[i] << (fromMemory ? " [memory]" : " [stdio] ") << " best " << best
+					  << " ms, average " << total / iterations << " ms, " << mbPerSecond << " MiB/s"
+					  << std::endl;
+		}
+	}
+	return EXIT_SUCCESS;
+}
@@ -25,6 +25,9 @@
 
 #pragma once
 
+#include <stdint.h>
+#include <stdio.h>
+
 #include "multimc_unpack200_export.h"
 
 /**
@@ -35,3 +38,34 @@
  * @throw std::runtime_error for any error encountered
  */
 MULTIMC_UNPACK200_EXPORT void unpack_200(FILE * input_path, FILE * output_path);
+
+/**
+ * @brief Callback supplying PACK200 data to unpack_200_stream
+ *
+ * Must fill buf with at least minlen and at most maxlen bytes, blocking if needed.
+ * Returning less than minlen means the input has ended.
+ *
+ * @param context the context given to unpack_200_stream
+ * @return number of bytes stored in buf
+ */
+typedef int64_t (*unpack_200_read_fn)(void *context, void *buf, int64_t minlen, int64_t maxlen);
+
+/**
+ * @brief Unpack a PACK200 stream as it is being produced
+ *
+ * @param read callback that supplies the input
+ * @param context passed to every call of read
+ * @param output Output file in JAR format. This takes ownership of the file handle.
+ * @throw std::runtime_error for any error encountered
+ */
+MULTIMC_UNPACK200_EXPORT void unpack_200_stream(unpack_200_read_fn read, void *context, FILE *output);
+
+/**
+ * @brief Unpack a PACK200 file that is already in memory
+ *
+ * @param data the PACK200 data. Must stay valid until this returns.
+ * @param length size of data in bytes
+ * @param output Output file in JAR format. This takes ownership of the file handle.
+ * @throw std::runtime_error for any error encountered
+ */
+MULTIMC_UNPACK200_EXPORT void unpack_200_memory(const void *data, size_t length, FILE *output);
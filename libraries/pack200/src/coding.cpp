@@ -502,6 +502,16 @@ int value_stream::getInt()
 		return getInt();
 	}
 
+	// The two most common codings, handled before unpacking the spec.
+	if (cmk == cmk_BYTE1)
+	{
+		return *rp++ & 0xFF;
+	}
+	if (cmk == cmk_UNSIGNED5)
+	{
+		return (int)coding::parse_UNSIGNED5(rp);
+	}
+
 	CODING_PRIVATE(c.spec);
 	uint32_t uval;
 	enum
@@ -531,21 +541,11 @@ int value_stream::getInt()
 		uval = coding::parse(rp, B, H);
 		return DECODE_SIGN_S1(uval);
 
-	case cmk_BYTE1:
-		assert(c.spec == BYTE1_spec);
-		assert(B == 1 && H == 256 && S == 0 && D == 0);
-		return *rp++ & 0xFF;
-
 	case cmk_CHAR3:
 		assert(c.spec == CHAR3_spec);
 		assert(B == B3 && H == H128 && S == 0 && D == 0);
 		return coding::parse_lgH(rp, B3, H128, 7);
 
-	case cmk_UNSIGNED5:
-		assert(c.spec == UNSIGNED5_spec);
-		assert(B == B5 && H == H64 && S == 0 && D == 0);
-		return coding::parse_lgH(rp, B5, H64, 6);
-
 	case cmk_BHSD1:
 		assert(D == 1);
 		uval = coding::parse(rp, B, H);
@@ -88,6 +88,36 @@ struct coding
 	static uint32_t parse_lgH(byte *&rp, int B, int H, int lgH);
 	static void parseMultiple(byte *&rp, int N, byte *limit, int B, int H);
 
+	// parse(rp, 5, 64) unrolled. Bytes below L = 192 end a value, the fifth byte always does.
+	static uint32_t parse_UNSIGNED5(byte *&rp)
+	{
+		byte *ptr = rp;
+		uint32_t b_i = *ptr++ & 0xFF;
+		uint32_t sum = b_i;
+		if (b_i >= 192)
+		{
+			b_i = *ptr++ & 0xFF;
+			sum += b_i << 6;
+			if (b_i >= 192)
+			{
+				b_i = *ptr++ & 0xFF;
+				sum += b_i << 12;
+				if (b_i >= 192)
+				{
+					b_i = *ptr++ & 0xFF;
+					sum += b_i << 18;
+					if (b_i >= 192)
+					{
+						b_i = *ptr++ & 0xFF;
+						sum += b_i << 24;
+					}
+				}
+			}
+		}
+		rp = ptr;
+		return sum;
+	}
+
 	uint32_t parse(byte *&rp)
 	{
 		return parse(rp, CODING_B(spec), CODING_H(spec));
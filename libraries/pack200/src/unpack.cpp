@@ -3510,6 +3510,7 @@ void unpacker::reset()
 	// restore selected interface state:
 	infileptr = save_u.infileptr;
 	inbytes = save_u.inbytes;
+	input_context = save_u.input_context;
 	jarout = save_u.jarout;
 	gzin = save_u.gzin;
 	verbose = save_u.verbose;
@@ -160,6 +160,7 @@ struct unpacker
 	// if running Unix-style, here are the inputs and outputs
 	FILE *infileptr; // buffered
 	bytes inbytes;   // direct
+	void *input_context; // for read_input_fn, if the input comes from elsewhere
 	gunzip *gzin;	// gunzip filter, if any
 	jar *jarout;	 // output JAR file
 
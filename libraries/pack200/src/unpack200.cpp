@@ -42,6 +42,13 @@
 #include "unpack.h"
 #include "zip.h"
 
+// Input supplied by a callback, see unpack_200_stream
+struct stream_input
+{
+	unpack_200_read_fn read;
+	void *context;
+};
+
 // Callback for fetching data, Unix style.
 static int64_t read_input_via_stdio(unpacker *u, void *buf, int64_t minlen, int64_t maxlen)
 {
@@ -71,6 +78,35 @@ static int64_t read_input_via_stdio(unpacker *u, void *buf, int64_t minlen, int6
 	return numread;
 }
 
+// Callback for fetching data from a user supplied function.
+static int64_t read_input_via_callback(unpacker *u, void *buf, int64_t minlen, int64_t maxlen)
+{
+	assert(minlen <= maxlen); // don't talk nonsense
+	stream_input *input = (stream_input *)u->input_context;
+	assert(input != nullptr);
+	return input->read(input->context, buf, minlen, maxlen);
+}
+
+// Input already in memory, see unpack_200_memory
+struct memory_input
+{
+	const char *data;
+	size_t length;
+	size_t position;
+};
+
+// Callback for fetching data from memory. Just a copy, no syscalls or stdio locking.
+static int64_t read_input_via_memory(void *context, void *buf, int64_t minlen, int64_t maxlen)
+{
+	(void)minlen;
+	memory_input *input = (memory_input *)context;
+	size_t available = input->length - input->position;
+	size_t numread = ((uint64_t)maxlen < available) ? (size_t)maxlen : available;
+	memcpy(buf, input->data + input->position, numread);
+	input->position += numread;
+	return (int64_t)numread;
+}
+
 enum
 {
 	EOF_MAGIC = 0,
@@ -94,20 +130,9 @@ static int read_magic(unpacker *u, char peek[], int peeklen)
 	return magic;
 }
 
-void unpack_200(FILE *input, FILE *output)
+// Unpack all the segments from the input of an initialized unpacker
+static void unpack_segments(unpacker &u)
 {
-	unpacker u;
-	u.init(read_input_via_stdio);
-
-	// initialize jar output
-	// the output takes ownership of the file handle
-	jar jarout;
-	jarout.init(&u);
-	jarout.jarfp = output;
-
-	// the input doesn't
-	u.infileptr = input;
-
 	// read the magic!
 	char peek[4];
 	int magic;
@@ -158,5 +183,45 @@ void unpack_200(FILE *input, FILE *output)
 	}
 	u.finish();
 	u.free(); // tidy up malloc blocks
+}
+
+void unpack_200(FILE *input, FILE *output)
+{
+	unpacker u;
+	u.init(read_input_via_stdio);
+
+	// initialize jar output
+	// the output takes ownership of the file handle
+	jar jarout;
+	jarout.init(&u);
+	jarout.jarfp = output;
+
+	// the input doesn't
+	u.infileptr = input;
+
+	unpack_segments(u);
 	fclose(input);
 }
+
+void unpack_200_stream(unpack_200_read_fn read, void *context, FILE *output)
+{
+	stream_input input = {read, context};
+	unpacker u;
+	u.init(read_input_via_callback);
+
+	// initialize jar output
+	// the output takes ownership of the file handle
+	jar jarout;
+	jarout.init(&u);
+	jarout.jarfp = output;
+
+	u.input_context = &input;
+
+	unpack_segments(u);
+}
+
+void unpack_200_memory(const void *data, size_t length, FILE *output)
+{
+	memory_input input = {(const char *)data, length, 0};
+	unpack_200_stream(read_input_via_memory, &input, output);
+}
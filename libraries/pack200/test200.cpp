@@ -0,0 +1,179 @@
+/*
+ * Test for the pack200 unpacker. Public domain, like anti200.
+ *
+ * Unpacks the given archives through stdio and from memory, and checks the files in the
+ * resulting jars against the listing next to each archive (see testdata/make_packs.py).
+ */
+
+#include <stdexcept>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include "unpack200.h"
+
+static const char *outputPath = "test200-output.jar";
+
+static bool readWholeFile(const std::string &path, std::string &data)
+{
+	std::ifstream input(path, std::ios::binary);
+	if (!input)
+	{
+		return false;
+	}
+	std::ostringstream buffer;
+	buffer << input.rdbuf();
+	data = buffer.str();
+	return true;
+}
+
+static uint32_t le(const std::string &data, size_t offset, int bytes)
+{
+	uint32_t value = 0;
+	for (int i = bytes - 1; i >= 0; i--)
+	{
+		value = (value << 8) | (unsigned char)data[offset + i];
+	}
+	return value;
+}
+
+// "crc32 size name" for every entry in the central directory of a zip file
+static bool listJar(const std::string &jar, std::vector<std::string> &listing)
+{
+	if (jar.size() < 22)
+	{
+		return false;
+	}
+	size_t end = jar.size() - 22;
+	while (le(jar, end, 4) != 0x06054b50)
+	{
+		if (end == 0)
+		{
+			return false;
+		}
+		end--;
+	}
+	uint32_t count = le(jar, end + 10, 2);
+	size_t pos = le(jar, end + 16, 4);
+	for (uint32_t i = 0; i < count; i++)
+	{
+		if (pos + 46 > jar.size() || le(jar, pos, 4) != 0x02014b50)
+		{
+			return false;
+		}
+		uint32_t nameLength = le(jar, pos + 28, 2);
+		char crc[9];
+		snprintf(crc, sizeof(crc), "%08x", le(jar, pos + 16, 4));
+		listing.push_back(std::string(crc) + " " + std::to_string(le(jar, pos + 24, 4)) + " " +
+						  jar.substr(pos + 46, nameLength));
+		pos += 46 + nameLength + le(jar, pos + 30, 2) + le(jar, pos + 32, 2);
+	}
+	return true;
+}
+
+static bool unpack(const std::string &path, const std::string &data, bool fromMemory, std::string &jar)
+{
+	// the unpacker closes both files
+	FILE *output = fopen(outputPath, "wb");
+	if (!output)
+	{
+		std::cerr << "Can't create output file " << outputPath << std::endl;
+		return false;
+	}
+	try
+	{
+		if (fromMemory)
+		{
+			unpack_200_memory(data.data(), data.size(), output);
+		}
+		else
+		{
+			FILE *input = fopen(path.c_str(), "rb");
+			if (!input)
+			{
+				fclose(output);
+				std::cerr << "Can't open input file " << path << std::endl;
+				return false;
+			}
+			unpack_200(input, output);
+		}
+	}
+	catch (std::runtime_error &e)
+	{
+		std::cerr << path << ": " << e.what() << std::endl;
+		return false;
+	}
+	bool success = readWholeFile(outputPath, jar);
+	remove(outputPath);
+	return success;
+}
+
+static bool check(const std::string &path)
+{
+	std::string data, expectedText;
+	std::string base = path.substr(0, path.rfind('.'));
+	if (!readWholeFile(path, data) || !readWholeFile(base + ".txt", expectedText))
+	{
+		std::cerr << "Can't read " << path << " or its listing" << std::endl;
+		return false;
+	}
+	std::vector<std::string> expected;
+	std::istringstream lines(expectedText);
+	for (std::string line; std::getline(lines, line);)
+	{
+		expected.push_back(line);
+	}
+
+	std::string fromStdio, fromMemory;
+	if (!unpack(path, data, false, fromStdio) || !unpack(path, data, true, fromMemory))
+	{
+		return false;
+	}
+	if (fromStdio != fromMemory)
+	{
+		std::cerr << path << ": unpacking through stdio and from memory gave different jars" << std::endl;
+		return false;
+	}
+	std::vector<std::string> listing;
+	if (!listJar(fromStdio, listing))
+	{
+		std::cerr << path << ": the unpacked jar is broken" << std::endl;
+		return false;
+	}
+	if (listing != expected)
+	{
+		std::cerr << path << ": the unpacked jar has the wrong files" << std::endl;
+		for (size_t i = 0; i < listing.size() || i < expected.size(); i++)
+		{
+			std::string got = i < listing.size() ? listing[i] : "(nothing)";
+			std::string want = i < expected.size() ? expected[i] : "(nothing)";
+			if (got != want)
+			{
+				std::cerr << "  got " << got << ", expected " << want << std::endl;
+				break;
+			}
+		}
+		return false;
+	}
+	std::cout << path << ": " << listing.size() << " files OK" << std::endl;
+	return true;
+}
+
+int main(int argc, char **argv)
+{
+	if (argc < 2)
+	{
+		std::cerr << "pack200 unpacker test!" << std::endl << "Run like this:" << std::endl
+				  << "  " << argv[0] << " input.pack [input2.pack ...]" << std::endl;
+		return EXIT_FAILURE;
+	}
+	bool success = true;
+	for (int i = 1; i < argc; i++)
+	{
+		success &= check(argv[i]);
+	}
+	return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}